@@ -0,0 +1,9 @@
+file(REMOVE_RECURSE
+  "libds.pdb"
+  "libds.so"
+)
+
+# Per-language clean rules from dependency scanning.
+foreach(lang C)
+  include(CMakeFiles/ds_shared.dir/cmake_clean_${lang}.cmake OPTIONAL)
+endforeach()
@@ -0,0 +1,11 @@
+file(REMOVE_RECURSE
+  "CMakeFiles/extsort_test.dir/extsort_test.c.o"
+  "CMakeFiles/extsort_test.dir/extsort_test.c.o.d"
+  "extsort_test"
+  "extsort_test.pdb"
+)
+
+# Per-language clean rules from dependency scanning.
+foreach(lang C)
+  include(CMakeFiles/extsort_test.dir/cmake_clean_${lang}.cmake OPTIONAL)
+endforeach()
@@ -0,0 +1,11 @@
+file(REMOVE_RECURSE
+  "CMakeFiles/list_test.dir/list_test.c.o"
+  "CMakeFiles/list_test.dir/list_test.c.o.d"
+  "list_test"
+  "list_test.pdb"
+)
+
+# Per-language clean rules from dependency scanning.
+foreach(lang C)
+  include(CMakeFiles/list_test.dir/cmake_clean_${lang}.cmake OPTIONAL)
+endforeach()
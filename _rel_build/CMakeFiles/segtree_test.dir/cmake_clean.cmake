@@ -0,0 +1,11 @@
+file(REMOVE_RECURSE
+  "CMakeFiles/segtree_test.dir/segtree_test.c.o"
+  "CMakeFiles/segtree_test.dir/segtree_test.c.o.d"
+  "segtree_test"
+  "segtree_test.pdb"
+)
+
+# Per-language clean rules from dependency scanning.
+foreach(lang C)
+  include(CMakeFiles/segtree_test.dir/cmake_clean_${lang}.cmake OPTIONAL)
+endforeach()
@@ -0,0 +1,11 @@
+file(REMOVE_RECURSE
+  "CMakeFiles/soa_test.dir/soa_test.c.o"
+  "CMakeFiles/soa_test.dir/soa_test.c.o.d"
+  "soa_test"
+  "soa_test.pdb"
+)
+
+# Per-language clean rules from dependency scanning.
+foreach(lang C)
+  include(CMakeFiles/soa_test.dir/cmake_clean_${lang}.cmake OPTIONAL)
+endforeach()
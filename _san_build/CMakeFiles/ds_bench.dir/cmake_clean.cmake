@@ -0,0 +1,11 @@
+file(REMOVE_RECURSE
+  "CMakeFiles/ds_bench.dir/bench.c.o"
+  "CMakeFiles/ds_bench.dir/bench.c.o.d"
+  "bench"
+  "bench.pdb"
+)
+
+# Per-language clean rules from dependency scanning.
+foreach(lang C)
+  include(CMakeFiles/ds_bench.dir/cmake_clean_${lang}.cmake OPTIONAL)
+endforeach()
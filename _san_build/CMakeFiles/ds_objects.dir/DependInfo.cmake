@@ -0,0 +1,30 @@
+
+# Consider dependencies only in project.
+set(CMAKE_DEPENDS_IN_PROJECT_ONLY OFF)
+
+# The set of languages for which implicit dependencies are needed:
+set(CMAKE_DEPENDS_LANGUAGES
+  )
+
+# The set of dependency files which are needed:
+set(CMAKE_DEPENDS_DEPENDENCY_FILES
+  "/root/repo/alist.c" "CMakeFiles/ds_objects.dir/alist.c.o" "gcc" "CMakeFiles/ds_objects.dir/alist.c.o.d"
+  "/root/repo/commons.c" "CMakeFiles/ds_objects.dir/commons.c.o" "gcc" "CMakeFiles/ds_objects.dir/commons.c.o.d"
+  "/root/repo/extsort.c" "CMakeFiles/ds_objects.dir/extsort.c.o" "gcc" "CMakeFiles/ds_objects.dir/extsort.c.o.d"
+  "/root/repo/galist.c" "CMakeFiles/ds_objects.dir/galist.c.o" "gcc" "CMakeFiles/ds_objects.dir/galist.c.o.d"
+  "/root/repo/hmap.c" "CMakeFiles/ds_objects.dir/hmap.c.o" "gcc" "CMakeFiles/ds_objects.dir/hmap.c.o.d"
+  "/root/repo/itree.c" "CMakeFiles/ds_objects.dir/itree.c.o" "gcc" "CMakeFiles/ds_objects.dir/itree.c.o.d"
+  "/root/repo/pqueue.c" "CMakeFiles/ds_objects.dir/pqueue.c.o" "gcc" "CMakeFiles/ds_objects.dir/pqueue.c.o.d"
+  "/root/repo/ptree.c" "CMakeFiles/ds_objects.dir/ptree.c.o" "gcc" "CMakeFiles/ds_objects.dir/ptree.c.o.d"
+  "/root/repo/search.c" "CMakeFiles/ds_objects.dir/search.c.o" "gcc" "CMakeFiles/ds_objects.dir/search.c.o.d"
+  "/root/repo/segtree.c" "CMakeFiles/ds_objects.dir/segtree.c.o" "gcc" "CMakeFiles/ds_objects.dir/segtree.c.o.d"
+  "/root/repo/skiplist.c" "CMakeFiles/ds_objects.dir/skiplist.c.o" "gcc" "CMakeFiles/ds_objects.dir/skiplist.c.o.d"
+  "/root/repo/soa.c" "CMakeFiles/ds_objects.dir/soa.c.o" "gcc" "CMakeFiles/ds_objects.dir/soa.c.o.d"
+  )
+
+# Targets to which this target links.
+set(CMAKE_TARGET_LINKED_INFO_FILES
+  )
+
+# Fortran module output directory.
+set(CMAKE_Fortran_TARGET_MODULE_DIR "")
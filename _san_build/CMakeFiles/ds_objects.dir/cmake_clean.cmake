@@ -0,0 +1,31 @@
+file(REMOVE_RECURSE
+  "CMakeFiles/ds_objects.dir/alist.c.o"
+  "CMakeFiles/ds_objects.dir/alist.c.o.d"
+  "CMakeFiles/ds_objects.dir/commons.c.o"
+  "CMakeFiles/ds_objects.dir/commons.c.o.d"
+  "CMakeFiles/ds_objects.dir/extsort.c.o"
+  "CMakeFiles/ds_objects.dir/extsort.c.o.d"
+  "CMakeFiles/ds_objects.dir/galist.c.o"
+  "CMakeFiles/ds_objects.dir/galist.c.o.d"
+  "CMakeFiles/ds_objects.dir/hmap.c.o"
+  "CMakeFiles/ds_objects.dir/hmap.c.o.d"
+  "CMakeFiles/ds_objects.dir/itree.c.o"
+  "CMakeFiles/ds_objects.dir/itree.c.o.d"
+  "CMakeFiles/ds_objects.dir/pqueue.c.o"
+  "CMakeFiles/ds_objects.dir/pqueue.c.o.d"
+  "CMakeFiles/ds_objects.dir/ptree.c.o"
+  "CMakeFiles/ds_objects.dir/ptree.c.o.d"
+  "CMakeFiles/ds_objects.dir/search.c.o"
+  "CMakeFiles/ds_objects.dir/search.c.o.d"
+  "CMakeFiles/ds_objects.dir/segtree.c.o"
+  "CMakeFiles/ds_objects.dir/segtree.c.o.d"
+  "CMakeFiles/ds_objects.dir/skiplist.c.o"
+  "CMakeFiles/ds_objects.dir/skiplist.c.o.d"
+  "CMakeFiles/ds_objects.dir/soa.c.o"
+  "CMakeFiles/ds_objects.dir/soa.c.o.d"
+)
+
+# Per-language clean rules from dependency scanning.
+foreach(lang C)
+  include(CMakeFiles/ds_objects.dir/cmake_clean_${lang}.cmake OPTIONAL)
+endforeach()
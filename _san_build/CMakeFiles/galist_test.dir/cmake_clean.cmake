@@ -0,0 +1,11 @@
+file(REMOVE_RECURSE
+  "CMakeFiles/galist_test.dir/galist_test.c.o"
+  "CMakeFiles/galist_test.dir/galist_test.c.o.d"
+  "galist_test"
+  "galist_test.pdb"
+)
+
+# Per-language clean rules from dependency scanning.
+foreach(lang C)
+  include(CMakeFiles/galist_test.dir/cmake_clean_${lang}.cmake OPTIONAL)
+endforeach()
@@ -0,0 +1,11 @@
+file(REMOVE_RECURSE
+  "CMakeFiles/itree_test.dir/itree_test.c.o"
+  "CMakeFiles/itree_test.dir/itree_test.c.o.d"
+  "itree_test"
+  "itree_test.pdb"
+)
+
+# Per-language clean rules from dependency scanning.
+foreach(lang C)
+  include(CMakeFiles/itree_test.dir/cmake_clean_${lang}.cmake OPTIONAL)
+endforeach()
@@ -0,0 +1,11 @@
+file(REMOVE_RECURSE
+  "CMakeFiles/pqueue_test.dir/pqueue_test.c.o"
+  "CMakeFiles/pqueue_test.dir/pqueue_test.c.o.d"
+  "pqueue_test"
+  "pqueue_test.pdb"
+)
+
+# Per-language clean rules from dependency scanning.
+foreach(lang C)
+  include(CMakeFiles/pqueue_test.dir/cmake_clean_${lang}.cmake OPTIONAL)
+endforeach()
@@ -0,0 +1,11 @@
+file(REMOVE_RECURSE
+  "CMakeFiles/ptree_test.dir/ptree_test.c.o"
+  "CMakeFiles/ptree_test.dir/ptree_test.c.o.d"
+  "ptree_test"
+  "ptree_test.pdb"
+)
+
+# Per-language clean rules from dependency scanning.
+foreach(lang C)
+  include(CMakeFiles/ptree_test.dir/cmake_clean_${lang}.cmake OPTIONAL)
+endforeach()
@@ -0,0 +1,11 @@
+file(REMOVE_RECURSE
+  "CMakeFiles/alist_test.dir/test.c.o"
+  "CMakeFiles/alist_test.dir/test.c.o.d"
+  "alist_test"
+  "alist_test.pdb"
+)
+
+# Per-language clean rules from dependency scanning.
+foreach(lang C)
+  include(CMakeFiles/alist_test.dir/cmake_clean_${lang}.cmake OPTIONAL)
+endforeach()
@@ -0,0 +1,9 @@
+file(REMOVE_RECURSE
+  "libds.a"
+  "libds.pdb"
+)
+
+# Per-language clean rules from dependency scanning.
+foreach(lang C)
+  include(CMakeFiles/ds.dir/cmake_clean_${lang}.cmake OPTIONAL)
+endforeach()
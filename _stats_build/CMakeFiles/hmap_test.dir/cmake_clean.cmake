@@ -0,0 +1,11 @@
+file(REMOVE_RECURSE
+  "CMakeFiles/hmap_test.dir/hmap_test.c.o"
+  "CMakeFiles/hmap_test.dir/hmap_test.c.o.d"
+  "hmap_test"
+  "hmap_test.pdb"
+)
+
+# Per-language clean rules from dependency scanning.
+foreach(lang C)
+  include(CMakeFiles/hmap_test.dir/cmake_clean_${lang}.cmake OPTIONAL)
+endforeach()
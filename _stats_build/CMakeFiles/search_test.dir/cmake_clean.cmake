@@ -0,0 +1,11 @@
+file(REMOVE_RECURSE
+  "CMakeFiles/search_test.dir/search_test.c.o"
+  "CMakeFiles/search_test.dir/search_test.c.o.d"
+  "search_test"
+  "search_test.pdb"
+)
+
+# Per-language clean rules from dependency scanning.
+foreach(lang C)
+  include(CMakeFiles/search_test.dir/cmake_clean_${lang}.cmake OPTIONAL)
+endforeach()
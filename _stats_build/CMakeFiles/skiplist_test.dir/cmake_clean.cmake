@@ -0,0 +1,11 @@
+file(REMOVE_RECURSE
+  "CMakeFiles/skiplist_test.dir/skiplist_test.c.o"
+  "CMakeFiles/skiplist_test.dir/skiplist_test.c.o.d"
+  "skiplist_test"
+  "skiplist_test.pdb"
+)
+
+# Per-language clean rules from dependency scanning.
+foreach(lang C)
+  include(CMakeFiles/skiplist_test.dir/cmake_clean_${lang}.cmake OPTIONAL)
+endforeach()
@@ -0,0 +1,34 @@
+# CMake generated Testfile for 
+# Source directory: /root/repo
+# Build directory: /root/repo/_stats_build
+# 
+# This file includes the relevant testing commands required for 
+# testing this directory and lists subdirectories to be tested as well.
+add_test(alist_test "/root/repo/_stats_build/alist_test")
+set_tests_properties(alist_test PROPERTIES  _BACKTRACE_TRIPLES "/root/repo/CMakeLists.txt;90;add_test;/root/repo/CMakeLists.txt;93;ds_test;/root/repo/CMakeLists.txt;0;")
+add_test(list_test "/root/repo/_stats_build/list_test")
+set_tests_properties(list_test PROPERTIES  _BACKTRACE_TRIPLES "/root/repo/CMakeLists.txt;90;add_test;/root/repo/CMakeLists.txt;94;ds_test;/root/repo/CMakeLists.txt;0;")
+add_test(tree_test "/root/repo/_stats_build/tree_test")
+set_tests_properties(tree_test PROPERTIES  _BACKTRACE_TRIPLES "/root/repo/CMakeLists.txt;90;add_test;/root/repo/CMakeLists.txt;95;ds_test;/root/repo/CMakeLists.txt;0;")
+add_test(pqueue_test "/root/repo/_stats_build/pqueue_test")
+set_tests_properties(pqueue_test PROPERTIES  _BACKTRACE_TRIPLES "/root/repo/CMakeLists.txt;90;add_test;/root/repo/CMakeLists.txt;96;ds_test;/root/repo/CMakeLists.txt;0;")
+add_test(map_test "/root/repo/_stats_build/map_test")
+set_tests_properties(map_test PROPERTIES  _BACKTRACE_TRIPLES "/root/repo/CMakeLists.txt;90;add_test;/root/repo/CMakeLists.txt;97;ds_test;/root/repo/CMakeLists.txt;0;")
+add_test(hmap_test "/root/repo/_stats_build/hmap_test")
+set_tests_properties(hmap_test PROPERTIES  _BACKTRACE_TRIPLES "/root/repo/CMakeLists.txt;90;add_test;/root/repo/CMakeLists.txt;98;ds_test;/root/repo/CMakeLists.txt;0;")
+add_test(skiplist_test "/root/repo/_stats_build/skiplist_test")
+set_tests_properties(skiplist_test PROPERTIES  _BACKTRACE_TRIPLES "/root/repo/CMakeLists.txt;90;add_test;/root/repo/CMakeLists.txt;99;ds_test;/root/repo/CMakeLists.txt;0;")
+add_test(search_test "/root/repo/_stats_build/search_test")
+set_tests_properties(search_test PROPERTIES  _BACKTRACE_TRIPLES "/root/repo/CMakeLists.txt;90;add_test;/root/repo/CMakeLists.txt;100;ds_test;/root/repo/CMakeLists.txt;0;")
+add_test(soa_test "/root/repo/_stats_build/soa_test")
+set_tests_properties(soa_test PROPERTIES  _BACKTRACE_TRIPLES "/root/repo/CMakeLists.txt;90;add_test;/root/repo/CMakeLists.txt;101;ds_test;/root/repo/CMakeLists.txt;0;")
+add_test(extsort_test "/root/repo/_stats_build/extsort_test")
+set_tests_properties(extsort_test PROPERTIES  _BACKTRACE_TRIPLES "/root/repo/CMakeLists.txt;90;add_test;/root/repo/CMakeLists.txt;102;ds_test;/root/repo/CMakeLists.txt;0;")
+add_test(galist_test "/root/repo/_stats_build/galist_test")
+set_tests_properties(galist_test PROPERTIES  _BACKTRACE_TRIPLES "/root/repo/CMakeLists.txt;90;add_test;/root/repo/CMakeLists.txt;103;ds_test;/root/repo/CMakeLists.txt;0;")
+add_test(ptree_test "/root/repo/_stats_build/ptree_test")
+set_tests_properties(ptree_test PROPERTIES  _BACKTRACE_TRIPLES "/root/repo/CMakeLists.txt;90;add_test;/root/repo/CMakeLists.txt;104;ds_test;/root/repo/CMakeLists.txt;0;")
+add_test(itree_test "/root/repo/_stats_build/itree_test")
+set_tests_properties(itree_test PROPERTIES  _BACKTRACE_TRIPLES "/root/repo/CMakeLists.txt;90;add_test;/root/repo/CMakeLists.txt;105;ds_test;/root/repo/CMakeLists.txt;0;")
+add_test(segtree_test "/root/repo/_stats_build/segtree_test")
+set_tests_properties(segtree_test PROPERTIES  _BACKTRACE_TRIPLES "/root/repo/CMakeLists.txt;90;add_test;/root/repo/CMakeLists.txt;106;ds_test;/root/repo/CMakeLists.txt;0;")
@@ -2,28 +2,113 @@
 #include <stdlib.h>
 #include <string.h>
 
+// below this ratio of lengths, intersections merge linearly instead of galloping
+#define GALLOP_RATIO 8
+
+// length of the runs sorted by insertion before the merges of the argsorts
+#define SORT_RUN 16
+
+#define ELEMENT(list, i) ((list)->array + (i) * (list)->data_size)
+
+// Defines a stable, bottom-up merge sort of length items of Type, which
+// uses buffer of as many items. LESS(a, b) may use list and compare.
+#define DEFINE_MERGE_SORT(name, Type, LESS)										\
+static void name(Type *items, Type *buffer, unsigned long length,				\
+		AList *list, DSCompare compare) {										\
+	Type *from = items, *to = buffer, *other;									\
+	(void) list;																\
+	(void) compare;																\
+	for (unsigned long lo = 0; lo < length; lo += SORT_RUN) {					\
+		unsigned long hi = lo + SORT_RUN < length ? lo + SORT_RUN : length;		\
+		for (unsigned long i = lo + 1; i < hi; i++) {							\
+			Type item = items[i];												\
+			unsigned long j = i;												\
+			for (; j > lo && LESS(item, items[j-1]); j--) {						\
+				items[j] = items[j-1];											\
+			}																	\
+			items[j] = item;													\
+		}																		\
+	}																			\
+	for (unsigned long width = SORT_RUN; width < length; width *= 2) {			\
+		for (unsigned long lo = 0; lo < length; lo += 2 * width) {				\
+			unsigned long mid = lo + width < length ? lo + width : length;		\
+			unsigned long hi = mid + width < length ? mid + width : length;		\
+			unsigned long i = lo, j = mid, k = lo;								\
+			while (i < mid && j < hi) {											\
+				to[k++] = LESS(from[j], from[i]) ? from[j++] : from[i++];		\
+			}																	\
+			while (i < mid) {													\
+				to[k++] = from[i++];											\
+			}																	\
+			while (j < hi) {													\
+				to[k++] = from[j++];											\
+			}																	\
+		}																		\
+		other = from;															\
+		from = to;																\
+		to = other;																\
+	}																			\
+	if (from != items) {														\
+		memcpy(items, from, length * sizeof(Type));								\
+	}																			\
+}
+
+typedef struct KeyIndex {
+	long key;
+	unsigned long index;
+} KeyIndex;
+
+#define LESS_RECORD(a, b) (compare(ELEMENT(list, a), ELEMENT(list, b)) < 0)
+#define LESS_KEY(a, b) ((a).key < (b).key)
+
+DEFINE_MERGE_SORT(sort_indices, unsigned long, LESS_RECORD)
+DEFINE_MERGE_SORT(sort_indices32, uint32_t, LESS_RECORD)
+DEFINE_MERGE_SORT(sort_keys, KeyIndex, LESS_KEY)
+
+static int append(AList *dst, const void *data);
+static unsigned long gallop(AList *list, unsigned long from, const void *key, DSCompare compare);
+static const DSAllocator *scratch_allocator(const AList *list);
+static int argsort(AList *list, DSCompare compare, unsigned long *out_indices);
+static int permute(AList *list, const unsigned long *indices, const uint32_t *indices32);
+static int merge_k(AList *dst, AList **lists, unsigned long k, DSCompare compare, int unique);
+static int merge_two(AList *dst, AList *a, AList *b, DSCompare compare, int unique);
+static int emit(AList *dst, const void *data, DSCompare compare, int unique);
+
 
 AList *alist_new(unsigned long max_length, unsigned long data_size) {
+	return alist_new_with(NULL, max_length, data_size);
+}
+
+AList *alist_new_in(DSArena *arena, unsigned long max_length, unsigned long data_size) {
+	return alist_new_with(ds_arena_allocator(arena), max_length, data_size);
+}
+
+AList *alist_new_with(const DSAllocator *allocator, unsigned long max_length, unsigned long data_size) {
 	AList *list;
-	list = malloc(sizeof(AList));
+	list = ds_alloc_with(allocator, sizeof(AList));
 	if (!list) {
 		return NULL;
 	}
 	list->max_length = max_length;
 	list->data_size = data_size;
 	list->length = 0L;
-	list->array = malloc((max_length + 1) * data_size);  // the last element is the temporary element used for sorting
+	list->allocator = allocator;
+	list->array = ds_alloc_with(allocator, (max_length + 1) * data_size);  // the last element is the temporary element used for sorting
 	if (!list->array) {
-		free(list);
+		ds_free_with(allocator, list, sizeof(AList));
 		return NULL;
 	}
+#ifdef DS_STATS
+	ds_stats_reset(&list->stats);
+	list->stats.allocations = 2;
+#endif
 	return list;
 }
 
 void alist_delete(AList *list) {
 	if (list) {
-		free(list->array);
-		free(list);
+		ds_free_with(list->allocator, list->array, (list->max_length + 1) * list->data_size);
+		ds_free_with(list->allocator, list, sizeof(AList));
 	}
 }
 
@@ -31,6 +116,10 @@ int alist_resize(AList *list, unsigned long length, const void *filler) {
 	if (length >= list->max_length) {
 		return DS_OVERFLOW;
 	}
+	DS_STAT(&list->stats, ops, 1);
+	if (list->length < length) {
+		DS_STAT(&list->stats, bytes_moved, (length - list->length) * list->data_size);
+	}
 	for (; list->length < length; list->length++) {
 		memcpy(list->array + list->length * list->data_size, filler, list->data_size);
 	}
@@ -44,6 +133,8 @@ int alist_push(AList *list, const void *data) {
 	}
 	memcpy(list->array + list->length * list->data_size, data, list->data_size);
 	list->length++;
+	DS_STAT(&list->stats, ops, 1);
+	DS_STAT(&list->stats, bytes_moved, list->data_size);
 	return DS_OK;
 }
 
@@ -53,6 +144,8 @@ int alist_pop(AList *list, void *out_data) {
 	}
 	list->length--;
 	memcpy(out_data, list->array + list->length * list->data_size, list->data_size);
+	DS_STAT(&list->stats, ops, 1);
+	DS_STAT(&list->stats, bytes_moved, list->data_size);
 	return DS_OK;
 }
 
@@ -61,6 +154,8 @@ int alist_set(AList *list, unsigned long index, const void *data) {
 		return DS_OUT_OF_BOUNDS;
 	}
 	memcpy(list->array + index * list->data_size, data, list->data_size);
+	DS_STAT(&list->stats, ops, 1);
+	DS_STAT(&list->stats, bytes_moved, list->data_size);
 	return DS_OK;
 }
 
@@ -69,6 +164,8 @@ int alist_get(AList *list, unsigned long index, void *out_data) {
 		return DS_OUT_OF_BOUNDS;
 	}
 	memcpy(out_data, list->array + index * list->data_size, list->data_size);
+	DS_STAT(&list->stats, ops, 1);
+	DS_STAT(&list->stats, bytes_moved, list->data_size);
 	return DS_OK;
 }
 
@@ -79,6 +176,9 @@ int alist_add(AList *list, unsigned long index, const void *data) {
 	if (list->length == list->max_length) {
 		return DS_OVERFLOW;
 	}
+	DS_STAT(&list->stats, ops, 1);
+	DS_STAT(&list->stats, bytes_moved, (list->length - index + 1) * list->data_size);
+	DS_STAT_COST(&list->stats, list->length - index);
 	for (unsigned long i = list->length; i > index; i--) {
 		memcpy(list->array + i * list->data_size,
 			   list->array + (i-1) * list->data_size,
@@ -96,6 +196,9 @@ int alist_remove(AList *list, unsigned long index) {
 	if (list->length == 0) {
 		return DS_EMPTY;
 	}
+	DS_STAT(&list->stats, ops, 1);
+	DS_STAT(&list->stats, bytes_moved, (list->length - index - 1) * list->data_size);
+	DS_STAT_COST(&list->stats, list->length - index - 1);
 	for (; index < list->length; index++) {
 		memcpy(list->array + index * list->data_size,
 			   list->array + (index+1) * list->data_size,
@@ -110,9 +213,465 @@ void alist_clear(AList *list) {
 }
 
 
+// Moves each run of records kept at once, behind the ones kept before,
+// calling predicate once for each record.
+int alist_remove_if(AList *list, DSPredicate predicate, void *context) {
+	unsigned long kept = 0;
+	unsigned long run = 0;
+	for (unsigned long i = 0; i <= list->length; i++) {
+		if (i < list->length && !predicate(ELEMENT(list, i), context)) {
+			continue;
+		}
+		if (run != kept && i > run) {
+			memmove(ELEMENT(list, kept), ELEMENT(list, run), (i - run) * list->data_size);
+			DS_STAT(&list->stats, bytes_moved, (i - run) * list->data_size);
+		}
+		kept += i - run;
+		run = i + 1;
+	}
+	list->length = kept;
+	DS_STAT(&list->stats, ops, 1);
+	return DS_OK;
+}
+
+int alist_unique(AList *list, DSCompare compare) {
+	unsigned long kept = list->length > 0;
+	for (unsigned long i = 1; i < list->length; i++) {
+		if (compare(ELEMENT(list, kept - 1), ELEMENT(list, i)) != 0) {
+			if (i != kept) {
+				memcpy(ELEMENT(list, kept), ELEMENT(list, i), list->data_size);
+				DS_STAT(&list->stats, bytes_moved, list->data_size);
+			}
+			kept++;
+		}
+	}
+	DS_STAT(&list->stats, ops, 1);
+	DS_STAT(&list->stats, compares, list->length > 0 ? list->length - 1 : 0);
+	list->length = kept;
+	return DS_OK;
+}
+
+// Swaps the first record not selected from the left with the last one
+// selected from the right, through the temporary element.
+int alist_partition(AList *list, DSPredicate predicate, void *context, unsigned long *out_index) {
+	unsigned char *tmp = ELEMENT(list, list->max_length);
+	unsigned long i = 0, j = list->length;
+	for (;;) {
+		while (i < j && predicate(ELEMENT(list, i), context)) {
+			i++;
+		}
+		while (i < j && !predicate(ELEMENT(list, j - 1), context)) {
+			j--;
+		}
+		if (i >= j) {
+			break;
+		}
+		memcpy(tmp, ELEMENT(list, i), list->data_size);
+		memcpy(ELEMENT(list, i), ELEMENT(list, j - 1), list->data_size);
+		memcpy(ELEMENT(list, j - 1), tmp, list->data_size);
+		DS_STAT(&list->stats, bytes_moved, 3 * list->data_size);
+		i++;
+		j--;
+	}
+	if (out_index) {
+		*out_index = i;
+	}
+	DS_STAT(&list->stats, ops, 1);
+	return DS_OK;
+}
+
 int alist_sort(AList *list, DSCompare compare) {
 	unsigned char *tmp = list->array + list->max_length * list->data_size;
+	DS_STAT(&list->stats, ops, 1);
+	if (list->data_size > ALIST_INDIRECT_SORT_SIZE) {
+		const DSAllocator *allocator = scratch_allocator(list);
+		unsigned long size = list->length * sizeof(unsigned long);
+		unsigned long *indices = ds_alloc_with(allocator, size ? size : 1);
+		if (indices) {
+			int rval = argsort(list, compare, indices);
+			if (rval == DS_OK) {
+				rval = permute(list, indices, NULL);
+			}
+			ds_free_with(allocator, indices, size ? size : 1);
+			if (rval == DS_OK) {
+				return DS_OK;
+			}
+		}
+	}
+#ifdef DS_STATS
+	DSStats *bound = ds_stats_bind(&list->stats);
+#endif
 	ds_quick_sort(list->array, list->length, list->data_size, tmp, compare);
+#ifdef DS_STATS
+	ds_stats_bind(bound);
+#endif
+	return DS_OK;
+}
+
+int alist_nth_element(AList *list, unsigned long nth, DSCompare compare) {
+	unsigned char *tmp = list->array + list->max_length * list->data_size;
+	if (nth >= list->length) {
+		return DS_OUT_OF_BOUNDS;
+	}
+#ifdef DS_STATS
+	DSStats *bound = ds_stats_bind(&list->stats);
+	list->stats.ops++;
+#endif
+	ds_nth_element(list->array, list->length, list->data_size, tmp, nth, compare);
+#ifdef DS_STATS
+	ds_stats_bind(bound);
+#endif
+	return DS_OK;
+}
+
+int alist_partial_sort(AList *list, unsigned long k, DSCompare compare) {
+	unsigned char *tmp = list->array + list->max_length * list->data_size;
+#ifdef DS_STATS
+	DSStats *bound = ds_stats_bind(&list->stats);
+	list->stats.ops++;
+#endif
+	ds_partial_sort(list->array, list->length, list->data_size, tmp, k, compare);
+#ifdef DS_STATS
+	ds_stats_bind(bound);
+#endif
+	return DS_OK;
+}
+
+int alist_argsort(AList *list, DSCompare compare, unsigned long *out_indices) {
+	int rval = argsort(list, compare, out_indices);
+	if (rval == DS_OK) {
+		DS_STAT(&list->stats, ops, 1);
+	}
+	return rval;
+}
+
+int alist_argsort32(AList *list, DSCompare compare, uint32_t *out_indices) {
+	unsigned long size = list->length * sizeof(uint32_t);
+	uint32_t *buffer;
+	if (list->length > UINT32_MAX) {
+		return DS_OVERFLOW;
+	}
+	buffer = ds_alloc_with(scratch_allocator(list), size ? size : 1);
+	if (!buffer) {
+		return DS_MALLOC_ERROR;
+	}
+	for (unsigned long i = 0; i < list->length; i++) {
+		out_indices[i] = (uint32_t) i;
+	}
+	sort_indices32(out_indices, buffer, list->length, list, compare);
+	ds_free_with(scratch_allocator(list), buffer, size ? size : 1);
+	DS_STAT(&list->stats, ops, 1);
 	return DS_OK;
 }
 
+// Sorts the pairs of the keys and the indices, which are compared inline.
+int alist_argsort_key(AList *list, DSKey key, unsigned long *out_indices) {
+	unsigned long size = 2 * list->length * sizeof(KeyIndex);
+	KeyIndex *pairs = ds_alloc_with(scratch_allocator(list), size ? size : 1);
+	if (!pairs) {
+		return DS_MALLOC_ERROR;
+	}
+	for (unsigned long i = 0; i < list->length; i++) {
+		pairs[i].key = key(ELEMENT(list, i));
+		pairs[i].index = i;
+	}
+	sort_keys(pairs, pairs + list->length, list->length, list, NULL);
+	for (unsigned long i = 0; i < list->length; i++) {
+		out_indices[i] = pairs[i].index;
+	}
+	ds_free_with(scratch_allocator(list), pairs, size ? size : 1);
+	DS_STAT(&list->stats, ops, 1);
+	return DS_OK;
+}
+
+int alist_apply_permutation(AList *list, const unsigned long *indices) {
+	int rval = permute(list, indices, NULL);
+	if (rval == DS_OK) {
+		DS_STAT(&list->stats, ops, 1);
+	}
+	return rval;
+}
+
+int alist_apply_permutation32(AList *list, const uint32_t *indices) {
+	int rval = permute(list, NULL, indices);
+	if (rval == DS_OK) {
+		DS_STAT(&list->stats, ops, 1);
+	}
+	return rval;
+}
+
+const DSStats *alist_stats(AList *list) {
+	return DS_STATS_OF(list);
+}
+
+
+int alist_union_sorted(AList *dst, AList *a, AList *b, DSCompare compare) {
+	unsigned long i = 0, j = 0;
+	alist_clear(dst);
+	while (i < a->length && j < b->length) {
+		int c = compare(ELEMENT(a, i), ELEMENT(b, j));
+		if (append(dst, c <= 0 ? ELEMENT(a, i) : ELEMENT(b, j)) != DS_OK) {
+			return DS_OVERFLOW;
+		}
+		i += c <= 0;
+		j += c >= 0;
+	}
+	for (; i < a->length; i++) {
+		if (append(dst, ELEMENT(a, i)) != DS_OK) {
+			return DS_OVERFLOW;
+		}
+	}
+	for (; j < b->length; j++) {
+		if (append(dst, ELEMENT(b, j)) != DS_OK) {
+			return DS_OVERFLOW;
+		}
+	}
+	return DS_OK;
+}
+
+int alist_intersection_sorted(AList *dst, AList *a, AList *b, DSCompare compare) {
+	unsigned long i = 0, j = 0;
+	alist_clear(dst);
+	if (a->length > b->length) {
+		AList *tmp = a;
+		a = b;
+		b = tmp;
+	}
+	if (a->length * GALLOP_RATIO < b->length) {
+		// look each element of the short list up in the rest of the long one
+		for (; i < a->length && j < b->length; i++) {
+			j = gallop(b, j, ELEMENT(a, i), compare);
+			if (j < b->length && compare(ELEMENT(b, j), ELEMENT(a, i)) == 0) {
+				if (append(dst, ELEMENT(a, i)) != DS_OK) {
+					return DS_OVERFLOW;
+				}
+				j++;
+			}
+		}
+		return DS_OK;
+	}
+	while (i < a->length && j < b->length) {
+		int c = compare(ELEMENT(a, i), ELEMENT(b, j));
+		if (c == 0 && append(dst, ELEMENT(a, i)) != DS_OK) {
+			return DS_OVERFLOW;
+		}
+		i += c <= 0;
+		j += c >= 0;
+	}
+	return DS_OK;
+}
+
+int alist_difference_sorted(AList *dst, AList *a, AList *b, DSCompare compare) {
+	unsigned long i = 0, j = 0;
+	alist_clear(dst);
+	while (i < a->length && j < b->length) {
+		int c = compare(ELEMENT(a, i), ELEMENT(b, j));
+		if (c < 0 && append(dst, ELEMENT(a, i)) != DS_OK) {
+			return DS_OVERFLOW;
+		}
+		i += c <= 0;
+		j += c >= 0;
+	}
+	for (; i < a->length; i++) {
+		if (append(dst, ELEMENT(a, i)) != DS_OK) {
+			return DS_OVERFLOW;
+		}
+	}
+	return DS_OK;
+}
+
+int alist_merge_k(AList *dst, AList **lists, unsigned long k, DSCompare compare) {
+	return merge_k(dst, lists, k, compare, 0);
+}
+
+int alist_merge_k_unique(AList *dst, AList **lists, unsigned long k, DSCompare compare) {
+	return merge_k(dst, lists, k, compare, 1);
+}
+
+
+static int append(AList *dst, const void *data) {
+	if (dst->length == dst->max_length) {
+		return DS_OVERFLOW;
+	}
+	memcpy(ELEMENT(dst, dst->length), data, dst->data_size);
+	dst->length++;
+	return DS_OK;
+}
+
+// The heads of the tree point into the lists, at the index of each in
+// positions.
+static int merge_k(AList *dst, AList **lists, unsigned long k, DSCompare compare, int unique) {
+	unsigned long *positions;
+	const void **heads;
+	DSLoserTree *tree;
+	int rval = DS_OK;
+	alist_clear(dst);
+	if (k <= 2) {
+		return merge_two(dst, k > 0 ? lists[0] : NULL, k > 1 ? lists[1] : NULL, compare, unique);
+	}
+	positions = ds_alloc_with(scratch_allocator(dst), k * sizeof(unsigned long));
+	heads = ds_alloc_with(scratch_allocator(dst), k * sizeof(const void *));
+	tree = ds_loser_tree_new_with(scratch_allocator(dst), k, compare);
+	if (!positions || !heads || !tree) {
+		rval = DS_MALLOC_ERROR;
+	}
+	else {
+		for (unsigned long i = 0; i < k; i++) {
+			positions[i] = 0;
+			heads[i] = lists[i]->length > 0 ? ELEMENT(lists[i], 0) : NULL;
+		}
+		ds_loser_tree_init(tree, heads);
+		for (;;) {
+			unsigned long winner = ds_loser_tree_winner(tree);
+			AList *list;
+			if (winner == k) {
+				break;
+			}
+			list = lists[winner];
+			if (emit(dst, ELEMENT(list, positions[winner]), compare, unique) != DS_OK) {
+				rval = DS_OVERFLOW;
+				break;
+			}
+			positions[winner]++;
+			ds_loser_tree_replace(tree, positions[winner] < list->length ? ELEMENT(list, positions[winner]) : NULL);
+		}
+	}
+	if (positions) {
+		ds_free_with(scratch_allocator(dst), positions, k * sizeof(unsigned long));
+	}
+	if (heads) {
+		ds_free_with(scratch_allocator(dst), heads, k * sizeof(const void *));
+	}
+	ds_loser_tree_delete(tree);
+	return rval;
+}
+
+// Merges a and b, either of which may be NULL, copying the rest of the one
+// left at once unless duplicates are to be dropped.
+static int merge_two(AList *dst, AList *a, AList *b, DSCompare compare, int unique) {
+	unsigned long i = 0, j = 0;
+	AList *rest;
+	unsigned long from;
+	while (a && b && i < a->length && j < b->length) {
+		int c = compare(ELEMENT(a, i), ELEMENT(b, j));
+		if (emit(dst, c <= 0 ? ELEMENT(a, i) : ELEMENT(b, j), compare, unique) != DS_OK) {
+			return DS_OVERFLOW;
+		}
+		i += c <= 0;
+		j += c > 0;
+	}
+	rest = a && i < a->length ? a : b;
+	from = rest == a ? i : j;
+	if (!rest) {
+		return DS_OK;
+	}
+	if (unique) {
+		for (; from < rest->length; from++) {
+			if (emit(dst, ELEMENT(rest, from), compare, unique) != DS_OK) {
+				return DS_OVERFLOW;
+			}
+		}
+		return DS_OK;
+	}
+	if (rest->length - from > dst->max_length - dst->length) {
+		unsigned long fits = dst->max_length - dst->length;
+		memcpy(ELEMENT(dst, dst->length), ELEMENT(rest, from), fits * dst->data_size);
+		dst->length += fits;
+		return DS_OVERFLOW;
+	}
+	memcpy(ELEMENT(dst, dst->length), ELEMENT(rest, from), (rest->length - from) * dst->data_size);
+	dst->length += rest->length - from;
+	return DS_OK;
+}
+
+// appends data unless it is a duplicate of the last record and unique is set
+static int emit(AList *dst, const void *data, DSCompare compare, int unique) {
+	if (unique && dst->length > 0 && compare(ELEMENT(dst, dst->length - 1), data) == 0) {
+		return DS_OK;
+	}
+	return append(dst, data);
+}
+
+// The allocator of the scratch buffers of list, which is that of the list
+// unless it never frees, like an arena, which would hold on to every
+// buffer until it is deleted. Those come from malloc instead.
+static const DSAllocator *scratch_allocator(const AList *list) {
+	if (list->allocator && !list->allocator->free) {
+		return NULL;
+	}
+	return list->allocator;
+}
+
+static int argsort(AList *list, DSCompare compare, unsigned long *out_indices) {
+	unsigned long size = list->length * sizeof(unsigned long);
+	unsigned long *buffer = ds_alloc_with(scratch_allocator(list), size ? size : 1);
+	if (!buffer) {
+		return DS_MALLOC_ERROR;
+	}
+	for (unsigned long i = 0; i < list->length; i++) {
+		out_indices[i] = i;
+	}
+	sort_indices(out_indices, buffer, list->length, list, compare);
+	ds_free_with(scratch_allocator(list), buffer, size ? size : 1);
+	return DS_OK;
+}
+
+// Follows each cycle of the permutation from its first record, which is
+// kept in the temporary element while the others move up the cycle. A
+// bitmap marks the records already in place.
+static int permute(AList *list, const unsigned long *indices, const uint32_t *indices32) {
+	unsigned char *tmp = ELEMENT(list, list->max_length);
+	unsigned long words = list->length / 64 + 1;
+	unsigned long long *done = ds_alloc_with(scratch_allocator(list), words * sizeof(unsigned long long));
+	if (!done) {
+		return DS_MALLOC_ERROR;
+	}
+	memset(done, 0, words * sizeof(unsigned long long));
+	for (unsigned long start = 0; start < list->length; start++) {
+		unsigned long i = start;
+		if (done[start / 64] >> (start % 64) & 1) {
+			continue;
+		}
+		memcpy(tmp, ELEMENT(list, start), list->data_size);
+		for (;;) {
+			unsigned long next = indices ? indices[i] : indices32[i];
+			done[i / 64] |= 1ULL << (i % 64);
+			if (next == start) {
+				memcpy(ELEMENT(list, i), tmp, list->data_size);
+				break;
+			}
+			memcpy(ELEMENT(list, i), ELEMENT(list, next), list->data_size);
+			i = next;
+		}
+	}
+	ds_free_with(scratch_allocator(list), done, words * sizeof(unsigned long long));
+	DS_STAT(&list->stats, bytes_moved, list->length * list->data_size);
+	return DS_OK;
+}
+
+// index of the first element from index from on that is not less than key,
+// found by doubling the step until it is passed and then by binary search.
+static unsigned long gallop(AList *list, unsigned long from, const void *key, DSCompare compare) {
+	unsigned long lo = from;
+	unsigned long hi = from;
+	unsigned long step = 1;
+	while (hi < list->length && compare(ELEMENT(list, hi), key) < 0) {
+		lo = hi + 1;
+		hi += step;
+		step *= 2;
+	}
+	if (hi > list->length) {
+		hi = list->length;
+	}
+	while (lo < hi) {
+		unsigned long mid = lo + (hi - lo) / 2;
+		if (compare(ELEMENT(list, mid), key) < 0) {
+			lo = mid + 1;
+		}
+		else {
+			hi = mid;
+		}
+	}
+	return lo;
+}
+
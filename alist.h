@@ -2,13 +2,17 @@
 #define __ALIST_H__
 
 #include "commons.h"
+#include <stdint.h>
 
 enum DataStructErrors {
 	DS_OK = 0,
 	DS_OVERFLOW,
 	DS_EMPTY,
 	DS_OUT_OF_BOUNDS,
-	DS_MALLOC_ERROR
+	DS_MALLOC_ERROR,
+	DS_NOT_FOUND,
+	DS_EXISTS,
+	DS_IO_ERROR
 };
 
 typedef struct AList {
@@ -16,10 +20,14 @@ typedef struct AList {
 	unsigned long max_length;
 	unsigned long data_size;
 	unsigned long length;
+	const DSAllocator *allocator;
+	DS_STATS_MEMBER
 } AList;
 
 
 AList *alist_new(unsigned long max_length, unsigned long data_size);
+AList *alist_new_in(DSArena *arena, unsigned long max_length, unsigned long data_size);
+AList *alist_new_with(const DSAllocator *allocator, unsigned long max_length, unsigned long data_size);
 void alist_delete(AList *list);
 
 int alist_resize(AList *list, unsigned long length, const void *filler);
@@ -35,7 +43,66 @@ int alist_remove(AList *list, unsigned long index);
 
 void alist_clear(AList *list);
 
+// Compaction in a single pass. alist_remove_if removes the records for
+// which predicate returns non zero, and alist_unique all but the first of
+// each run of records equal by compare, both keeping the order of the
+// rest. alist_partition moves the records for which predicate returns non
+// zero before the others, not keeping their order, and writes the index
+// of the first of the others to out_index.
+int alist_remove_if(AList *list, DSPredicate predicate, void *context);
+int alist_unique(AList *list, DSCompare compare);
+int alist_partition(AList *list, DSPredicate predicate, void *context, unsigned long *out_index);
+
 int alist_sort(AList *list, DSCompare compare);
 
+// Selection with ds_nth_element and ds_partial_sort. alist_nth_element
+// returns DS_OUT_OF_BOUNDS if nth is not less than the length, and
+// alist_partial_sort sorts the whole list if k is not.
+int alist_nth_element(AList *list, unsigned long nth, DSCompare compare);
+int alist_partial_sort(AList *list, unsigned long k, DSCompare compare);
+
+// Sorts of the indices of the records rather than the records. They write
+// to out_indices, of list->length entries, the indices of the records in
+// sorted order, stably, and leave the list as it is. alist_argsort32 writes
+// 32 bit indices, for lists of up to UINT32_MAX records, and returns
+// DS_OVERFLOW for longer ones. alist_argsort_key sorts the records by the
+// key that key returns, without calling a compare function.
+//
+// alist_apply_permutation reorders the records so that the record at i is
+// the one that was at indices[i], moving each record once. indices must be
+// a permutation of 0 to length-1.
+//
+// alist_sort sorts this way by itself when the records are larger than
+// ALIST_INDIRECT_SORT_SIZE bytes.
+#ifndef ALIST_INDIRECT_SORT_SIZE
+#define ALIST_INDIRECT_SORT_SIZE 128
+#endif
+
+int alist_argsort(AList *list, DSCompare compare, unsigned long *out_indices);
+int alist_argsort32(AList *list, DSCompare compare, uint32_t *out_indices);
+int alist_argsort_key(AList *list, DSKey key, unsigned long *out_indices);
+int alist_apply_permutation(AList *list, const unsigned long *indices);
+int alist_apply_permutation32(AList *list, const uint32_t *indices);
+
+// The stats of the list, or NULL if DS_STATS is not defined. Elements added
+// and removed add the number of elements shifted to the histogram.
+const DSStats *alist_stats(AList *list);
+
+// Set operations on lists sorted by compare. The result is written to dst,
+// which is cleared first and must not be one of the operands. Duplicates
+// are kept as many times as in std::set_union and the like. If dst is too
+// short, they return DS_OVERFLOW with the part of the result that fits.
+int alist_union_sorted(AList *dst, AList *a, AList *b, DSCompare compare);
+int alist_intersection_sorted(AList *dst, AList *a, AList *b, DSCompare compare);
+int alist_difference_sorted(AList *dst, AList *a, AList *b, DSCompare compare);
+
+// Merge of k lists sorted by compare into dst, which is cleared first and
+// must not be one of them, through a loser tree, or by a plain merge for
+// two lists. Equal records come in the order of their lists, and
+// alist_merge_k_unique keeps only the first of them. If dst is too short,
+// they return DS_OVERFLOW with the part of the result that fits.
+int alist_merge_k(AList *dst, AList **lists, unsigned long k, DSCompare compare);
+int alist_merge_k_unique(AList *dst, AList **lists, unsigned long k, DSCompare compare);
+
 
 #endif  // __ALIST_H__
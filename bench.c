@@ -0,0 +1,826 @@
+#include "commons.h"
+#include "alist.h"
+#include "pqueue.h"
+#include "hmap.h"
+#include "skiplist.h"
+#include "search.h"
+#include "soa.h"
+#include "extsort.h"
+#include "galist.h"
+#include "ptree.h"
+#include "itree.h"
+#include "segtree.h"
+#include "list.h"
+#include "map.h"
+#include "tree.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#if defined(__x86_64__) || defined(__i386__)
+#include <x86intrin.h>
+// reference cycles of the time stamp counter, not core cycles
+#define CYCLES() ((unsigned long long) __rdtsc())
+#define HAS_CYCLES 1
+#else
+#define CYCLES() 0ULL
+#define HAS_CYCLES 0
+#endif
+
+/*
+ * Benchmarks
+ * Runs each benchmark over every combination of input pattern, element
+ * size and number of elements, and prints the results as JSON to stdout
+ * and as a table to stderr, so runs can be compared across commits:
+ *
+ * ./bench > before.json
+ *
+ * Input patterns of the keys:
+ * - random: uniformly random.
+ * - sorted, reversed: 0 to n-1 ascending or descending.
+ * - duplicates: random, with about 16 copies of each key.
+ * - sawtooth: ascending runs of 1024 keys.
+ *
+ * Each element is a record of size bytes, 4 to 256, that starts with its
+ * int key. Benchmarks of the macro containers use long elements and ignore
+ * the size. The benchmark is repeated until it has run for MIN_TIME_NS, and
+ * ns/op is the total time over the total operations. Cycles are read from
+ * the time stamp counter where there is one, and are 0 otherwise.
+ *
+ * Options:
+ * --bench name		run only the benchmarks whose name contains name
+ * --input name		run only this input pattern
+ * --size bytes		run only this element size
+ * --n count		run only this number of elements
+ * --max-n count	largest number of elements, 1000000 by default; up to 1e8
+ * --max-bytes bytes	skip runs whose input is bigger, 1 GB by default
+ */
+
+#define MIN_TIME_NS 100000000ULL
+#define MAX_REPETITIONS 1000
+#define SAWTOOTH_RUN 1024
+
+typedef struct Workload {
+	const char *input;
+	unsigned long n;
+	unsigned long size;
+	unsigned char *data;  // n records of size bytes
+	int *keys;            // the key of each record
+} Workload;
+
+typedef struct Measure {
+	unsigned long long ns;
+	unsigned long long cycles;
+	unsigned long long start_ns;
+	unsigned long long start_cycles;
+	unsigned long ops;
+} Measure;
+
+typedef void (*BenchFunction) (const Workload *w, Measure *m);
+
+typedef struct Bench {
+	const char *name;
+	BenchFunction function;
+	int sized;                  // whether it uses the element size
+	unsigned long max_n;        // with any input
+	unsigned long max_n_order;  // with sorted, reversed and sawtooth inputs
+} Bench;
+
+
+static unsigned long long now_ns(void) {
+	struct timespec ts;
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+	return (unsigned long long) ts.tv_sec * 1000000000ULL + (unsigned long long) ts.tv_nsec;
+}
+
+static void start(Measure *m) {
+	m->start_cycles = CYCLES();
+	m->start_ns = now_ns();
+}
+
+static void stop(Measure *m) {
+	m->ns += now_ns() - m->start_ns;
+	m->cycles += CYCLES() - m->start_cycles;
+}
+
+// xorshift64*, so runs do not depend on the rand of the platform
+static unsigned long long random_state = 88172645463325252ULL;
+
+static unsigned long long next_random(void) {
+	random_state ^= random_state >> 12;
+	random_state ^= random_state << 25;
+	random_state ^= random_state >> 27;
+	return random_state * 2685821657736338717ULL;
+}
+
+static int key_at(const char *input, unsigned long i, unsigned long n) {
+	if (strcmp(input, "sorted") == 0) {
+		return (int) i;
+	}
+	else if (strcmp(input, "reversed") == 0) {
+		return (int) (n - 1 - i);
+	}
+	else if (strcmp(input, "duplicates") == 0) {
+		return (int) (next_random() % (n / 16 + 1));
+	}
+	else if (strcmp(input, "sawtooth") == 0) {
+		unsigned long run = n < SAWTOOTH_RUN ? n : SAWTOOTH_RUN;
+		return (int) ((i % run) * (n / run + 1) + i / run);
+	}
+	else {
+		return (int) (next_random() & 0x7fffffff);
+	}
+}
+
+static int make_workload(Workload *w, const char *input, unsigned long n, unsigned long size) {
+	w->input = input;
+	w->n = n;
+	w->size = size;
+	w->data = calloc(n, size);
+	w->keys = malloc(n * sizeof(int));
+	if (!w->data || !w->keys) {
+		free(w->data);
+		free(w->keys);
+		return 0;
+	}
+	random_state = 88172645463325252ULL;
+	for (unsigned long i = 0; i < n; i++) {
+		w->keys[i] = key_at(input, i, n);
+		memcpy(w->data + i * size, &w->keys[i], sizeof(int));
+	}
+	return 1;
+}
+
+static void free_workload(Workload *w) {
+	free(w->data);
+	free(w->keys);
+}
+
+static int compare_records(const void *a, const void *b) {
+	int x, y;
+	memcpy(&x, a, sizeof(int));
+	memcpy(&y, b, sizeof(int));
+	return (x > y) - (x < y);
+}
+
+static unsigned long hash_record(const void *key) {
+	int x;
+	memcpy(&x, key, sizeof(int));
+	return ds_hash_ulong((unsigned long) x);
+}
+
+static int compare_long(const long *a, const long *b) {
+	return (*a > *b) - (*a < *b);
+}
+
+static unsigned long hash_long(const long *key) {
+	return ds_hash_ulong((unsigned long) *key);
+}
+
+static int eq_long(const long *a, const long *b) {
+	return *a == *b;
+}
+
+#define HEAP_SIZE (1 << 20)
+
+DEFINE_ARRAY_LIST_DYN(long)
+DEFINE_LINKED_LIST(long)
+DEFINE_CHUNKED_LIST(long, 64)
+DEFINE_HEAP(long, HEAP_SIZE, compare_long)
+DEFINE_HASH_MAP(long, long, hash_long, eq_long)
+
+// sink for results, so the compiler does not drop the work
+static volatile long sink;
+
+
+static void bench_sort(const Workload *w, Measure *m) {
+	AList *list = alist_new(w->n, w->size);
+	memcpy(list->array, w->data, w->n * w->size);
+	list->length = w->n;
+	start(m);
+	alist_sort(list, compare_records);
+	stop(m);
+	m->ops += w->n;
+	alist_delete(list);
+}
+
+static void bench_nth_element(const Workload *w, Measure *m) {
+	AList *list = alist_new(w->n, w->size);
+	memcpy(list->array, w->data, w->n * w->size);
+	list->length = w->n;
+	start(m);
+	alist_nth_element(list, w->n / 2, compare_records);
+	stop(m);
+	m->ops += w->n;
+	alist_delete(list);
+}
+
+// the top 100 records, by partial sort and by a bounded heap
+static void bench_partial_sort(const Workload *w, Measure *m) {
+	AList *list = alist_new(w->n, w->size);
+	memcpy(list->array, w->data, w->n * w->size);
+	list->length = w->n;
+	start(m);
+	alist_partial_sort(list, 100, compare_records);
+	stop(m);
+	m->ops += w->n;
+	alist_delete(list);
+}
+
+static void bench_top_k(const Workload *w, Measure *m) {
+	PQueue *pq = pq_new(100, w->size, compare_records);
+	start(m);
+	for (unsigned long i = 0; i < w->n; i++) {
+		pq_offer(pq, w->data + i * w->size);
+	}
+	stop(m);
+	m->ops += w->n;
+	pq_delete(pq);
+}
+
+// an eighth of the input in memory, so that it is merged from 8 runs
+static void bench_extsort(const Workload *w, Measure *m) {
+	FILE *in = tmpfile();
+	FILE *out = tmpfile();
+	unsigned long memory = w->n * w->size / 8;
+	fwrite(w->data, w->size, w->n, in);
+	rewind(in);
+	start(m);
+	ds_external_sort(in, out, w->size, memory > (1UL << 20) ? memory : (1UL << 20), compare_records);
+	stop(m);
+	m->ops += w->n;
+	fclose(in);
+	fclose(out);
+}
+
+// the records dealt to 32 shards, each sorted, and merged back
+static void bench_merge_k(const Workload *w, Measure *m) {
+	AList *shards[32];
+	AList *dst = alist_new(w->n, w->size);
+	for (unsigned long s = 0; s < 32; s++) {
+		shards[s] = alist_new(w->n / 32 + 1, w->size);
+	}
+	for (unsigned long i = 0; i < w->n; i++) {
+		alist_push(shards[i % 32], w->data + i * w->size);
+	}
+	for (unsigned long s = 0; s < 32; s++) {
+		alist_sort(shards[s], compare_records);
+	}
+	start(m);
+	alist_merge_k(dst, shards, 32, compare_records);
+	stop(m);
+	m->ops += w->n;
+	for (unsigned long s = 0; s < 32; s++) {
+		alist_delete(shards[s]);
+	}
+	alist_delete(dst);
+}
+
+static int is_odd_record(const void *record, void *context) {
+	int key;
+	(void) context;
+	memcpy(&key, record, sizeof(int));
+	return key % 2 != 0;
+}
+
+// removes about half of the records in one pass
+static void bench_remove_if(const Workload *w, Measure *m) {
+	AList *list = alist_new(w->n, w->size);
+	memcpy(list->array, w->data, w->n * w->size);
+	list->length = w->n;
+	start(m);
+	alist_remove_if(list, is_odd_record, NULL);
+	stop(m);
+	m->ops += w->n;
+	sink = (long) list->length;
+	alist_delete(list);
+}
+
+static void bench_alist_push(const Workload *w, Measure *m) {
+	AList *list = alist_new(w->n, w->size);
+	start(m);
+	for (unsigned long i = 0; i < w->n; i++) {
+		alist_push(list, w->data + i * w->size);
+	}
+	stop(m);
+	m->ops += w->n;
+	alist_delete(list);
+}
+
+static void bench_alist_add(const Workload *w, Measure *m) {
+	AList *list = alist_new(w->n, w->size);
+	start(m);
+	for (unsigned long i = 0; i < w->n; i++) {
+		alist_add(list, (unsigned long) w->keys[i] % (list->length + 1), w->data + i * w->size);
+	}
+	stop(m);
+	m->ops += w->n;
+	alist_delete(list);
+}
+
+// inserts around a cursor that moves by -1, 0 or 1 with each key
+static unsigned long next_cursor(unsigned long cursor, int key, unsigned long length) {
+	unsigned long step = (unsigned long) key % 3;
+	cursor = cursor + step > 0 ? cursor + step - 1 : 0;
+	return cursor < length ? cursor : length;
+}
+
+static void bench_alist_cursor(const Workload *w, Measure *m) {
+	AList *list = alist_new(w->n, w->size);
+	unsigned long cursor = 0;
+	start(m);
+	for (unsigned long i = 0; i < w->n; i++) {
+		cursor = next_cursor(cursor, w->keys[i], list->length);
+		alist_add(list, cursor, w->data + i * w->size);
+	}
+	stop(m);
+	m->ops += w->n;
+	alist_delete(list);
+}
+
+static void bench_galist_cursor(const Workload *w, Measure *m) {
+	GapAList *list = galist_new(w->n, w->size);
+	unsigned long cursor = 0;
+	start(m);
+	for (unsigned long i = 0; i < w->n; i++) {
+		cursor = next_cursor(cursor, w->keys[i], galist_length(list));
+		galist_add(list, cursor, w->data + i * w->size);
+	}
+	stop(m);
+	m->ops += w->n;
+	galist_delete(list);
+}
+
+static void bench_alist_get(const Workload *w, Measure *m) {
+	AList *list = alist_new(w->n, w->size);
+	unsigned char *out = malloc(w->size);
+	memcpy(list->array, w->data, w->n * w->size);
+	list->length = w->n;
+	start(m);
+	for (unsigned long i = 0; i < w->n; i++) {
+		alist_get(list, (unsigned long) w->keys[i] % w->n, out);
+	}
+	stop(m);
+	m->ops += w->n;
+	sink = out[0];
+	free(out);
+	alist_delete(list);
+}
+
+static void bench_bt_insert(const Workload *w, Measure *m) {
+	BTree *root = NULL;
+	start(m);
+	root = bt_insert(root, w->keys[0]);
+	for (unsigned long i = 1; i < w->n; i++) {
+		bt_insert(root, w->keys[i]);
+	}
+	stop(m);
+	m->ops += w->n;
+	bt_free(root);
+}
+
+static void bench_bt_find(const Workload *w, Measure *m) {
+	BTree *root = bt_insert(NULL, w->keys[0]);
+	long found = 0;
+	for (unsigned long i = 1; i < w->n; i++) {
+		bt_insert(root, w->keys[i]);
+	}
+	start(m);
+	for (unsigned long i = 0; i < w->n; i++) {
+		found += bt_find(root, w->keys[(i * 7919) % w->n]) != NULL;
+	}
+	stop(m);
+	m->ops += w->n;
+	sink = found;
+	bt_free(root);
+}
+
+// a new version per insert, with the one before it released, as a writer
+// that publishes snapshots does
+static void bench_pt_insert(const Workload *w, Measure *m) {
+	PTree *root = NULL;
+	start(m);
+	for (unsigned long i = 0; i < w->n; i++) {
+		PTree *next;
+		if (pt_insert(root, w->keys[i], &next) != DS_MALLOC_ERROR) {
+			pt_release(root);
+			root = next;
+		}
+	}
+	stop(m);
+	m->ops += w->n;
+	sink = (long) pt_length(root);
+	pt_release(root);
+}
+
+// short ranges starting at the keys, stabbed at the keys in another order
+static void bench_it_stab(const Workload *w, Measure *m) {
+	ITree *tree = it_new(sizeof(ITInterval));
+	unsigned long found = 0;
+	for (unsigned long i = 0; i < w->n; i++) {
+		ITInterval interval = { w->keys[i], w->keys[i] + w->keys[i] % 64 };
+		it_insert(tree, &interval);
+	}
+	start(m);
+	for (unsigned long i = 0; i < w->n; i++) {
+		long point = w->keys[(i * 7919) % w->n];
+		found += it_count_overlaps(tree, point, point);
+	}
+	stop(m);
+	m->ops += w->n;
+	sink = (long) found;
+	it_delete(tree);
+}
+
+static void bench_seg_sum(const Workload *w, Measure *m) {
+	long *values = malloc(w->n * sizeof(long));
+	long sum = 0;
+	for (unsigned long i = 0; i < w->n; i++) {
+		values[i] = w->keys[i];
+	}
+	SegTree *tree = seg_new(values, w->n);
+	start(m);
+	for (unsigned long i = 0; i < w->n; i++) {
+		unsigned long from = (unsigned long) w->keys[i] % w->n;
+		unsigned long to = from + (unsigned long) w->keys[(i * 7919) % w->n] % (w->n - from + 1);
+		long out;
+		seg_sum(tree, from, to, &out);
+		sum += out;
+	}
+	stop(m);
+	m->ops += w->n;
+	sink = sum;
+	seg_delete(tree);
+	free(values);
+}
+
+static void bench_llh_queue(const Workload *w, Measure *m) {
+	LLHandle_long list = { 0 };
+	long sum = 0;
+	start(m);
+	for (unsigned long i = 0; i < w->n; i++) {
+		llh_long_push_back(&list, w->keys[i]);
+	}
+	while (list.length > 0) {
+		sum += llh_long_pop_front(&list);
+	}
+	stop(m);
+	m->ops += 2 * w->n;
+	sink = sum;
+}
+
+static void bench_ck_queue(const Workload *w, Measure *m) {
+	CkList_long list = { 0 };
+	long sum = 0;
+	start(m);
+	for (unsigned long i = 0; i < w->n; i++) {
+		ck_long_push_tail(&list, w->keys[i]);
+	}
+	while (list.length > 0) {
+		sum += ck_long_pop_head(&list);
+	}
+	stop(m);
+	m->ops += 2 * w->n;
+	sink = sum;
+	ck_long_clear(&list);
+}
+
+static void bench_dyn_push(const Workload *w, Measure *m) {
+	List_long_dyn list;
+	al_long_dyn_init(&list, 0);
+	start(m);
+	for (unsigned long i = 0; i < w->n; i++) {
+		al_long_dyn_push_grow(&list, w->keys[i]);
+	}
+	stop(m);
+	m->ops += w->n;
+	al_long_dyn_free(&list);
+}
+
+static void bench_heap(const Workload *w, Measure *m) {
+	Heap_long *heap = calloc(1, sizeof(Heap_long));
+	long sum = 0;
+	start(m);
+	for (unsigned long i = 0; i < w->n; i++) {
+		hp_long_push(heap, w->keys[i]);
+	}
+	while (hp_long_length(heap) > 0) {
+		sum += hp_long_pop(heap);
+	}
+	stop(m);
+	m->ops += 2 * w->n;
+	sink = sum;
+	free(heap);
+}
+
+static void bench_pqueue(const Workload *w, Measure *m) {
+	PQueue *pq = pq_new(w->n, w->size, compare_records);
+	unsigned char *out = malloc(w->size);
+	start(m);
+	for (unsigned long i = 0; i < w->n; i++) {
+		pq_push(pq, w->data + i * w->size, NULL);
+	}
+	while (pq_length(pq) > 0) {
+		pq_pop(pq, out);
+	}
+	stop(m);
+	m->ops += 2 * w->n;
+	sink = out[0];
+	free(out);
+	pq_delete(pq);
+}
+
+static void bench_hm_put(const Workload *w, Measure *m) {
+	HashMap_long_long map = { 0 };
+	start(m);
+	for (unsigned long i = 0; i < w->n; i++) {
+		hm_long_long_put(&map, w->keys[i], (long) i);
+	}
+	stop(m);
+	m->ops += w->n;
+	hm_long_long_free(&map);
+}
+
+static void bench_hm_find(const Workload *w, Measure *m) {
+	HashMap_long_long map = { 0 };
+	long found = 0;
+	for (unsigned long i = 0; i < w->n; i++) {
+		hm_long_long_put(&map, w->keys[i], (long) i);
+	}
+	start(m);
+	for (unsigned long i = 0; i < w->n; i++) {
+		found += hm_long_long_find(&map, w->keys[(i * 7919) % w->n]) != NULL;
+	}
+	stop(m);
+	m->ops += w->n;
+	sink = found;
+	hm_long_long_free(&map);
+}
+
+// the key is the first int of the record and the value the rest of it
+static void bench_hmap_put(const Workload *w, Measure *m) {
+	HMap *map = hmap_new(0, sizeof(int), w->size - sizeof(int), hash_record, compare_records);
+	start(m);
+	for (unsigned long i = 0; i < w->n; i++) {
+		const unsigned char *record = w->data + i * w->size;
+		hmap_put(map, record, record + sizeof(int));
+	}
+	stop(m);
+	m->ops += w->n;
+	hmap_delete(map);
+}
+
+static void bench_hmap_find(const Workload *w, Measure *m) {
+	HMap *map = hmap_new(0, sizeof(int), w->size - sizeof(int), hash_record, compare_records);
+	long found = 0;
+	for (unsigned long i = 0; i < w->n; i++) {
+		const unsigned char *record = w->data + i * w->size;
+		hmap_put(map, record, record + sizeof(int));
+	}
+	start(m);
+	for (unsigned long i = 0; i < w->n; i++) {
+		found += hmap_find(map, &w->keys[(i * 7919) % w->n]) != NULL;
+	}
+	stop(m);
+	m->ops += w->n;
+	sink = found;
+	hmap_delete(map);
+}
+
+static void bench_sl_put(const Workload *w, Measure *m) {
+	SkipList *list = sl_new(sizeof(int), w->size - sizeof(int), compare_records);
+	start(m);
+	for (unsigned long i = 0; i < w->n; i++) {
+		const unsigned char *record = w->data + i * w->size;
+		sl_put(list, record, record + sizeof(int));
+	}
+	stop(m);
+	m->ops += w->n;
+	sl_delete(list);
+}
+
+static void bench_sl_find(const Workload *w, Measure *m) {
+	SkipList *list = sl_new(sizeof(int), w->size - sizeof(int), compare_records);
+	long found = 0;
+	for (unsigned long i = 0; i < w->n; i++) {
+		const unsigned char *record = w->data + i * w->size;
+		sl_put(list, record, record + sizeof(int));
+	}
+	start(m);
+	for (unsigned long i = 0; i < w->n; i++) {
+		found += sl_find(list, &w->keys[(i * 7919) % w->n]) != NULL;
+	}
+	stop(m);
+	m->ops += w->n;
+	sink = found;
+	sl_delete(list);
+}
+
+// the key is absent, so the scans read the whole array
+static void bench_scan_find(const Workload *w, Measure *m) {
+	int key = -1;
+	start(m);
+	sink = (long) ds_find(w->keys, w->n, sizeof(int), &key);
+	stop(m);
+	m->ops += w->n;
+}
+
+static void bench_scan_count(const Workload *w, Measure *m) {
+	int key = w->keys[0];
+	start(m);
+	sink = (long) ds_count(w->keys, w->n, sizeof(int), &key);
+	stop(m);
+	m->ops += w->n;
+}
+
+static void bench_scan_min_max(const Workload *w, Measure *m) {
+	int min, max;
+	start(m);
+	ds_min_max(w->keys, w->n, sizeof(int), &min, &max);
+	stop(m);
+	m->ops += w->n;
+	sink = min + max;
+}
+
+static void bench_scan_filter(const Workload *w, Measure *m) {
+	int *dst = malloc(w->n * sizeof(int));
+	int lo = 0, hi = (int) (w->n / 2);
+	unsigned long length;
+	start(m);
+	ds_filter_range(dst, &length, w->keys, w->n, sizeof(int), &lo, &hi);
+	stop(m);
+	m->ops += w->n;
+	sink = (long) length;
+	free(dst);
+}
+
+// records split into a column of keys and a column of the rest
+static SoA *soa_of(const Workload *w) {
+	SoAField fields[] = { { 0, sizeof(int) }, { sizeof(int), w->size - sizeof(int) } };
+	SoA *list = soa_new(fields, w->size > sizeof(int) ? 2 : 1, w->size, w->n);
+	for (unsigned long i = 0; i < w->n; i++) {
+		soa_push(list, w->data + i * w->size);
+	}
+	return list;
+}
+
+static void bench_soa_sort(const Workload *w, Measure *m) {
+	SoA *list = soa_of(w);
+	start(m);
+	soa_sort(list, 0, compare_records);
+	stop(m);
+	m->ops += w->n;
+	soa_delete(list);
+}
+
+static void bench_soa_count(const Workload *w, Measure *m) {
+	SoA *list = soa_of(w);
+	int key = w->keys[0];
+	start(m);
+	sink = (long) soa_count(list, 0, &key);
+	stop(m);
+	m->ops += w->n;
+	soa_delete(list);
+}
+
+
+static const Bench benches[] = {
+	// name				function			sized	max_n		max_n_order
+	{ "sort",			bench_sort,			1,		100000000,	100000000 },
+	{ "nth_element",	bench_nth_element,	1,		100000000,	100000000 },
+	{ "partial_sort",	bench_partial_sort,	1,		100000000,	100000000 },
+	{ "top_k",			bench_top_k,		1,		100000000,	100000000 },
+	{ "extsort",		bench_extsort,		1,		100000000,	100000000 },
+	{ "merge_k",		bench_merge_k,		1,		100000000,	100000000 },
+	{ "remove_if",		bench_remove_if,	1,		100000000,	100000000 },
+	{ "alist_push",		bench_alist_push,	1,		100000000,	100000000 },
+	{ "alist_add",		bench_alist_add,	1,		10000,		10000 },
+	{ "alist_cursor",	bench_alist_cursor,	1,		100000,		100000 },
+	{ "galist_cursor",	bench_galist_cursor,	1,		100000000,	100000000 },
+	{ "alist_get",		bench_alist_get,	1,		100000000,	100000000 },
+	{ "bt_insert",		bench_bt_insert,	0,		10000000,	10000 },
+	{ "bt_find",		bench_bt_find,		0,		10000000,	10000 },
+	{ "pt_insert",		bench_pt_insert,	0,		100000000,	100000000 },
+	{ "it_stab",		bench_it_stab,		0,		100000000,	100000000 },
+	{ "seg_sum",		bench_seg_sum,		0,		100000000,	100000000 },
+	{ "llh_queue",		bench_llh_queue,	0,		100000000,	100000000 },
+	{ "ck_queue",		bench_ck_queue,		0,		100000000,	100000000 },
+	{ "dyn_push",		bench_dyn_push,		0,		100000000,	100000000 },
+	{ "heap",			bench_heap,			0,		HEAP_SIZE,	HEAP_SIZE },
+	{ "pqueue",			bench_pqueue,		1,		100000000,	100000000 },
+	{ "hm_put",			bench_hm_put,		0,		100000000,	100000000 },
+	{ "hm_find",		bench_hm_find,		0,		100000000,	100000000 },
+	{ "hmap_put",		bench_hmap_put,		1,		100000000,	100000000 },
+	{ "hmap_find",		bench_hmap_find,	1,		100000000,	100000000 },
+	{ "sl_put",			bench_sl_put,		1,		10000000,	10000000 },
+	{ "sl_find",		bench_sl_find,		1,		10000000,	10000000 },
+	{ "scan_find",		bench_scan_find,	0,		100000000,	100000000 },
+	{ "scan_count",		bench_scan_count,	0,		100000000,	100000000 },
+	{ "scan_min_max",	bench_scan_min_max,	0,		100000000,	100000000 },
+	{ "scan_filter",	bench_scan_filter,	0,		100000000,	100000000 },
+	{ "soa_sort",		bench_soa_sort,		1,		100000000,	100000000 },
+	{ "soa_count",		bench_soa_count,	1,		100000000,	100000000 },
+};
+
+static const char *inputs[] = { "random", "sorted", "reversed", "duplicates", "sawtooth" };
+static const unsigned long sizes[] = { 4, 16, 64, 256 };
+static const unsigned long counts[] = { 1000, 10000, 100000, 1000000, 10000000, 100000000 };
+
+#define LENGTH(array) (sizeof(array) / sizeof((array)[0]))
+
+
+int main(int argc, char **argv) {
+	const char *only_bench = NULL;
+	const char *only_input = NULL;
+	unsigned long only_size = 0;
+	unsigned long only_n = 0;
+	unsigned long max_n = 1000000;
+	unsigned long max_bytes = 1UL << 30;
+	int first = 1;
+
+	for (int i = 1; i + 1 < argc; i += 2) {
+		if (strcmp(argv[i], "--bench") == 0) {
+			only_bench = argv[i+1];
+		}
+		else if (strcmp(argv[i], "--input") == 0) {
+			only_input = argv[i+1];
+		}
+		else if (strcmp(argv[i], "--size") == 0) {
+			only_size = strtoul(argv[i+1], NULL, 10);
+		}
+		else if (strcmp(argv[i], "--n") == 0) {
+			only_n = strtoul(argv[i+1], NULL, 10);
+		}
+		else if (strcmp(argv[i], "--max-n") == 0) {
+			max_n = strtoul(argv[i+1], NULL, 10);
+		}
+		else if (strcmp(argv[i], "--max-bytes") == 0) {
+			max_bytes = strtoul(argv[i+1], NULL, 10);
+		}
+		else {
+			fprintf(stderr, "unknown option %s\n", argv[i]);
+			return 1;
+		}
+	}
+
+	printf("{\n\t\"cycles\": %s,\n\t\"benchmarks\": [", HAS_CYCLES ? "\"tsc\"" : "null");
+	fprintf(stderr, "%-12s %-10s %5s %10s %12s %14s %12s\n",
+			"bench", "input", "size", "n", "ns/op", "ops/s", "cycles/op");
+
+	for (unsigned long b = 0; b < LENGTH(benches); b++) {
+		const Bench *bench = &benches[b];
+		if (only_bench && !strstr(bench->name, only_bench)) {
+			continue;
+		}
+		for (unsigned long in = 0; in < LENGTH(inputs); in++) {
+			const char *input = inputs[in];
+			int ordered = strcmp(input, "random") != 0 && strcmp(input, "duplicates") != 0;
+			if (only_input && strcmp(input, only_input) != 0) {
+				continue;
+			}
+			for (unsigned long s = 0; s < LENGTH(sizes); s++) {
+				unsigned long size = bench->sized ? sizes[s] : sizeof(long);
+				if (!bench->sized && s > 0) {
+					break;
+				}
+				if (only_size && bench->sized && size != only_size) {
+					continue;
+				}
+				for (unsigned long c = 0; c < LENGTH(counts); c++) {
+					unsigned long n = counts[c];
+					Workload w;
+					Measure m = { 0, 0, 0, 0, 0 };
+					int repetitions = 0;
+					if ((only_n && n != only_n) || n > max_n || n > bench->max_n ||
+							(ordered && n > bench->max_n_order) || n * size > max_bytes) {
+						continue;
+					}
+					if (!make_workload(&w, input, n, size)) {
+						fprintf(stderr, "could not allocate %lu records of %lu bytes\n", n, size);
+						continue;
+					}
+					while (m.ns < MIN_TIME_NS && repetitions < MAX_REPETITIONS) {
+						bench->function(&w, &m);
+						repetitions++;
+					}
+					free_workload(&w);
+
+					double ns_per_op = (double) m.ns / (double) m.ops;
+					double cycles_per_op = (double) m.cycles / (double) m.ops;
+					printf("%s\n\t\t{ \"bench\": \"%s\", \"input\": \"%s\", \"size\": %lu, \"n\": %lu, "
+							"\"repetitions\": %d, \"ops\": %lu, \"ns_per_op\": %.3f, \"ops_per_sec\": %.1f, "
+							"\"cycles_per_op\": %.3f }",
+							first ? "" : ",", bench->name, input, size, n,
+							repetitions, m.ops, ns_per_op, 1e9 / ns_per_op, cycles_per_op);
+					fprintf(stderr, "%-12s %-10s %5lu %10lu %12.3f %14.1f %12.3f\n",
+							bench->name, input, size, n, ns_per_op, 1e9 / ns_per_op, cycles_per_op);
+					fflush(stdout);
+					first = 0;
+				}
+			}
+		}
+	}
+	printf("\n\t]\n}\n");
+	return 0;
+}
@@ -3,25 +3,51 @@
 #include <stdlib.h>
 #include <string.h>
 
-static void swap(
+// allocations from an arena are aligned to this
+#define ARENA_ALIGN 16
+
+struct DSArenaBlock {
+	struct DSArenaBlock *next;
+	unsigned long size;
+	unsigned char *data;
+};
+
+// the data of a block starts after its header, aligned
+static unsigned long arena_header_size(void) {
+	return (sizeof(struct DSArenaBlock) + ARENA_ALIGN - 1) & ~(unsigned long) (ARENA_ALIGN - 1);
+}
+
+// stats of the functions that have no instance, per thread
+static _Thread_local DSStats *bound_stats = NULL;
+
+static void swap(unsigned char *array, unsigned long data_size, unsigned long a, unsigned long b);
+static void insertion_sort(
 		unsigned char *array,
-	   	unsigned long data_size,
+		unsigned long length,
+		unsigned long data_size,
 		unsigned char *tmp,
-	   	unsigned long a,
-	   	unsigned long b);
-
-static void swap(
+		DSCompare compare);
+static void heap_sort(unsigned char *array, unsigned long length, unsigned long data_size, DSCompare compare);
+static unsigned long partition(
 		unsigned char *array,
-	   	unsigned long data_size,
+		unsigned long length,
+		unsigned long data_size,
+		unsigned char *pivot,
+		DSCompare compare);
+static unsigned long depth_limit(unsigned long length);
+static void intro_sort(
+		unsigned char *array,
+		unsigned long length,
+		unsigned long data_size,
 		unsigned char *tmp,
-	   	unsigned long a,
-	   	unsigned long b)
-{
-	memcpy(tmp, array + a * data_size, data_size);
-	memcpy(array + a * data_size, array + b * data_size, data_size);
-	memcpy(array + b * data_size, tmp, data_size);
-}
+		unsigned long depth,
+		DSCompare compare);
 
+
+// Introsort: quicksort on Hoare's partition around the median of three
+// records. Short ranges are sorted by insertion, and ranges that took more
+// than depth_limit partitions, which happens only with adversarial inputs,
+// by heapsort.
 void ds_quick_sort(
 		unsigned char *array,
 	   	unsigned long length,
@@ -29,21 +55,534 @@ void ds_quick_sort(
 		unsigned char *tmp,
 	   	DSCompare compare)
 {
-	unsigned long p, i, j;
-	if (length <= 1) {
+	intro_sort(array, length, data_size, tmp, depth_limit(length), compare);
+}
+
+// Introselect: partitions only the side that holds the nth record.
+void ds_nth_element(
+		unsigned char *array,
+		unsigned long length,
+		unsigned long data_size,
+		unsigned char *tmp,
+		unsigned long nth,
+		DSCompare compare)
+{
+	unsigned long depth = depth_limit(length);
+	unsigned long split;
+	if (nth >= length) {
+		return;
+	}
+	while (length > DS_INSERTION_SORT_LENGTH) {
+		if (depth-- == 0) {
+			heap_sort(array, length, data_size, compare);
+			return;
+		}
+		split = partition(array, length, data_size, tmp, compare);
+		if (nth < split) {
+			length = split;
+		}
+		else {
+			array += split * data_size;
+			length -= split;
+			nth -= split;
+		}
+	}
+	insertion_sort(array, length, data_size, tmp, compare);
+}
+
+void ds_partial_sort(
+		unsigned char *array,
+		unsigned long length,
+		unsigned long data_size,
+		unsigned char *tmp,
+		unsigned long k,
+		DSCompare compare)
+{
+	if (k >= length) {
+		ds_quick_sort(array, length, data_size, tmp, compare);
+		return;
+	}
+	if (k == 0) {
 		return;
 	}
-	p = length / 2;
-	j = 1;
-	swap(array, data_size, tmp, 0, p);
-	for (i = 1; i < length; i++) {
-		if (compare(array + i * data_size, array) <= 0) {
-			swap(array, data_size, tmp, i, j);
-			j++;
+	ds_nth_element(array, length, data_size, tmp, k - 1, compare);
+	ds_quick_sort(array, k - 1, data_size, tmp, compare);
+}
+
+// swaps in chunks through the stack, so that tmp can hold the pivot
+static void swap(unsigned char *array, unsigned long data_size, unsigned long a, unsigned long b) {
+	unsigned char chunk[64];
+	unsigned char *x = array + a * data_size;
+	unsigned char *y = array + b * data_size;
+	for (unsigned long done = 0; done < data_size; done += sizeof(chunk)) {
+		unsigned long size = data_size - done < sizeof(chunk) ? data_size - done : sizeof(chunk);
+		memcpy(chunk, x + done, size);
+		memcpy(x + done, y + done, size);
+		memcpy(y + done, chunk, size);
+	}
+	DS_STAT(bound_stats, bytes_moved, 3 * data_size);
+}
+
+static void insertion_sort(
+		unsigned char *array,
+		unsigned long length,
+		unsigned long data_size,
+		unsigned char *tmp,
+		DSCompare compare)
+{
+	for (unsigned long i = 1; i < length; i++) {
+		unsigned long j = i;
+		DS_STAT(bound_stats, compares, 1);
+		if (compare(array + (i-1) * data_size, array + i * data_size) <= 0) {
+			continue;
+		}
+		memcpy(tmp, array + i * data_size, data_size);
+		do {
+			j--;
+			DS_STAT(bound_stats, compares, 1);
+		} while (j > 0 && compare(array + (j-1) * data_size, tmp) > 0);
+		memmove(array + (j+1) * data_size, array + j * data_size, (i - j) * data_size);
+		memcpy(array + j * data_size, tmp, data_size);
+		DS_STAT(bound_stats, bytes_moved, (i - j + 2) * data_size);
+	}
+}
+
+static void heap_sort(unsigned char *array, unsigned long length, unsigned long data_size, DSCompare compare) {
+	for (unsigned long end = length, start = length / 2; end > 1; ) {
+		unsigned long parent, child;
+		if (start > 0) {
+			start--;
+		}
+		else {
+			end--;
+			swap(array, data_size, 0, end);
+		}
+		for (parent = start; (child = 2 * parent + 1) < end; parent = child) {
+			if (child + 1 < end && compare(array + child * data_size, array + (child+1) * data_size) < 0) {
+				child++;
+			}
+			DS_STAT(bound_stats, compares, 2);
+			if (compare(array + parent * data_size, array + child * data_size) >= 0) {
+				break;
+			}
+			swap(array, data_size, parent, child);
+		}
+	}
+}
+
+// Hoare's partition around the median of the first, middle and last
+// records, copied to pivot. Returns split, with the records before it not
+// greater than the pivot and the ones from it on not less. The scans stop
+// on records equal to the pivot, so that they are spread over both sides,
+// and the median keeps both sides from being empty.
+static unsigned long partition(
+		unsigned char *array,
+		unsigned long length,
+		unsigned long data_size,
+		unsigned char *pivot,
+		DSCompare compare)
+{
+	unsigned char *a = array;
+	unsigned char *b = array + length / 2 * data_size;
+	unsigned char *c = array + (length - 1) * data_size;
+	unsigned char *median;
+	unsigned long i = 0, j = length - 1;
+	if (compare(a, b) < 0) {
+		median = compare(b, c) < 0 ? b : compare(a, c) < 0 ? c : a;
+	}
+	else {
+		median = compare(a, c) < 0 ? a : compare(b, c) < 0 ? c : b;
+	}
+	memcpy(pivot, median, data_size);
+	DS_STAT(bound_stats, compares, 3);
+	for (;;) {
+		while (compare(array + i * data_size, pivot) < 0) {
+			i++;
+			DS_STAT(bound_stats, compares, 1);
+		}
+		while (compare(array + j * data_size, pivot) > 0) {
+			j--;
+			DS_STAT(bound_stats, compares, 1);
+		}
+		DS_STAT(bound_stats, compares, 2);
+		if (i >= j) {
+			return j + 1;
+		}
+		swap(array, data_size, i, j);
+		i++;
+		j--;
+	}
+}
+
+// Recurses into the shorter side and loops on the longer one, both with
+// the partitions left of depth, so that the whole sort takes at most
+// depth_limit levels before it turns to heapsort.
+static void intro_sort(
+		unsigned char *array,
+		unsigned long length,
+		unsigned long data_size,
+		unsigned char *tmp,
+		unsigned long depth,
+		DSCompare compare)
+{
+	unsigned long split;
+	while (length > DS_INSERTION_SORT_LENGTH) {
+		if (depth-- == 0) {
+			heap_sort(array, length, data_size, compare);
+			return;
+		}
+		split = partition(array, length, data_size, tmp, compare);
+		if (split < length - split) {
+			intro_sort(array, split, data_size, tmp, depth, compare);
+			array += split * data_size;
+			length -= split;
+		}
+		else {
+			intro_sort(array + split * data_size, length - split, data_size, tmp, depth, compare);
+			length = split;
 		}
 	}
-	swap(array, data_size, tmp, 0, j-1);
-	ds_quick_sort(array,					  j-1,			data_size, tmp, compare);
-	ds_quick_sort(array + (j-1) * data_size, length - j+1, data_size, tmp, compare);
+	insertion_sort(array, length, data_size, tmp, compare);
 }
 
+// twice the number of bits of length
+static unsigned long depth_limit(unsigned long length) {
+	unsigned long depth = 0;
+	for (; length > 1; length >>= 1) {
+		depth += 2;
+	}
+	return depth;
+}
+
+
+// finalizer of MurmurHash3, spreads every bit of the input over the output
+unsigned long ds_hash_ulong(unsigned long n) {
+	unsigned long long h = n;
+	h ^= h >> 33;
+	h *= 0xff51afd7ed558ccdULL;
+	h ^= h >> 33;
+	h *= 0xc4ceb9fe1a85ec53ULL;
+	h ^= h >> 33;
+	return (unsigned long) h;
+}
+
+// reads eight bytes at a time, mixing each word into the hash
+unsigned long ds_hash_bytes(const void *data, unsigned long size) {
+	const unsigned char *bytes = data;
+	unsigned long long h = 0x9e3779b97f4a7c15ULL ^ size;
+	unsigned long long word;
+	for (; size >= 8; size -= 8, bytes += 8) {
+		memcpy(&word, bytes, 8);
+		h = (h ^ ds_hash_ulong(word)) * 0x9e3779b97f4a7c15ULL;
+	}
+	if (size > 0) {
+		word = 0;
+		memcpy(&word, bytes, size);
+		h = (h ^ ds_hash_ulong(word)) * 0x9e3779b97f4a7c15ULL;
+	}
+	return ds_hash_ulong(h);
+}
+
+
+static void *malloc_alloc(void *context, unsigned long size) {
+	(void) context;
+	return malloc(size);
+}
+
+static void *malloc_realloc(void *context, void *ptr, unsigned long old_size, unsigned long size) {
+	(void) context;
+	(void) old_size;
+	return realloc(ptr, size);
+}
+
+static void malloc_free(void *context, void *ptr, unsigned long size) {
+	(void) context;
+	(void) size;
+	free(ptr);
+}
+
+const DSAllocator ds_malloc_allocator = { malloc_alloc, malloc_realloc, malloc_free, NULL };
+
+void *ds_alloc_with(const DSAllocator *allocator, unsigned long size) {
+	return allocator ? allocator->alloc(allocator->context, size) : malloc(size);
+}
+
+void *ds_realloc_with(const DSAllocator *allocator, void *ptr, unsigned long old_size, unsigned long size) {
+	return allocator ? allocator->realloc(allocator->context, ptr, old_size, size) : realloc(ptr, size);
+}
+
+void ds_free_with(const DSAllocator *allocator, void *ptr, unsigned long size) {
+	if (!allocator) {
+		free(ptr);
+	}
+	else if (allocator->free) {
+		allocator->free(allocator->context, ptr, size);
+	}
+}
+
+
+static void *arena_alloc(void *context, unsigned long size) {
+	return ds_arena_alloc(context, size);
+}
+
+// the memory is not given back, so it is only worth it to grow in place
+// when the block was the last one allocated
+static void *arena_realloc(void *context, void *ptr, unsigned long old_size, unsigned long size) {
+	DSArena *arena = context;
+	unsigned long old_aligned = (old_size + ARENA_ALIGN - 1) & ~(unsigned long) (ARENA_ALIGN - 1);
+	unsigned long aligned = (size + ARENA_ALIGN - 1) & ~(unsigned long) (ARENA_ALIGN - 1);
+	void *new_ptr;
+	if (ptr && (unsigned char *) ptr + old_aligned == arena->ptr && aligned >= old_aligned &&
+			aligned - old_aligned <= (unsigned long) (arena->end - arena->ptr)) {
+		arena->ptr += aligned - old_aligned;
+		return ptr;
+	}
+	new_ptr = ds_arena_alloc(arena, size);
+	if (new_ptr && ptr) {
+		memcpy(new_ptr, ptr, old_size < size ? old_size : size);
+	}
+	return new_ptr;
+}
+
+DSArena *ds_arena_new(unsigned long block_size) {
+	return ds_arena_new_with(NULL, block_size);
+}
+
+DSArena *ds_arena_new_with(const DSAllocator *parent, unsigned long block_size) {
+	DSArena *arena = ds_alloc_with(parent, sizeof(DSArena));
+	if (!arena) {
+		return NULL;
+	}
+	arena->blocks = NULL;
+	arena->current = NULL;
+	arena->ptr = NULL;
+	arena->end = NULL;
+	arena->block_size = block_size;
+	arena->parent = parent;
+	arena->allocator.alloc = arena_alloc;
+	arena->allocator.realloc = arena_realloc;
+	arena->allocator.free = NULL;
+	arena->allocator.context = arena;
+	return arena;
+}
+
+const DSAllocator *ds_arena_allocator(DSArena *arena) {
+	return arena ? &arena->allocator : NULL;
+}
+
+void ds_arena_delete(DSArena *arena) {
+	if (arena) {
+		struct DSArenaBlock *next;
+		for (struct DSArenaBlock *block = arena->blocks; block != NULL; block = next) {
+			next = block->next;
+			ds_free_with(arena->parent, block, arena_header_size() + block->size);
+		}
+		ds_free_with(arena->parent, arena, sizeof(DSArena));
+	}
+}
+
+void *ds_arena_alloc(DSArena *arena, unsigned long size) {
+	void *ptr;
+	size = (size + ARENA_ALIGN - 1) & ~(unsigned long) (ARENA_ALIGN - 1);
+	if (size > (unsigned long) (arena->end - arena->ptr)) {
+		// the next block big enough, kept from before a reset, or a new one
+		struct DSArenaBlock *block = arena->current ? arena->current->next : arena->blocks;
+		while (block && block->size < size) {
+			block = block->next;
+		}
+		if (!block) {
+			unsigned long block_size = size > arena->block_size ? size : arena->block_size;
+			unsigned long header = arena_header_size();
+			block = ds_alloc_with(arena->parent, header + block_size);
+			if (!block) {
+				return NULL;
+			}
+			block->size = block_size;
+			block->data = (unsigned char *) block + header;
+			if (arena->current) {
+				block->next = arena->current->next;
+				arena->current->next = block;
+			}
+			else {
+				block->next = arena->blocks;
+				arena->blocks = block;
+			}
+		}
+		arena->current = block;
+		arena->ptr = block->data;
+		arena->end = block->data + block->size;
+	}
+	ptr = arena->ptr;
+	arena->ptr += size;
+	return ptr;
+}
+
+void ds_arena_reset(DSArena *arena) {
+	arena->current = NULL;
+	arena->ptr = NULL;
+	arena->end = NULL;
+}
+
+void *ds_alloc_in(DSArena *arena, unsigned long size) {
+	return arena ? ds_arena_alloc(arena, size) : malloc(size);
+}
+
+void ds_free_in(DSArena *arena, void *ptr) {
+	if (!arena) {
+		free(ptr);
+	}
+}
+
+
+// whether source a wins over source b: exhausted sources lose, and ties go
+// to the lower index
+static int beats(DSLoserTree *tree, unsigned long a, unsigned long b) {
+	int order;
+	if (!tree->heads[b]) {
+		return 1;
+	}
+	if (!tree->heads[a]) {
+		return 0;
+	}
+	order = tree->compare(tree->heads[a], tree->heads[b]);
+	DS_STAT(bound_stats, compares, 1);
+	return order < 0 || (order == 0 && a < b);
+}
+
+DSLoserTree *ds_loser_tree_new(unsigned long k, DSCompare compare) {
+	return ds_loser_tree_new_with(NULL, k, compare);
+}
+
+// The nodes are laid out as a heap, with the children of n at 2n and 2n+1
+// and source i as the leaf k+i. The 2k entries after the losers hold the
+// winner of each node while the tree is built.
+DSLoserTree *ds_loser_tree_new_with(const DSAllocator *allocator, unsigned long k, DSCompare compare) {
+	DSLoserTree *tree;
+	if (k == 0) {
+		return NULL;
+	}
+	tree = ds_alloc_with(allocator, sizeof(DSLoserTree));
+	if (!tree) {
+		return NULL;
+	}
+	tree->nodes = ds_alloc_with(allocator, 3 * k * sizeof(unsigned long));
+	tree->heads = ds_alloc_with(allocator, k * sizeof(const void *));
+	tree->k = k;
+	tree->compare = compare;
+	tree->allocator = allocator;
+	if (!tree->nodes || !tree->heads) {
+		ds_loser_tree_delete(tree);
+		return NULL;
+	}
+	for (unsigned long i = 0; i < k; i++) {
+		tree->heads[i] = NULL;
+		tree->nodes[i] = i;
+	}
+	return tree;
+}
+
+void ds_loser_tree_delete(DSLoserTree *tree) {
+	if (tree) {
+		if (tree->nodes) {
+			ds_free_with(tree->allocator, tree->nodes, 3 * tree->k * sizeof(unsigned long));
+		}
+		if (tree->heads) {
+			ds_free_with(tree->allocator, tree->heads, tree->k * sizeof(const void *));
+		}
+		ds_free_with(tree->allocator, tree, sizeof(DSLoserTree));
+	}
+}
+
+void ds_loser_tree_init(DSLoserTree *tree, const void **heads) {
+	unsigned long k = tree->k;
+	unsigned long *winners = tree->nodes + k;
+	memcpy(tree->heads, heads, k * sizeof(const void *));
+	for (unsigned long i = 0; i < k; i++) {
+		winners[k + i] = i;
+	}
+	for (unsigned long n = k - 1; n > 0; n--) {
+		unsigned long a = winners[2 * n];
+		unsigned long b = winners[2 * n + 1];
+		if (beats(tree, a, b)) {
+			tree->nodes[n] = b;
+			winners[n] = a;
+		}
+		else {
+			tree->nodes[n] = a;
+			winners[n] = b;
+		}
+	}
+	tree->nodes[0] = k > 1 ? winners[1] : 0;
+}
+
+unsigned long ds_loser_tree_winner(DSLoserTree *tree) {
+	unsigned long winner = tree->nodes[0];
+	return tree->heads[winner] ? winner : tree->k;
+}
+
+const void *ds_loser_tree_head(DSLoserTree *tree) {
+	return tree->heads[tree->nodes[0]];
+}
+
+void ds_loser_tree_replace(DSLoserTree *tree, const void *head) {
+	unsigned long winner = tree->nodes[0];
+	tree->heads[winner] = head;
+	for (unsigned long n = (tree->k + winner) / 2; n > 0; n /= 2) {
+		if (beats(tree, tree->nodes[n], winner)) {
+			unsigned long loser = winner;
+			winner = tree->nodes[n];
+			tree->nodes[n] = loser;
+		}
+	}
+	tree->nodes[0] = winner;
+}
+
+DSStats *ds_stats_bind(DSStats *stats) {
+	DSStats *previous = bound_stats;
+	bound_stats = stats;
+	return previous;
+}
+
+DSStats *ds_stats_bound(void) {
+	return bound_stats;
+}
+
+void ds_stats_reset(DSStats *stats) {
+	memset(stats, 0, sizeof(DSStats));
+}
+
+void ds_stats_merge(DSStats *dst, const DSStats *src) {
+	dst->ops += src->ops;
+	dst->compares += src->compares;
+	dst->bytes_moved += src->bytes_moved;
+	dst->allocations += src->allocations;
+	dst->frees += src->frees;
+	if (src->max_cost > dst->max_cost) {
+		dst->max_cost = src->max_cost;
+	}
+	for (int i = 0; i < DS_STATS_BUCKETS; i++) {
+		dst->histogram[i] += src->histogram[i];
+	}
+}
+
+void ds_stats_cost(DSStats *stats, unsigned long cost) {
+	int bucket = 0;
+	for (unsigned long c = cost; c > 0 && bucket < DS_STATS_BUCKETS - 1; c >>= 1) {
+		bucket++;
+	}
+	stats->histogram[bucket]++;
+	if (cost > stats->max_cost) {
+		stats->max_cost = cost;
+	}
+}
+
+void ds_stats_dump(FILE *out, const char *name, const DSStats *stats) {
+	fprintf(out, "{ \"name\": \"%s\", \"ops\": %lu, \"compares\": %lu, \"bytes_moved\": %lu, "
+			"\"allocations\": %lu, \"frees\": %lu, \"max_cost\": %lu, \"histogram\": [",
+			name, stats->ops, stats->compares, stats->bytes_moved,
+			stats->allocations, stats->frees, stats->max_cost);
+	for (int i = 0; i < DS_STATS_BUCKETS; i++) {
+		fprintf(out, i ? ", %lu" : "%lu", stats->histogram[i]);
+	}
+	fprintf(out, "] }");
+}
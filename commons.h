@@ -2,15 +2,219 @@
 #ifndef __COMMONS_H__
 #define __COMMONS_H__
 
+#include <stddef.h>
+#include <stdio.h>
+
+// pointer to the struct of type Type that has ptr at its member member
+#define ds_container_of(ptr, Type, member) \
+	((Type *) ((char *) (ptr) - offsetof(Type, member)))
+
 // return <0 if a<b; 0 if a==b; >0 if a>b
 typedef int (*DSCompare) (const void *a, const void *b);
 
+// return the hash of the data pointed to
+typedef unsigned long (*DSHash) (const void *data);
+
+// return non zero if the data pointed to is to be selected
+typedef int (*DSPredicate) (const void *data, void *context);
+
+// return the sort key of the data pointed to
+typedef long (*DSKey) (const void *data);
+
+// An AVL tree of n nodes is less than 1.44 log2(n + 2) high, 93 for any
+// n that fits in an unsigned long. The AVL trees of ptree.h and itree.h
+// keep the paths they walk in arrays of this many nodes.
+#define DS_AVL_MAX_HEIGHT 96
+
+// Sort and selection of an array of length records of data_size bytes,
+// using tmp, room for one record, as scratch. ds_quick_sort sorts the
+// array, in O(n log n) at worst. ds_nth_element moves to index nth the
+// record that would be there if the array were sorted, with no greater
+// record before it and no lesser one after, in O(n) on average.
+// ds_partial_sort sorts the least k records to the start of the array, in
+// O(n + k log k), and leaves the others in no order. None are stable.
+#ifndef DS_INSERTION_SORT_LENGTH
+#define DS_INSERTION_SORT_LENGTH 16
+#endif
+
 void ds_quick_sort(
 		unsigned char *array,
 	   	unsigned long length,
 	   	unsigned long data_size,
 		unsigned char *tmp,
 		DSCompare compare);
+void ds_nth_element(
+		unsigned char *array,
+		unsigned long length,
+		unsigned long data_size,
+		unsigned char *tmp,
+		unsigned long nth,
+		DSCompare compare);
+void ds_partial_sort(
+		unsigned char *array,
+		unsigned long length,
+		unsigned long data_size,
+		unsigned char *tmp,
+		unsigned long k,
+		DSCompare compare);
+
+unsigned long ds_hash_bytes(const void *data, unsigned long size);
+unsigned long ds_hash_ulong(unsigned long n);
+
+
+/*
+ * Allocator
+ * Table of the functions a container uses to get and release memory, so
+ * that it can be routed to another heap, to NUMA-local memory or through
+ * a tracking allocator. The context is passed as first argument to each
+ * function. Sizes are given back to realloc and free, so that allocators
+ * can account for the memory without headers; realloc is given the old
+ * size too. A NULL free function means the memory is released all at
+ * once by other means, as in arenas, and containers skip freeing it piece
+ * by piece.
+ *
+ * Constructors with the suffix _with take an allocator, which must outlive
+ * the container. A NULL allocator means malloc, realloc and free, which is
+ * also what ds_malloc_allocator does.
+ *
+ * ds_alloc_with, ds_realloc_with and ds_free_with call an allocator, or
+ * the standard functions if the allocator is NULL.
+ */
+typedef struct DSAllocator {
+	void *(*alloc) (void *context, unsigned long size);
+	void *(*realloc) (void *context, void *ptr, unsigned long old_size, unsigned long size);
+	void (*free) (void *context, void *ptr, unsigned long size);
+	void *context;
+} DSAllocator;
+
+extern const DSAllocator ds_malloc_allocator;
+
+void *ds_alloc_with(const DSAllocator *allocator, unsigned long size);
+void *ds_realloc_with(const DSAllocator *allocator, void *ptr, unsigned long old_size, unsigned long size);
+void ds_free_with(const DSAllocator *allocator, void *ptr, unsigned long size);
+
+
+/*
+ * Arena
+ * Region allocator: memory is taken from big blocks by bumping a pointer,
+ * and it is not freed piece by piece. Resetting the arena releases all
+ * that was allocated from it at once, keeping the blocks for reuse, and
+ * deleting it returns the blocks to the system.
+ *
+ * Containers created or grown with an arena (alist_new_in, bt_insert_in,
+ * ll_<type>_push_in, ...) take their memory from it and never free it,
+ * so deleting them costs nothing. They must not be used after the arena
+ * is reset.
+ *
+ * ds_alloc_in and ds_free_in allocate from the arena, or with malloc and
+ * free if the arena is NULL.
+ *
+ * The arena is also an allocator, returned by ds_arena_allocator, to be
+ * given to the _with constructors. ds_arena_new_with takes the blocks of
+ * the arena from another allocator.
+ */
+struct DSArenaBlock;
+
+typedef struct DSArena {
+	struct DSArenaBlock *blocks;
+	struct DSArenaBlock *current;
+	unsigned char *ptr;
+	unsigned char *end;
+	unsigned long block_size;
+	const DSAllocator *parent;
+	DSAllocator allocator;
+} DSArena;
+
+DSArena *ds_arena_new(unsigned long block_size);
+DSArena *ds_arena_new_with(const DSAllocator *parent, unsigned long block_size);
+const DSAllocator *ds_arena_allocator(DSArena *arena);
+void ds_arena_delete(DSArena *arena);
+void *ds_arena_alloc(DSArena *arena, unsigned long size);
+void ds_arena_reset(DSArena *arena);
+
+void *ds_alloc_in(DSArena *arena, unsigned long size);
+void ds_free_in(DSArena *arena, void *ptr);
+
+
+/*
+ * Loser Tree
+ * Tournament tree that merges k sorted sources, finding the least of their
+ * heads in log2(k) compares, one per level, as each node keeps the loser
+ * of the match played there and the winner goes on up.
+ *
+ * The heads are pointers to the current record of each source, NULL for a
+ * source that is exhausted. ds_loser_tree_init plays all the matches for
+ * an array of k heads. ds_loser_tree_winner returns the index of the
+ * source whose head is the least, the lowest one among equal heads, so
+ * merges are stable, or k if all are exhausted. ds_loser_tree_replace
+ * gives the winner its next head, or NULL, and replays only its path.
+ */
+typedef struct DSLoserTree {
+	unsigned long *nodes;        // the winner at 0, the losers at 1 to k-1
+	const void **heads;
+	unsigned long k;
+	DSCompare compare;
+	const DSAllocator *allocator;
+} DSLoserTree;
+
+DSLoserTree *ds_loser_tree_new(unsigned long k, DSCompare compare);
+DSLoserTree *ds_loser_tree_new_with(const DSAllocator *allocator, unsigned long k, DSCompare compare);
+void ds_loser_tree_delete(DSLoserTree *tree);
+void ds_loser_tree_init(DSLoserTree *tree, const void **heads);
+unsigned long ds_loser_tree_winner(DSLoserTree *tree);
+const void *ds_loser_tree_head(DSLoserTree *tree);
+void ds_loser_tree_replace(DSLoserTree *tree, const void *head);
+
+
+/*
+ * Statistics
+ * Counters of what the containers do, compiled in only when DS_STATS is
+ * defined, for the library and for the code that uses it alike. Otherwise
+ * the containers have no stats member and record nothing.
+ *
+ * AList, LLHandle and HMap keep their own stats, returned by alist_stats,
+ * llh_<type>_stats and hmap_stats, or NULL when DS_STATS is not defined.
+ * The functions that have no instance to keep them, as ds_quick_sort and
+ * those of BTree and of the bare linked list nodes, record into the stats
+ * bound to the thread with ds_stats_bind, if any.
+ *
+ * Besides the counters, each operation that walks or shifts elements adds
+ * its cost, the depth reached or the number of elements shifted or probed,
+ * to a histogram of powers of two: bucket 0 counts costs of 0, bucket i
+ * costs from 2^(i-1) to 2^i - 1, and the last bucket the rest.
+ *
+ * ds_stats_dump writes stats as a JSON object.
+ */
+#define DS_STATS_BUCKETS 16
+
+typedef struct DSStats {
+	unsigned long ops;
+	unsigned long compares;
+	unsigned long bytes_moved;
+	unsigned long allocations;
+	unsigned long frees;
+	unsigned long max_cost;
+	unsigned long histogram[DS_STATS_BUCKETS];
+} DSStats;
+
+DSStats *ds_stats_bind(DSStats *stats);
+DSStats *ds_stats_bound(void);
+void ds_stats_reset(DSStats *stats);
+void ds_stats_merge(DSStats *dst, const DSStats *src);
+void ds_stats_cost(DSStats *stats, unsigned long cost);
+void ds_stats_dump(FILE *out, const char *name, const DSStats *stats);
+
+#ifdef DS_STATS
+#define DS_STATS_MEMBER DSStats stats;
+#define DS_STATS_OF(container) ((const DSStats *) &(container)->stats)
+#define DS_STAT(stats, field, n) do { DSStats *_s = (stats); if (_s) { _s->field += (n); } } while (0)
+#define DS_STAT_COST(stats, cost) do { DSStats *_s = (stats); if (_s) { ds_stats_cost(_s, (cost)); } } while (0)
+#else
+#define DS_STATS_MEMBER
+#define DS_STATS_OF(container) ((void) (container), (const DSStats *) NULL)
+#define DS_STAT(stats, field, n) ((void) 0)
+#define DS_STAT_COST(stats, cost) ((void) 0)
+#endif
 
 
 #endif  // __COMMONS_H__
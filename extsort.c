@@ -0,0 +1,336 @@
+#include "extsort.h"
+#include <stdlib.h>
+#include <string.h>
+
+typedef struct Sorter {
+	const DSAllocator *allocator;
+	unsigned long data_size;
+	unsigned long memory;
+	DSCompare compare;
+	FILE **runs;
+	unsigned long run_count;
+	unsigned long run_capacity;
+} Sorter;
+
+// where the sorted records go: a file, through a buffer, or a list
+typedef struct Sink {
+	FILE *file;
+	AList *list;
+	unsigned char *buffer;
+	unsigned long capacity;  // in records
+	unsigned long length;
+} Sink;
+
+// a run being merged, read a buffer at a time
+typedef struct Run {
+	FILE *file;
+	unsigned char *buffer;
+	unsigned long capacity;  // in records
+	unsigned long length;
+	unsigned long next;
+	int error;
+} Run;
+
+static int sort(Sorter *sorter, FILE *in, Sink *sink);
+static int make_runs(Sorter *sorter, FILE *in, Sink *sink, int *out_done);
+static int at_end(FILE *in);
+static int add_run(Sorter *sorter, FILE *file);
+static int merge_pass(Sorter *sorter, unsigned long fan_in);
+static int merge(Sorter *sorter, FILE **files, unsigned long k, FILE *out, AList *list);
+static const void *next_record(Run *run, unsigned long data_size);
+static int put(Sink *sink, const void *records, unsigned long count, unsigned long data_size);
+static int flush(Sink *sink, unsigned long data_size);
+static void close_runs(Sorter *sorter);
+
+
+int ds_external_sort(FILE *in, FILE *out, unsigned long data_size, unsigned long memory, DSCompare compare) {
+	return ds_external_sort_with(NULL, in, out, data_size, memory, compare);
+}
+
+int ds_external_sort_with(
+		const DSAllocator *allocator,
+		FILE *in,
+		FILE *out,
+		unsigned long data_size,
+		unsigned long memory,
+		DSCompare compare)
+{
+	Sorter sorter = { allocator, data_size, memory, compare, NULL, 0, 0 };
+	Sink sink = { out, NULL, NULL, 0, 0 };
+	return sort(&sorter, in, &sink);
+}
+
+int ds_external_sort_alist(FILE *in, AList *dst, unsigned long memory, DSCompare compare) {
+	return ds_external_sort_alist_with(NULL, in, dst, memory, compare);
+}
+
+int ds_external_sort_alist_with(
+		const DSAllocator *allocator,
+		FILE *in,
+		AList *dst,
+		unsigned long memory,
+		DSCompare compare)
+{
+	Sorter sorter = { allocator, dst->data_size, memory, compare, NULL, 0, 0 };
+	Sink sink = { NULL, dst, NULL, 0, 0 };
+	return sort(&sorter, in, &sink);
+}
+
+
+static int sort(Sorter *sorter, FILE *in, Sink *sink) {
+	unsigned long block = sorter->data_size > DS_EXTSORT_MIN_BLOCK ? sorter->data_size : DS_EXTSORT_MIN_BLOCK;
+	unsigned long fan_in = sorter->memory / block > 3 ? sorter->memory / block - 1 : 2;
+	int done = 0;
+	int rval;
+	if (sorter->data_size == 0 || sorter->memory / sorter->data_size < 4) {
+		return DS_OUT_OF_BOUNDS;
+	}
+	rval = make_runs(sorter, in, sink, &done);
+	while (rval == DS_OK && !done && sorter->run_count > fan_in) {
+		rval = merge_pass(sorter, fan_in);
+	}
+	if (rval == DS_OK && !done) {
+		rval = merge(sorter, sorter->runs, sorter->run_count, sink->file, sink->list);
+	}
+	close_runs(sorter);
+	return rval;
+}
+
+// Sorts the input memory at a time into runs. If all of it fits at once,
+// it goes to the sink instead, and out_done is set.
+static int make_runs(Sorter *sorter, FILE *in, Sink *sink, int *out_done) {
+	unsigned long data_size = sorter->data_size;
+	unsigned long chunk_length = sorter->memory / data_size - 1;  // and the temporary record
+	unsigned char *chunk = ds_alloc_with(sorter->allocator, (chunk_length + 1) * data_size);
+	int rval = DS_OK;
+	if (!chunk) {
+		return DS_MALLOC_ERROR;
+	}
+	while (rval == DS_OK) {
+		unsigned long bytes = fread(chunk, 1, chunk_length * data_size, in);
+		unsigned long length = bytes / data_size;
+		FILE *file;
+		if (ferror(in) || bytes % data_size != 0) {
+			rval = DS_IO_ERROR;
+			break;
+		}
+		if (length == 0) {
+			break;
+		}
+		ds_quick_sort(chunk, length, data_size, chunk + chunk_length * data_size, sorter->compare);
+		if (sorter->run_count == 0 && (length < chunk_length || at_end(in))) {
+			rval = put(sink, chunk, length, data_size);
+			*out_done = 1;
+			break;
+		}
+		file = tmpfile();
+		if (!file) {
+			rval = DS_IO_ERROR;
+			break;
+		}
+		setvbuf(file, NULL, _IONBF, 0);
+		rval = add_run(sorter, file);
+		if (rval == DS_OK && fwrite(chunk, data_size, length, file) != length) {
+			rval = DS_IO_ERROR;
+		}
+	}
+	if (rval == DS_OK && sorter->run_count == 0) {
+		*out_done = 1;
+	}
+	ds_free_with(sorter->allocator, chunk, (chunk_length + 1) * data_size);
+	return rval;
+}
+
+// whether in has no more to read, taking nothing from it
+static int at_end(FILE *in) {
+	int c = getc(in);
+	if (c == EOF) {
+		return !ferror(in);
+	}
+	ungetc(c, in);
+	return 0;
+}
+
+static int add_run(Sorter *sorter, FILE *file) {
+	if (sorter->run_count == sorter->run_capacity) {
+		unsigned long capacity = sorter->run_capacity ? 2 * sorter->run_capacity : 16;
+		FILE **runs = ds_realloc_with(
+				sorter->allocator,
+				sorter->runs,
+				sorter->run_capacity * sizeof(FILE *),
+				capacity * sizeof(FILE *));
+		if (!runs) {
+			fclose(file);
+			return DS_MALLOC_ERROR;
+		}
+		sorter->runs = runs;
+		sorter->run_capacity = capacity;
+	}
+	sorter->runs[sorter->run_count++] = file;
+	return DS_OK;
+}
+
+// Merges the runs fan_in at a time into new runs, in the place of the old.
+// The slots of the runs merged are cleared, so that on an error close_runs
+// closes each file once.
+static int merge_pass(Sorter *sorter, unsigned long fan_in) {
+	unsigned long count = 0;
+	for (unsigned long i = 0; i < sorter->run_count; i += fan_in) {
+		unsigned long k = sorter->run_count - i < fan_in ? sorter->run_count - i : fan_in;
+		FILE *file;
+		int rval;
+		if (k == 1) {
+			FILE *last = sorter->runs[i];
+			sorter->runs[i] = NULL;
+			sorter->runs[count++] = last;
+			continue;
+		}
+		file = tmpfile();
+		if (!file) {
+			return DS_IO_ERROR;
+		}
+		setvbuf(file, NULL, _IONBF, 0);
+		rval = merge(sorter, sorter->runs + i, k, file, NULL);
+		for (unsigned long j = i; j < i + k; j++) {
+			fclose(sorter->runs[j]);
+			sorter->runs[j] = NULL;
+		}
+		sorter->runs[count++] = file;
+		if (rval != DS_OK) {
+			return rval;
+		}
+	}
+	sorter->run_count = count;
+	return DS_OK;
+}
+
+// Merges k runs into out, or into list, splitting memory in k + 1 buffers.
+static int merge(Sorter *sorter, FILE **files, unsigned long k, FILE *out, AList *list) {
+	unsigned long data_size = sorter->data_size;
+	unsigned long capacity = sorter->memory / (k + 1) / data_size;
+	unsigned long buffer_size = (capacity ? capacity : 1) * data_size;
+	Run *runs = ds_alloc_with(sorter->allocator, k * sizeof(Run));
+	const void **heads = ds_alloc_with(sorter->allocator, k * sizeof(const void *));
+	DSLoserTree *tree = ds_loser_tree_new_with(sorter->allocator, k, sorter->compare);
+	Sink sink = { out, list, NULL, capacity ? capacity : 1, 0 };
+	unsigned long ready = 0;
+	int rval = DS_OK;
+	if (runs) {
+		for (; ready < k; ready++) {
+			runs[ready] = (Run) { files[ready], NULL, capacity ? capacity : 1, 0, 0, 0 };
+			runs[ready].buffer = ds_alloc_with(sorter->allocator, buffer_size);
+			if (!runs[ready].buffer) {
+				break;
+			}
+		}
+	}
+	if (out) {
+		sink.buffer = ds_alloc_with(sorter->allocator, buffer_size);
+	}
+	if (!runs || ready < k || !heads || !tree || (out && !sink.buffer)) {
+		rval = DS_MALLOC_ERROR;
+	}
+	for (unsigned long i = 0; rval == DS_OK && i < k; i++) {
+		rewind(runs[i].file);
+		heads[i] = next_record(&runs[i], data_size);
+	}
+	if (rval == DS_OK) {
+		ds_loser_tree_init(tree, heads);
+	}
+	while (rval == DS_OK) {
+		unsigned long winner = ds_loser_tree_winner(tree);
+		if (winner == k) {
+			break;
+		}
+		rval = put(&sink, ds_loser_tree_head(tree), 1, data_size);
+		ds_loser_tree_replace(tree, next_record(&runs[winner], data_size));
+	}
+	for (unsigned long i = 0; rval == DS_OK && i < k; i++) {
+		if (runs[i].error) {
+			rval = DS_IO_ERROR;
+		}
+	}
+	if (rval == DS_OK) {
+		rval = flush(&sink, data_size);
+	}
+
+	if (sink.buffer) {
+		ds_free_with(sorter->allocator, sink.buffer, buffer_size);
+	}
+	for (unsigned long i = 0; i < ready; i++) {
+		ds_free_with(sorter->allocator, runs[i].buffer, buffer_size);
+	}
+	if (runs) {
+		ds_free_with(sorter->allocator, runs, k * sizeof(Run));
+	}
+	if (heads) {
+		ds_free_with(sorter->allocator, heads, k * sizeof(const void *));
+	}
+	ds_loser_tree_delete(tree);
+	return rval;
+}
+
+// the next record of the run, or NULL at its end
+static const void *next_record(Run *run, unsigned long data_size) {
+	if (run->next == run->length) {
+		unsigned long bytes = fread(run->buffer, 1, run->capacity * data_size, run->file);
+		if (ferror(run->file) || bytes % data_size != 0) {
+			run->error = 1;
+			return NULL;
+		}
+		run->length = bytes / data_size;
+		run->next = 0;
+		if (run->length == 0) {
+			return NULL;
+		}
+	}
+	return run->buffer + run->next++ * data_size;
+}
+
+// Appends to the list, or copies to the buffer of the file and writes it
+// when it is full. Records put without a buffer are written at once.
+static int put(Sink *sink, const void *records, unsigned long count, unsigned long data_size) {
+	if (sink->list) {
+		AList *list = sink->list;
+		if (list->max_length - list->length < count) {
+			return DS_OVERFLOW;
+		}
+		memcpy(list->array + list->length * data_size, records, count * data_size);
+		list->length += count;
+		return DS_OK;
+	}
+	if (!sink->buffer) {
+		return fwrite(records, data_size, count, sink->file) == count ? DS_OK : DS_IO_ERROR;
+	}
+	for (unsigned long i = 0; i < count; i++) {
+		if (sink->length == sink->capacity && flush(sink, data_size) != DS_OK) {
+			return DS_IO_ERROR;
+		}
+		memcpy(sink->buffer + sink->length * data_size, (const unsigned char *) records + i * data_size, data_size);
+		sink->length++;
+	}
+	return DS_OK;
+}
+
+static int flush(Sink *sink, unsigned long data_size) {
+	if (sink->buffer && sink->length > 0) {
+		if (fwrite(sink->buffer, data_size, sink->length, sink->file) != sink->length) {
+			return DS_IO_ERROR;
+		}
+		sink->length = 0;
+	}
+	return DS_OK;
+}
+
+static void close_runs(Sorter *sorter) {
+	for (unsigned long i = 0; i < sorter->run_count; i++) {
+		if (sorter->runs[i]) {
+			fclose(sorter->runs[i]);
+		}
+	}
+	if (sorter->runs) {
+		ds_free_with(sorter->allocator, sorter->runs, sorter->run_capacity * sizeof(FILE *));
+	}
+	sorter->runs = NULL;
+	sorter->run_count = 0;
+}
@@ -0,0 +1,51 @@
+#ifndef __EXTSORT_H__
+#define __EXTSORT_H__
+
+#include "alist.h"
+#include <stdio.h>
+
+/*
+ * External Sort
+ * Sorts a stream of records of data_size bytes that may be larger than
+ * memory, using no more than about memory bytes of buffers. The records
+ * are read from in until its end, memory at a time, sorted with
+ * ds_quick_sort and written as runs to temporary files from tmpfile. The
+ * runs are then merged with a loser tree, each through a buffer of its own
+ * of at least DS_EXTSORT_MIN_BLOCK bytes. When there are too many runs for
+ * that, they are merged in passes, as many at a time as fit. The input is
+ * sorted in memory, without files, if it fits.
+ *
+ * ds_external_sort writes the sorted records to out. ds_external_sort_alist
+ * appends them to dst and returns DS_OVERFLOW if they do not fit; dst may
+ * have been created with any allocator, one that maps a file included, as
+ * the buffers do not come from it. The sort is not stable.
+ *
+ * They return DS_IO_ERROR if a file cannot be read, written or created, or
+ * if in ends in the middle of a record, and DS_OUT_OF_BOUNDS if memory is
+ * too small to hold four records. The files are read and written in blocks
+ * of whole buffers, with the buffering of stdio turned off for the
+ * temporary files.
+ *
+ * ds_external_sort_with and ds_external_sort_alist_with take the buffers
+ * from an allocator.
+ */
+#define DS_EXTSORT_MIN_BLOCK (64UL * 1024UL)
+
+int ds_external_sort(FILE *in, FILE *out, unsigned long data_size, unsigned long memory, DSCompare compare);
+int ds_external_sort_with(
+		const DSAllocator *allocator,
+		FILE *in,
+		FILE *out,
+		unsigned long data_size,
+		unsigned long memory,
+		DSCompare compare);
+int ds_external_sort_alist(FILE *in, AList *dst, unsigned long memory, DSCompare compare);
+int ds_external_sort_alist_with(
+		const DSAllocator *allocator,
+		FILE *in,
+		AList *dst,
+		unsigned long memory,
+		DSCompare compare);
+
+
+#endif  // __EXTSORT_H__
@@ -0,0 +1,180 @@
+#include "extsort.h"
+#include <assert.h>
+#include <stdlib.h>
+#include <stdio.h>
+#include <string.h>
+
+typedef struct Record {
+	int key;
+	char payload[60];
+} Record;
+
+int compare_ints(const int *a, const int *b) {
+	return (*a > *b) - (*a < *b);
+}
+
+// a temporary file of length random ints, and their sum
+FILE *random_ints(unsigned long length, long long *out_sum) {
+	FILE *file = tmpfile();
+	*out_sum = 0;
+	for (unsigned long i = 0; i < length; i++) {
+		int n = rand();
+		*out_sum += n;
+		fwrite(&n, sizeof(int), 1, file);
+	}
+	rewind(file);
+	return file;
+}
+
+// allocator that counts its allocations
+void *counting_alloc(void *context, unsigned long size) {
+	(*(unsigned long *) context)++;
+	return malloc(size);
+}
+
+void *counting_realloc(void *context, void *ptr, unsigned long old_size, unsigned long size) {
+	(void) old_size;
+	(*(unsigned long *) context)++;
+	return realloc(ptr, size);
+}
+
+void counting_free(void *context, void *ptr, unsigned long size) {
+	(void) context;
+	(void) size;
+	free(ptr);
+}
+
+// checks that file holds length ints in order, with the given sum
+void check_sorted(FILE *file, unsigned long length, long long sum) {
+	int n, previous = -1;
+	unsigned long count = 0;
+	rewind(file);
+	while (fread(&n, sizeof(int), 1, file) == 1) {
+		assert(n >= previous);
+		previous = n;
+		sum -= n;
+		count++;
+	}
+	assert(count == length);
+	assert(sum == 0);
+}
+
+int main() {
+	srand(3);
+
+	// in memory, in one merge, and in several passes, as the memory shrinks
+	{
+		unsigned long lengths[] = { 0, 1, 1000, 1000000 };
+		unsigned long memories[] = { 64UL << 20, 1UL << 20, 200UL * 1024 };
+		for (unsigned long l = 0; l < sizeof(lengths) / sizeof(lengths[0]); l++) {
+			for (unsigned long m = 0; m < sizeof(memories) / sizeof(memories[0]); m++) {
+				long long sum;
+				FILE *in = random_ints(lengths[l], &sum);
+				FILE *out = tmpfile();
+				int rval = ds_external_sort(in, out, sizeof(int), memories[m], (DSCompare) compare_ints);
+				assert(rval == DS_OK);
+				check_sorted(out, lengths[l], sum);
+				fclose(in);
+				fclose(out);
+			}
+		}
+	}
+
+	// a run of exactly the size of memory
+	{
+		long long sum;
+		unsigned long memory = 64 * sizeof(int);
+		FILE *in = random_ints(63, &sum);
+		FILE *out = tmpfile();
+		assert(ds_external_sort(in, out, sizeof(int), memory, (DSCompare) compare_ints) == DS_OK);
+		check_sorted(out, 63, sum);
+		fclose(in);
+
+		// sorted in memory, with the buffer of the chunk as the only allocation
+		unsigned long allocations = 0;
+		DSAllocator counting = { counting_alloc, counting_realloc, counting_free, &allocations };
+		AList *list = alist_new(63, sizeof(int));
+		in = random_ints(63, &sum);
+		assert(ds_external_sort_alist_with(&counting, in, list, memory, (DSCompare) compare_ints) == DS_OK);
+		assert(allocations == 1);
+		assert(list->length == 63);
+		for (unsigned long i = 0; i < 63; i++) {
+			sum -= ((int *) list->array)[i];
+			assert(i == 0 || ((int *) list->array)[i-1] <= ((int *) list->array)[i]);
+		}
+		assert(sum == 0);
+		alist_delete(list);
+		fclose(in);
+		fclose(out);
+	}
+
+	// records larger than the keys, into a list
+	{
+		const unsigned long length = 50000;
+		FILE *in = tmpfile();
+		AList *list = alist_new(length, sizeof(Record));
+		for (unsigned long i = 0; i < length; i++) {
+			Record record;
+			memset(&record, 0, sizeof(Record));
+			record.key = (int) ((i * 7919) % length);
+			snprintf(record.payload, sizeof(record.payload), "%d", record.key);
+			fwrite(&record, sizeof(Record), 1, in);
+		}
+		rewind(in);
+		assert(ds_external_sort_alist(in, list, 256 * 1024, (DSCompare) compare_ints) == DS_OK);
+		assert(list->length == length);
+		for (unsigned long i = 0; i < length; i++) {
+			Record record;
+			alist_get(list, i, &record);
+			assert(record.key == (int) i);
+			assert(atoi(record.payload) == (int) i);
+		}
+
+		// too many for the list
+		AList *small = alist_new(length - 1, sizeof(Record));
+		rewind(in);
+		assert(ds_external_sort_alist(in, small, 256 * 1024, (DSCompare) compare_ints) == DS_OVERFLOW);
+		rewind(in);
+		assert(ds_external_sort_alist(in, small, 64UL << 20, (DSCompare) compare_ints) == DS_OVERFLOW);
+		alist_delete(small);
+		alist_delete(list);
+		fclose(in);
+	}
+
+	// errors
+	{
+		long long sum;
+		FILE *in = random_ints(10, &sum);
+		FILE *out = tmpfile();
+		assert(ds_external_sort(in, out, sizeof(int), 3 * sizeof(int), (DSCompare) compare_ints) == DS_OUT_OF_BOUNDS);
+		fseek(in, 0, SEEK_END);
+		fputc(0, in);
+		rewind(in);
+		assert(ds_external_sort(in, out, sizeof(int), 1 << 20, (DSCompare) compare_ints) == DS_IO_ERROR);
+		fclose(in);
+		fclose(out);
+	}
+
+	// the loser tree by itself
+	{
+		int a[] = { 1, 4, 7 }, b[] = { 2, 5 }, c[] = { 3, 6, 8, 9 };
+		int *sources[] = { a, b, c, NULL };
+		unsigned long lengths[] = { 3, 2, 4, 0 };
+		unsigned long next[] = { 0, 0, 0, 0 };
+		const void *heads[] = { a, b, c, NULL };
+		DSLoserTree *tree = ds_loser_tree_new(4, (DSCompare) compare_ints);
+		assert(ds_loser_tree_new(0, (DSCompare) compare_ints) == NULL);
+		ds_loser_tree_init(tree, heads);
+		for (int expected = 1; expected <= 9; expected++) {
+			unsigned long winner = ds_loser_tree_winner(tree);
+			assert(winner < 3);
+			assert(*(const int *) ds_loser_tree_head(tree) == expected);
+			next[winner]++;
+			ds_loser_tree_replace(tree, next[winner] < lengths[winner] ? sources[winner] + next[winner] : NULL);
+		}
+		assert(ds_loser_tree_winner(tree) == 4);
+		ds_loser_tree_delete(tree);
+	}
+
+	return 0;
+}
@@ -0,0 +1,143 @@
+#include "galist.h"
+#include <stdlib.h>
+#include <string.h>
+
+#define GAP_SIZE(g) ((g)->list->max_length - (g)->list->length)
+#define SLOT(g, i) ((g)->list->array + (i) * (g)->list->data_size)
+
+// the slot in the array of the record at index
+#define RECORD(g, index) SLOT(g, (index) < (g)->gap ? (index) : (index) + GAP_SIZE(g))
+
+static void move_gap(GapAList *list, unsigned long index);
+
+
+GapAList *galist_new(unsigned long max_length, unsigned long data_size) {
+	return galist_new_with(NULL, max_length, data_size);
+}
+
+GapAList *galist_new_in(DSArena *arena, unsigned long max_length, unsigned long data_size) {
+	return galist_new_with(ds_arena_allocator(arena), max_length, data_size);
+}
+
+GapAList *galist_new_with(const DSAllocator *allocator, unsigned long max_length, unsigned long data_size) {
+	GapAList *list = ds_alloc_with(allocator, sizeof(GapAList));
+	if (!list) {
+		return NULL;
+	}
+	list->list = alist_new_with(allocator, max_length, data_size);
+	if (!list->list) {
+		ds_free_with(allocator, list, sizeof(GapAList));
+		return NULL;
+	}
+	list->gap = 0;
+	return list;
+}
+
+void galist_delete(GapAList *list) {
+	if (list) {
+		const DSAllocator *allocator = list->list->allocator;
+		alist_delete(list->list);
+		ds_free_with(allocator, list, sizeof(GapAList));
+	}
+}
+
+unsigned long galist_length(GapAList *list) {
+	return list->list->length;
+}
+
+int galist_push(GapAList *list, const void *data) {
+	return galist_add(list, list->list->length, data);
+}
+
+int galist_pop(GapAList *list, void *out_data) {
+	if (list->list->length == 0) {
+		return DS_EMPTY;
+	}
+	galist_get(list, list->list->length - 1, out_data);
+	return galist_remove(list, list->list->length - 1);
+}
+
+int galist_set(GapAList *list, unsigned long index, const void *data) {
+	if (index >= list->list->length) {
+		return DS_OUT_OF_BOUNDS;
+	}
+	memcpy(RECORD(list, index), data, list->list->data_size);
+	return DS_OK;
+}
+
+int galist_get(GapAList *list, unsigned long index, void *out_data) {
+	if (index >= list->list->length) {
+		return DS_OUT_OF_BOUNDS;
+	}
+	memcpy(out_data, RECORD(list, index), list->list->data_size);
+	return DS_OK;
+}
+
+int galist_add(GapAList *list, unsigned long index, const void *data) {
+	if (index > list->list->length) {
+		return DS_OUT_OF_BOUNDS;
+	}
+	if (list->list->length == list->list->max_length) {
+		return DS_OVERFLOW;
+	}
+	move_gap(list, index);
+	memcpy(SLOT(list, list->gap), data, list->list->data_size);
+	list->gap++;
+	list->list->length++;
+	return DS_OK;
+}
+
+// With the gap before the record, removing it is growing the gap over it.
+int galist_remove(GapAList *list, unsigned long index) {
+	if (index >= list->list->length) {
+		return DS_OUT_OF_BOUNDS;
+	}
+	move_gap(list, index);
+	list->list->length--;
+	return DS_OK;
+}
+
+int galist_move_gap(GapAList *list, unsigned long index) {
+	if (index > list->list->length) {
+		return DS_OUT_OF_BOUNDS;
+	}
+	move_gap(list, index);
+	return DS_OK;
+}
+
+AList *galist_contiguous(GapAList *list) {
+	move_gap(list, list->list->length);
+	return list->list;
+}
+
+int galist_sort(GapAList *list, DSCompare compare) {
+	return alist_sort(galist_contiguous(list), compare);
+}
+
+void galist_clear(GapAList *list) {
+	alist_clear(list->list);
+	list->gap = 0;
+}
+
+
+// Shifts the records between the gap and index across the gap. A gap past
+// the end is where records were dropped through the AList.
+static void move_gap(GapAList *list, unsigned long index) {
+	unsigned long data_size = list->list->data_size;
+	unsigned long gap_size = GAP_SIZE(list);
+	if (list->gap > list->list->length) {
+		list->gap = list->list->length;
+	}
+	if (index < list->gap) {
+		memmove(SLOT(list, index + gap_size), SLOT(list, index), (list->gap - index) * data_size);
+		DS_STAT(&list->list->stats, bytes_moved, (list->gap - index) * data_size);
+		DS_STAT_COST(&list->list->stats, list->gap - index);
+	}
+	else if (index > list->gap) {
+		memmove(SLOT(list, list->gap), SLOT(list, list->gap + gap_size), (index - list->gap) * data_size);
+		DS_STAT(&list->list->stats, bytes_moved, (index - list->gap) * data_size);
+		DS_STAT_COST(&list->list->stats, index - list->gap);
+	}
+	list->gap = index;
+	DS_STAT(&list->list->stats, ops, 1);
+}
@@ -0,0 +1,58 @@
+#ifndef __GALIST_H__
+#define __GALIST_H__
+
+#include "alist.h"
+
+/*
+ * Gap Buffer List
+ * List of up to max_length records of data_size bytes, like AList, that
+ * keeps its free space as a gap at the last place a record was added or
+ * removed. Adding or removing a record moves the gap there first, which
+ * shifts only the records between the old place and the new, so inserts
+ * and removals clustered around a moving cursor are O(1) amortized
+ * instead of shifting the whole tail. Records at index i below the gap are
+ * at i in the array, and the ones above it after the gap.
+ *
+ * galist_get and galist_set take the index of a record, as in AList, and do
+ * not move the gap. galist_push and galist_pop move it to the end.
+ *
+ * The records are kept in an AList. galist_contiguous moves the gap to the
+ * end and returns that AList, whose records are then in order in its array,
+ * so that the alist_ functions that read, reorder or drop records, as
+ * alist_sort, alist_find or alist_remove_if, can be used on it until the
+ * next galist_add or galist_remove. Records must not be added through it.
+ * galist_sort sorts the list that way.
+ *
+ * galist_move_gap moves the gap to before the record at index, as to
+ * prepare a run of adds there.
+ */
+typedef struct GapAList {
+	AList *list;
+	unsigned long gap;
+} GapAList;
+
+
+GapAList *galist_new(unsigned long max_length, unsigned long data_size);
+GapAList *galist_new_in(DSArena *arena, unsigned long max_length, unsigned long data_size);
+GapAList *galist_new_with(const DSAllocator *allocator, unsigned long max_length, unsigned long data_size);
+void galist_delete(GapAList *list);
+
+unsigned long galist_length(GapAList *list);
+
+int galist_push(GapAList *list, const void *data);
+int galist_pop(GapAList *list, void *out_data);
+
+int galist_set(GapAList *list, unsigned long index, const void *data);
+int galist_get(GapAList *list, unsigned long index, void *out_data);
+
+int galist_add(GapAList *list, unsigned long index, const void *data);
+int galist_remove(GapAList *list, unsigned long index);
+
+int galist_move_gap(GapAList *list, unsigned long index);
+AList *galist_contiguous(GapAList *list);
+int galist_sort(GapAList *list, DSCompare compare);
+
+void galist_clear(GapAList *list);
+
+
+#endif  // __GALIST_H__
@@ -0,0 +1,158 @@
+#include "galist.h"
+#include <assert.h>
+#include <stdlib.h>
+#include <stdio.h>
+
+#define LENGTH 1000
+
+int compare_ints(const int *a, const int *b) {
+	return (*a > *b) - (*a < *b);
+}
+
+int is_odd(const int *n, void *context) {
+	(void) context;
+	return *n % 2 != 0;
+}
+
+// checks that the gap buffer holds the same records as the list
+void check_same(GapAList *gap, AList *list) {
+	assert(galist_length(gap) == list->length);
+	for (unsigned long i = 0; i < list->length; i++) {
+		int a, b;
+		assert(galist_get(gap, i, &a) == DS_OK);
+		assert(alist_get(list, i, &b) == DS_OK);
+		assert(a == b);
+	}
+}
+
+int main() {
+	srand(7);
+
+	// the same operations on a gap buffer and on an AList
+	{
+		GapAList *gap = galist_new(LENGTH, sizeof(int));
+		AList *list = alist_new(LENGTH, sizeof(int));
+		unsigned long cursor = 0;
+		int n;
+		assert(galist_pop(gap, &n) == DS_EMPTY);
+		assert(galist_remove(gap, 0) == DS_OUT_OF_BOUNDS);
+		assert(galist_add(gap, 1, &n) == DS_OUT_OF_BOUNDS);
+		for (int it = 0; it < 20000; it++) {
+			int op = rand() % 10;
+			n = rand();
+			// a cursor that wanders, with a jump now and then
+			if (rand() % 50 == 0) {
+				cursor = list->length ? (unsigned long) rand() % list->length : 0;
+			}
+			else if (cursor > 0 && rand() % 2) {
+				cursor--;
+			}
+			else if (cursor < list->length) {
+				cursor++;
+			}
+			if (op < 5) {
+				int a = galist_add(gap, cursor, &n);
+				int b = alist_add(list, cursor, &n);
+				assert(a == b);
+			}
+			else if (op < 8) {
+				if (list->length > 0) {
+					unsigned long index = cursor < list->length ? cursor : list->length - 1;
+					assert(galist_remove(gap, index) == DS_OK);
+					assert(alist_remove(list, index) == DS_OK);
+				}
+			}
+			else if (op < 9) {
+				if (list->length > 0) {
+					unsigned long index = (unsigned long) rand() % list->length;
+					assert(galist_set(gap, index, &n) == DS_OK);
+					assert(alist_set(list, index, &n) == DS_OK);
+				}
+			}
+			else {
+				int a, b;
+				int ra = galist_pop(gap, &a);
+				int rb = alist_pop(list, &b);
+				assert(ra == rb);
+				assert(ra != DS_OK || a == b);
+				if (rb == DS_OK && galist_length(gap) < LENGTH) {
+					assert(galist_push(gap, &a) == DS_OK);
+					assert(alist_push(list, &b) == DS_OK);
+				}
+			}
+			if (it % 1000 == 0) {
+				check_same(gap, list);
+			}
+		}
+		check_same(gap, list);
+
+		// full
+		while (list->length < LENGTH) {
+			galist_push(gap, &n);
+			alist_push(list, &n);
+		}
+		assert(galist_add(gap, 10, &n) == DS_OVERFLOW);
+		assert(galist_push(gap, &n) == DS_OVERFLOW);
+		check_same(gap, list);
+
+		galist_delete(gap);
+		alist_delete(list);
+	}
+
+	// contiguous storage for the alist_ functions
+	{
+		GapAList *gap = galist_new(LENGTH, sizeof(int));
+		for (int i = 0; i < 100; i++) {
+			int n = 99 - i;
+			galist_add(gap, galist_length(gap) / 2, &n);
+		}
+		assert(galist_move_gap(gap, 101) == DS_OUT_OF_BOUNDS);
+		assert(galist_move_gap(gap, 10) == DS_OK);
+		assert(gap->gap == 10);
+
+		AList *list = galist_contiguous(gap);
+		assert(list->length == 100);
+		for (unsigned long i = 0; i < 100; i++) {
+			int n;
+			galist_get(gap, i, &n);
+			assert(((int *) list->array)[i] == n);
+		}
+
+		assert(galist_sort(gap, (DSCompare) compare_ints) == DS_OK);
+		for (int i = 0; i < 100; i++) {
+			int n;
+			galist_get(gap, (unsigned long) i, &n);
+			assert(n == i);
+		}
+
+		// records dropped through the AList
+		alist_remove_if(galist_contiguous(gap), (DSPredicate) is_odd, NULL);
+		assert(galist_length(gap) == 50);
+		int n = -1;
+		assert(galist_add(gap, 0, &n) == DS_OK);
+		for (int i = 0; i < 51; i++) {
+			galist_get(gap, (unsigned long) i, &n);
+			assert(n == (i == 0 ? -1 : 2 * (i - 1)));
+		}
+
+		galist_clear(gap);
+		assert(galist_length(gap) == 0);
+		galist_delete(gap);
+	}
+
+	// from an arena
+	{
+		DSArena *arena = ds_arena_new(1 << 16);
+		GapAList *gap = galist_new_in(arena, 100, sizeof(long));
+		for (long i = 0; i < 100; i++) {
+			assert(galist_add(gap, 0, &i) == DS_OK);
+		}
+		long first;
+		galist_get(gap, 0, &first);
+		assert(first == 99);
+		galist_delete(gap);
+		ds_arena_delete(arena);
+	}
+
+	return 0;
+}
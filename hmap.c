@@ -0,0 +1,417 @@
+#include "hmap.h"
+#include <stddef.h>
+#include <stdlib.h>
+#include <string.h>
+
+#define MIN_CAPACITY 8
+#define MIGRATE_STEP 4
+
+#define ROUND_UP(n, align) (((n) + (align) - 1) & ~((align) - 1))
+
+#define ENTRY(map, entries, i) ((entries) + (i) * (map)->entry_size)
+
+static unsigned long natural_alignment(unsigned long size);
+static unsigned long probe(HMap *map, const void *key, unsigned long hash);
+static unsigned long probe_old(HMap *map, const void *key, unsigned long hash);
+static void place(HMap *map, const void *entry, unsigned long hash);
+static void erase(HMap *map, unsigned short *control, unsigned char *entries, unsigned long mask, unsigned long pos);
+static void migrate(HMap *map, unsigned long steps);
+static int grow(HMap *map);
+static int new_table(HMap *map, unsigned short **control, unsigned char **entries, unsigned long capacity);
+static void free_table(HMap *map, unsigned short *control, unsigned char *entries, unsigned long capacity);
+static int append_keys(AList *dst, HMap *src, HMap *in, HMap *not_in);
+
+
+HMap *hmap_new(
+		unsigned long capacity,
+		unsigned long key_size,
+		unsigned long value_size,
+		DSHash hash,
+		DSCompare compare)
+{
+	return hmap_new_with(NULL, capacity, key_size, value_size, hash, compare);
+}
+
+HMap *hmap_new_with(
+		const DSAllocator *allocator,
+		unsigned long capacity,
+		unsigned long key_size,
+		unsigned long value_size,
+		DSHash hash,
+		DSCompare compare)
+{
+	HMap *map;
+	unsigned long key_align, value_align;
+	unsigned long c = MIN_CAPACITY;
+	while (c - c / 8 < capacity) {
+		c *= 2;
+	}
+	map = ds_alloc_with(allocator, sizeof(HMap));
+	if (!map) {
+		return NULL;
+	}
+	memset(map, 0, sizeof(HMap));
+	map->allocator = allocator;
+	map->key_size = key_size;
+	map->value_size = value_size;
+	// the keys and the values start at addresses aligned for their sizes,
+	// for the callbacks and for the pointers hmap_find returns
+	key_align = natural_alignment(key_size);
+	value_align = natural_alignment(value_size);
+	map->value_offset = ROUND_UP(key_size, value_align);
+	map->entry_size = ROUND_UP(map->value_offset + value_size, key_align > value_align ? key_align : value_align);
+	map->hash = hash;
+	map->compare = compare;
+	if (new_table(map, &map->control, &map->entries, c) != DS_OK) {
+		hmap_delete(map);
+		return NULL;
+	}
+	map->capacity = c;
+	return map;
+}
+
+void hmap_delete(HMap *map) {
+	if (map) {
+		free_table(map, map->control, map->entries, map->capacity);
+		free_table(map, map->old_control, map->old_entries, map->old_capacity);
+		ds_free_with(map->allocator, map, sizeof(HMap));
+	}
+}
+
+int hmap_put(HMap *map, const void *key, const void *value) {
+	unsigned long hash = map->hash(key);
+	unsigned char *found;
+	unsigned char *entry;
+	migrate(map, MIGRATE_STEP);
+	found = hmap_find(map, key);  // counts the operation
+	if (found) {
+		if (map->value_size > 0) {
+			memcpy(found, value, map->value_size);
+		}
+		return DS_OK;
+	}
+	if (map->length + 1 > map->capacity - map->capacity / 8) {
+		if (grow(map) != DS_OK) {
+			return DS_MALLOC_ERROR;
+		}
+	}
+	entry = ENTRY(map, map->entries, map->capacity);
+	memcpy(entry, key, map->key_size);
+	if (map->value_size > 0) {
+		memcpy(entry + map->value_offset, value, map->value_size);
+	}
+	place(map, entry, hash);
+	map->length++;
+	return DS_OK;
+}
+
+int hmap_get(HMap *map, const void *key, void *out_value) {
+	void *value = hmap_find(map, key);
+	if (!value) {
+		return DS_NOT_FOUND;
+	}
+	if (map->value_size > 0) {
+		memcpy(out_value, value, map->value_size);
+	}
+	return DS_OK;
+}
+
+void *hmap_find(HMap *map, const void *key) {
+	unsigned long hash = map->hash(key);
+	unsigned long pos;
+	DS_STAT(&map->stats, ops, 1);
+	pos = probe(map, key, hash);
+	if (pos < map->capacity) {
+		return ENTRY(map, map->entries, pos) + map->value_offset;
+	}
+	pos = probe_old(map, key, hash);
+	if (pos < map->old_capacity) {
+		return ENTRY(map, map->old_entries, pos) + map->value_offset;
+	}
+	return NULL;
+}
+
+int hmap_contains(HMap *map, const void *key) {
+	return hmap_find(map, key) != NULL;
+}
+
+int hmap_remove(HMap *map, const void *key) {
+	unsigned long hash = map->hash(key);
+	unsigned long pos;
+	migrate(map, MIGRATE_STEP);
+	DS_STAT(&map->stats, ops, 1);
+	pos = probe(map, key, hash);
+	if (pos < map->capacity) {
+		erase(map, map->control, map->entries, map->capacity - 1, pos);
+		map->length--;
+		return DS_OK;
+	}
+	pos = probe_old(map, key, hash);
+	if (pos < map->old_capacity) {
+		erase(map, map->old_control, map->old_entries, map->old_capacity - 1, pos);
+		map->length--;
+		return DS_OK;
+	}
+	return DS_NOT_FOUND;
+}
+
+int hmap_next(HMap *map, unsigned long *iterator, void **out_key, void **out_value) {
+	for (; *iterator < map->old_capacity + map->capacity; (*iterator)++) {
+		unsigned char *entry;
+		if (*iterator < map->old_capacity) {
+			if (!map->old_control[*iterator]) {
+				continue;
+			}
+			entry = ENTRY(map, map->old_entries, *iterator);
+		}
+		else {
+			unsigned long pos = *iterator - map->old_capacity;
+			if (!map->control[pos]) {
+				continue;
+			}
+			entry = ENTRY(map, map->entries, pos);
+		}
+		(*iterator)++;
+		if (out_key) {
+			*out_key = entry;
+		}
+		if (out_value) {
+			*out_value = entry + map->value_offset;
+		}
+		return 1;
+	}
+	return 0;
+}
+
+void hmap_clear(HMap *map) {
+	memset(map->control, 0, map->capacity * sizeof(unsigned short));
+	free_table(map, map->old_control, map->old_entries, map->old_capacity);
+	map->old_control = NULL;
+	map->old_entries = NULL;
+	map->old_capacity = 0;
+	map->length = 0;
+}
+
+const DSStats *hmap_stats(HMap *map) {
+	return DS_STATS_OF(map);
+}
+
+int hmap_union(AList *dst, HMap *a, HMap *b) {
+	alist_clear(dst);
+	if (append_keys(dst, a, NULL, NULL) != DS_OK) {
+		return DS_OVERFLOW;
+	}
+	return append_keys(dst, b, NULL, a);
+}
+
+int hmap_intersection(AList *dst, HMap *a, HMap *b) {
+	alist_clear(dst);
+	if (a->length > b->length) {
+		return append_keys(dst, b, a, NULL);
+	}
+	return append_keys(dst, a, b, NULL);
+}
+
+int hmap_difference(AList *dst, HMap *a, HMap *b) {
+	alist_clear(dst);
+	return append_keys(dst, a, NULL, b);
+}
+
+
+// index of the key in the current table, or capacity
+// the greatest power of two that divides size, up to that of max_align_t,
+// which is the alignment of any type of that size
+static unsigned long natural_alignment(unsigned long size) {
+	unsigned long align = size & -size;
+	if (size == 0) {
+		return 1;
+	}
+	if (align > _Alignof(max_align_t)) {
+		return _Alignof(max_align_t);
+	}
+	return align;
+}
+
+static unsigned long probe(HMap *map, const void *key, unsigned long hash) {
+	unsigned long mask = map->capacity - 1;
+	unsigned long pos = hash & mask;
+	unsigned long dist = 1;
+	for (;; pos = (pos + 1) & mask, dist++) {
+		unsigned long c = map->control[pos];
+		if (c < dist) {
+			DS_STAT_COST(&map->stats, dist);
+			return map->capacity;
+		}
+		if (c == dist) {
+			DS_STAT(&map->stats, compares, 1);
+			if (map->compare(ENTRY(map, map->entries, pos), key) == 0) {
+				DS_STAT_COST(&map->stats, dist);
+				return pos;
+			}
+		}
+	}
+}
+
+// index of the key in the old table, or old_capacity.
+// Probes skip the slots that were already moved.
+static unsigned long probe_old(HMap *map, const void *key, unsigned long hash) {
+	unsigned long mask = map->old_capacity - 1;
+	unsigned long pos = hash & mask;
+	unsigned long dist = 1;
+	if (!map->old_control) {
+		return map->old_capacity;
+	}
+	for (;; pos = (pos + 1) & mask, dist++) {
+		unsigned long offset = (pos - map->old_start) & mask;
+		unsigned long c;
+		if (offset < map->old_done) {
+			dist += map->old_done - offset;
+			pos = (map->old_start + map->old_done) & mask;
+		}
+		c = map->old_control[pos];
+		if (c < dist) {
+			return map->old_capacity;
+		}
+		if (c == dist) {
+			DS_STAT(&map->stats, compares, 1);
+			if (map->compare(ENTRY(map, map->old_entries, pos), key) == 0) {
+				return pos;
+			}
+		}
+	}
+}
+
+// insert an entry that is not in the table, there must be room for it.
+// The entry may be the temporary entry, which is overwritten.
+static void place(HMap *map, const void *entry, unsigned long hash) {
+	unsigned long mask = map->capacity - 1;
+	unsigned long pos = hash & mask;
+	unsigned short dist = 1;
+	unsigned char *tmp = ENTRY(map, map->entries, map->capacity);
+	unsigned char *swap = ENTRY(map, map->entries, map->capacity + 1);
+	if (entry != tmp) {
+		memcpy(tmp, entry, map->entry_size);
+	}
+	for (;; pos = (pos + 1) & mask, dist++) {
+		unsigned short c = map->control[pos];
+		unsigned char *slot = ENTRY(map, map->entries, pos);
+		if (c == 0) {
+			map->control[pos] = dist;
+			memcpy(slot, tmp, map->entry_size);
+			DS_STAT(&map->stats, bytes_moved, map->entry_size);
+			return;
+		}
+		if (c < dist) {
+			DS_STAT(&map->stats, bytes_moved, 3 * map->entry_size);
+			memcpy(swap, slot, map->entry_size);
+			memcpy(slot, tmp, map->entry_size);
+			memcpy(tmp, swap, map->entry_size);
+			map->control[pos] = dist;
+			dist = c;
+		}
+	}
+}
+
+// empty a slot and shift the rest of its cluster back
+static void erase(HMap *map, unsigned short *control, unsigned char *entries, unsigned long mask, unsigned long pos) {
+	unsigned long next = (pos + 1) & mask;
+	while (control[next] > 1) {
+		control[pos] = control[next] - 1;
+		memcpy(ENTRY(map, entries, pos), ENTRY(map, entries, next), map->entry_size);
+		DS_STAT(&map->stats, bytes_moved, map->entry_size);
+		pos = next;
+		next = (next + 1) & mask;
+	}
+	control[pos] = 0;
+}
+
+static void migrate(HMap *map, unsigned long steps) {
+	unsigned long mask = map->old_capacity - 1;
+	if (!map->old_control) {
+		return;
+	}
+	for (; steps > 0 && map->old_done < map->old_capacity; steps--) {
+		unsigned long pos = (map->old_start + map->old_done) & mask;
+		if (map->old_control[pos]) {
+			unsigned char *entry = ENTRY(map, map->old_entries, pos);
+			place(map, entry, map->hash(entry));
+			map->old_control[pos] = 0;
+		}
+		map->old_done++;
+	}
+	if (map->old_done == map->old_capacity) {
+		free_table(map, map->old_control, map->old_entries, map->old_capacity);
+		map->old_control = NULL;
+		map->old_entries = NULL;
+		map->old_capacity = 0;
+	}
+}
+
+static int grow(HMap *map) {
+	unsigned long capacity = map->capacity * 2;
+	unsigned long start = 0;
+	unsigned short *control;
+	unsigned char *entries;
+	migrate(map, (unsigned long) -1);
+	if (new_table(map, &control, &entries, capacity) != DS_OK) {
+		return DS_MALLOC_ERROR;
+	}
+	// start draining at the beginning of a cluster
+	while (map->control[start] > 1) {
+		start++;
+	}
+	map->old_control = map->control;
+	map->old_entries = map->entries;
+	map->old_capacity = map->capacity;
+	map->old_start = start;
+	map->old_done = 0;
+	map->control = control;
+	map->entries = entries;
+	map->capacity = capacity;
+	return DS_OK;
+}
+
+// allocate a table of capacity empty slots
+static int new_table(HMap *map, unsigned short **control, unsigned char **entries, unsigned long capacity) {
+	*control = ds_alloc_with(map->allocator, capacity * sizeof(unsigned short));
+	*entries = ds_alloc_with(map->allocator, (capacity + 2) * map->entry_size);  // the last two entries are temporary entries used for swapping
+	if (!*control || !*entries) {
+		free_table(map, *control, *entries, capacity);
+		*control = NULL;
+		*entries = NULL;
+		return DS_MALLOC_ERROR;
+	}
+	memset(*control, 0, capacity * sizeof(unsigned short));
+	DS_STAT(&map->stats, allocations, 2);
+	return DS_OK;
+}
+
+// free a table of capacity slots, which may be NULL
+static void free_table(HMap *map, unsigned short *control, unsigned char *entries, unsigned long capacity) {
+	if (control) {
+		ds_free_with(map->allocator, control, capacity * sizeof(unsigned short));
+		DS_STAT(&map->stats, frees, 1);
+	}
+	if (entries) {
+		ds_free_with(map->allocator, entries, (capacity + 2) * map->entry_size);
+		DS_STAT(&map->stats, frees, 1);
+	}
+}
+
+// copy the keys of src that are in the map in and not in the map not_in to the end of dst
+static int append_keys(AList *dst, HMap *src, HMap *in, HMap *not_in) {
+	unsigned long it = 0;
+	void *key;
+	while (hmap_next(src, &it, &key, NULL)) {
+		if ((in && !hmap_find(in, key)) || (not_in && hmap_find(not_in, key))) {
+			continue;
+		}
+		if (dst->length == dst->max_length) {
+			return DS_OVERFLOW;
+		}
+		memcpy(dst->array + dst->length * dst->data_size, key, src->key_size);
+		dst->length++;
+	}
+	return DS_OK;
+}
+
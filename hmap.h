@@ -0,0 +1,91 @@
+#ifndef __HMAP_H__
+#define __HMAP_H__
+
+#include "alist.h"
+
+/*
+ * Hash Map
+ * Type-erased twin of the DEFINE_HASH_MAP macro in map.h, for keys of
+ * key_size bytes and values of value_size bytes. Keys are hashed with
+ * hash and are equal if compare returns 0. It uses the same open addressing
+ * with Robin Hood probing, deletion by backward shift and incremental
+ * rehash; see map.h.
+ *
+ * A map with value_size 0 is a hash set. The set operations hmap_union,
+ * hmap_intersection and hmap_difference write the keys of the result into
+ * an AList of key_size records, which is cleared first. They return
+ * DS_OVERFLOW if the keys do not fit. Intersection iterates over the
+ * smaller map and looks its keys up in the larger one.
+ *
+ * hmap_find returns a pointer to the value of a key, or NULL. The pointer,
+ * like those returned by hmap_next, is valid until the next put or remove.
+ * Keys and values are aligned for their sizes, to the greatest power of
+ * two that divides the size, up to the alignment of max_align_t, so they
+ * can be read and written through these pointers as the types they hold.
+ *
+ * hmap_new_with takes all the memory of the map from an allocator.
+ *
+ * hmap_stats returns the stats of the map, or NULL if DS_STATS is not
+ * defined. Lookups add their probe length to the histogram.
+ *
+ * Iterate over the map like this:
+ *
+ * unsigned long it = 0;
+ * void *key, *value;
+ * while (hmap_next(map, &it, &key, &value)) {
+ * }
+ */
+typedef struct HMap {
+	unsigned short *control;
+	unsigned char *entries;
+	unsigned long capacity;
+	unsigned long length;
+	unsigned short *old_control;
+	unsigned char *old_entries;
+	unsigned long old_capacity;
+	unsigned long old_start;
+	unsigned long old_done;
+	unsigned long key_size;
+	unsigned long value_size;
+	unsigned long value_offset;
+	unsigned long entry_size;
+	DSHash hash;
+	DSCompare compare;
+	const DSAllocator *allocator;
+	DS_STATS_MEMBER
+} HMap;
+
+
+HMap *hmap_new(
+		unsigned long capacity,
+		unsigned long key_size,
+		unsigned long value_size,
+		DSHash hash,
+		DSCompare compare);
+HMap *hmap_new_with(
+		const DSAllocator *allocator,
+		unsigned long capacity,
+		unsigned long key_size,
+		unsigned long value_size,
+		DSHash hash,
+		DSCompare compare);
+void hmap_delete(HMap *map);
+
+int hmap_put(HMap *map, const void *key, const void *value);
+int hmap_get(HMap *map, const void *key, void *out_value);
+void *hmap_find(HMap *map, const void *key);
+int hmap_contains(HMap *map, const void *key);
+int hmap_remove(HMap *map, const void *key);
+
+int hmap_next(HMap *map, unsigned long *iterator, void **out_key, void **out_value);
+
+void hmap_clear(HMap *map);
+
+const DSStats *hmap_stats(HMap *map);
+
+int hmap_union(AList *dst, HMap *a, HMap *b);
+int hmap_intersection(AList *dst, HMap *a, HMap *b);
+int hmap_difference(AList *dst, HMap *a, HMap *b);
+
+
+#endif  // __HMAP_H__
@@ -0,0 +1,228 @@
+#include "hmap.h"
+#include <assert.h>
+#include <stddef.h>
+#include <stdlib.h>
+#include <stdio.h>
+#include <time.h>
+#include <string.h>
+
+typedef struct Name {
+	char text[24];
+} Name;
+
+unsigned long hash_name(const Name *name) {
+	return ds_hash_bytes(name->text, strlen(name->text));
+}
+
+int compare_names(const Name *a, const Name *b) {
+	return strcmp(a->text, b->text);
+}
+
+unsigned long hash_int(const int *n) {
+	return ds_hash_ulong((unsigned long) *n);
+}
+
+int compare_ints(const int *a, const int *b) {
+	return *a - *b;
+}
+
+int main() {
+
+	{
+		HMap *map = hmap_new(0, sizeof(Name), sizeof(int), (DSHash) hash_name, (DSCompare) compare_names);
+		assert(map);
+		assert(map->length == 0);
+
+		for (int i = 0; i < 100; i++) {
+			Name name = { 0 };
+			snprintf(name.text, sizeof(name.text), "name %d", i);
+			int rval = hmap_put(map, &name, &i);
+			assert(rval == DS_OK);
+		}
+		assert(map->length == 100);
+		for (int i = 0; i < 100; i++) {
+			Name name = { 0 };
+			int n;
+			snprintf(name.text, sizeof(name.text), "name %d", i);
+			int rval = hmap_get(map, &name, &n);
+			assert(rval == DS_OK);
+			assert(n == i);
+		}
+		{
+			Name name = { "nobody" };
+			int n;
+			int rval = hmap_get(map, &name, &n);
+			assert(rval == DS_NOT_FOUND);
+			assert(hmap_find(map, &name) == NULL);
+			rval = hmap_remove(map, &name);
+			assert(rval == DS_NOT_FOUND);
+		}
+		{
+			Name name = { "name 7" };
+			int n = 77;
+			int rval = hmap_put(map, &name, &n);
+			assert(rval == DS_OK);
+			assert(map->length == 100);
+			assert(*(int *) hmap_find(map, &name) == 77);
+			rval = hmap_remove(map, &name);
+			assert(rval == DS_OK);
+			assert(map->length == 99);
+			assert(!hmap_contains(map, &name));
+		}
+		{
+			unsigned long it = 0;
+			unsigned long count = 0;
+			void *key;
+			void *value;
+			while (hmap_next(map, &it, &key, &value)) {
+				int n = atoi(((Name *) key)->text + 5);
+				assert(n == *(int *) value);
+				count++;
+			}
+			assert(count == 99);
+		}
+		hmap_clear(map);
+		assert(map->length == 0);
+		hmap_delete(map);
+	}
+
+	// hash set, random operations against a reference
+	{
+		HMap *set = hmap_new(16, sizeof(int), 0, (DSHash) hash_int, (DSCompare) compare_ints);
+		const int max_key = 5000;
+		char *reference = calloc(max_key, 1);
+		srand(time(NULL));
+		for (int op = 0; op < 100000; op++) {
+			int key = rand() % max_key;
+			if (rand() % 3) {
+				int rval = hmap_put(set, &key, NULL);
+				assert(rval == DS_OK);
+				reference[key] = 1;
+			}
+			else {
+				int rval = hmap_remove(set, &key);
+				assert(rval == (reference[key] ? DS_OK : DS_NOT_FOUND));
+				reference[key] = 0;
+			}
+			if (op % 1000 == 0) {
+				unsigned long length = 0;
+				for (int k = 0; k < max_key; k++) {
+					assert(hmap_contains(set, &k) == reference[k]);
+					length += reference[k];
+				}
+				assert(set->length == length);
+			}
+		}
+		free(reference);
+		hmap_delete(set);
+	}
+
+	// set operations
+	{
+		HMap *a = hmap_new(0, sizeof(int), 0, (DSHash) hash_int, (DSCompare) compare_ints);
+		HMap *b = hmap_new(0, sizeof(int), 0, (DSHash) hash_int, (DSCompare) compare_ints);
+		AList *dst = alist_new(1000, sizeof(int));
+		for (int i = 0; i < 100; i++) {
+			hmap_put(a, &i, NULL);
+		}
+		for (int i = 50; i < 1000; i += 2) {
+			hmap_put(b, &i, NULL);
+		}
+
+		int rval = hmap_union(dst, a, b);
+		assert(rval == DS_OK);
+		assert(dst->length == 100 + 475 - 25);
+
+		rval = hmap_intersection(dst, b, a);
+		assert(rval == DS_OK);
+		assert(dst->length == 25);
+		alist_sort(dst, (DSCompare) compare_ints);
+		for (unsigned long i = 0; i < dst->length; i++) {
+			int n;
+			alist_get(dst, i, &n);
+			assert(n == 50 + 2 * (int) i);
+		}
+
+		rval = hmap_difference(dst, a, b);
+		assert(rval == DS_OK);
+		assert(dst->length == 75);
+
+		AList *small = alist_new(10, sizeof(int));
+		rval = hmap_difference(small, a, b);
+		assert(rval == DS_OVERFLOW);
+		assert(small->length == 10);
+
+		alist_delete(small);
+		alist_delete(dst);
+		hmap_delete(a);
+		hmap_delete(b);
+	}
+
+	// keys of 24 bytes with long values, which are aligned all the same
+	{
+		HMap *map = hmap_new(0, sizeof(Name), sizeof(long), (DSHash) hash_name, (DSCompare) compare_names);
+		for (long i = 0; i < 1000; i++) {
+			Name name;
+			snprintf(name.text, sizeof(name.text), "k%ld", i);
+			assert(hmap_put(map, &name, &i) == DS_OK);
+		}
+		for (long i = 0; i < 1000; i++) {
+			Name name;
+			snprintf(name.text, sizeof(name.text), "k%ld", i);
+			long *value = hmap_find(map, &name);
+			assert(value);
+			assert((unsigned long) value % _Alignof(long) == 0);
+			assert(*value == i);
+			*value = -i;
+		}
+		unsigned long it = 0;
+		void *key, *value;
+		while (hmap_next(map, &it, &key, &value)) {
+			assert((unsigned long) key % 8 == 0);
+			assert(*(long *) value <= 0);
+		}
+		hmap_delete(map);
+	}
+
+	{
+		HMap *map = hmap_new(0, sizeof(int), sizeof(int), (DSHash) hash_int, (DSCompare) compare_ints);
+		for (int i = 0; i < 100; i++) {
+			assert(hmap_put(map, &i, &i) == DS_OK);
+		}
+		for (int i = 0; i < 200; i++) {
+			assert(hmap_contains(map, &i) == (i < 100));
+		}
+#ifdef DS_STATS
+		const DSStats *stats = hmap_stats(map);
+		unsigned long probes = 0;
+		assert(stats->ops == 300);
+		assert(stats->allocations >= 2);
+		assert(stats->allocations == stats->frees + 2 || map->old_control);
+		for (int i = 0; i < DS_STATS_BUCKETS; i++) {
+			probes += stats->histogram[i];
+		}
+		assert(probes > 0 && probes <= 300);
+		assert(stats->max_cost >= 1);
+#else
+		assert(hmap_stats(map) == NULL);
+#endif
+		hmap_delete(map);
+	}
+
+	// entries are only as wide as the alignment of their keys and values
+	{
+		HMap *map = hmap_new(0, sizeof(int), sizeof(int), (DSHash) hash_int, (DSCompare) compare_ints);
+		assert(map->value_offset == sizeof(int));
+		assert(map->entry_size == 2 * sizeof(int));
+		hmap_delete(map);
+		map = hmap_new(0, sizeof(long), sizeof(int), (DSHash) hash_int, (DSCompare) compare_ints);
+		assert(map->value_offset == sizeof(long));
+		assert(map->entry_size == 2 * sizeof(long));
+		hmap_delete(map);
+		map = hmap_new(0, sizeof(int), 0, (DSHash) hash_int, (DSCompare) compare_ints);
+		assert(map->entry_size == sizeof(int));
+		hmap_delete(map);
+	}
+
+	return 0;
+}
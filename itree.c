@@ -0,0 +1,367 @@
+#include "itree.h"
+#include <stddef.h>
+#include <stdlib.h>
+#include <string.h>
+
+#define ALIGN(n) (((n) + _Alignof(max_align_t) - 1) & ~(_Alignof(max_align_t) - 1))
+
+typedef struct ITNode {
+	struct ITNode *left;
+	struct ITNode *right;
+	long max;  // the greatest hi in the subtree
+	int height;
+} ITNode;
+
+#define HEADER_SIZE ALIGN(sizeof(ITNode))
+#define NODE_SIZE(tree) (HEADER_SIZE + (tree)->data_size)
+#define RECORD(node) ((unsigned char *) (node) + HEADER_SIZE)
+#define INTERVAL(node) ((const ITInterval *) RECORD(node))
+
+#define HEIGHT(node) ((node) ? (node)->height : 0)
+
+static int compare(ITree *tree, const void *a, const void *b);
+static ITNode *new_node(ITree *tree, const void *data);
+static long greatest_end(ITNode *node);
+static void update(ITNode *node);
+static void rotate_left(ITNode **link);
+static void rotate_right(ITNode **link);
+static void balance(ITNode **link);
+static void rebalance(ITNode ***path, int depth, int until);
+static int query(ITree *tree, long lo, long hi, AList *dst, unsigned long *out_count);
+static int check(ITree *tree, ITNode *node, const void *lo, const void *hi);
+
+
+ITree *it_new(unsigned long data_size) {
+	return it_new_with(NULL, data_size);
+}
+
+ITree *it_new_in(DSArena *arena, unsigned long data_size) {
+	return it_new_with(ds_arena_allocator(arena), data_size);
+}
+
+ITree *it_new_with(const DSAllocator *allocator, unsigned long data_size) {
+	ITree *tree;
+	if (data_size < sizeof(ITInterval)) {
+		return NULL;
+	}
+	tree = ds_alloc_with(allocator, sizeof(ITree));
+	if (!tree) {
+		return NULL;
+	}
+	tree->root = NULL;
+	tree->length = 0;
+	tree->data_size = data_size;
+	tree->allocator = allocator;
+#ifdef DS_STATS
+	ds_stats_reset(&tree->stats);
+	tree->stats.allocations = 1;
+#endif
+	return tree;
+}
+
+void it_delete(ITree *tree) {
+	if (tree) {
+		it_clear(tree);
+		ds_free_with(tree->allocator, tree, sizeof(ITree));
+	}
+}
+
+unsigned long it_length(ITree *tree) {
+	return tree->length;
+}
+
+// Records equal to others go to their right, after them in order.
+int it_insert(ITree *tree, const void *data) {
+	ITNode **path[DS_AVL_MAX_HEIGHT];
+	int depth = 0;
+	ITNode **link = &tree->root;
+	ITNode *node;
+	const ITInterval *interval = data;
+	DS_STAT(&tree->stats, ops, 1);
+	if (interval->lo > interval->hi) {
+		return DS_OUT_OF_BOUNDS;
+	}
+	while (*link) {
+		path[depth++] = link;
+		link = compare(tree, data, RECORD(*link)) < 0 ? &(*link)->left : &(*link)->right;
+	}
+	node = new_node(tree, data);
+	if (!node) {
+		return DS_MALLOC_ERROR;
+	}
+	*link = node;
+	tree->length++;
+	rebalance(path, depth, depth);
+	DS_STAT_COST(&tree->stats, (unsigned long) depth);
+	return DS_OK;
+}
+
+// A node with two children takes the record of its successor, whose node
+// is unlinked instead.
+int it_remove(ITree *tree, const void *data) {
+	ITNode **path[DS_AVL_MAX_HEIGHT];
+	int depth = 0;
+	int at;
+	ITNode **link = &tree->root;
+	ITNode *node;
+	DS_STAT(&tree->stats, ops, 1);
+	while (*link) {
+		int c = compare(tree, data, RECORD(*link));
+		if (c == 0) {
+			break;
+		}
+		path[depth++] = link;
+		link = c < 0 ? &(*link)->left : &(*link)->right;
+	}
+	if (!*link) {
+		return DS_NOT_FOUND;
+	}
+	node = *link;
+	at = depth;
+	if (node->left && node->right) {
+		ITNode **succ = &node->right;
+		path[depth++] = link;
+		while ((*succ)->left) {
+			path[depth++] = succ;
+			succ = &(*succ)->left;
+		}
+		memcpy(RECORD(node), RECORD(*succ), tree->data_size);
+		DS_STAT(&tree->stats, bytes_moved, tree->data_size);
+		link = succ;
+		node = *succ;
+	}
+	*link = node->left ? node->left : node->right;
+	ds_free_with(tree->allocator, node, NODE_SIZE(tree));
+	DS_STAT(&tree->stats, frees, 1);
+	tree->length--;
+	rebalance(path, depth, at);
+	DS_STAT_COST(&tree->stats, (unsigned long) depth);
+	return DS_OK;
+}
+
+int it_overlaps(ITree *tree, long lo, long hi, AList *dst) {
+	unsigned long count;
+	return query(tree, lo, hi, dst, &count);
+}
+
+int it_stab(ITree *tree, long point, AList *dst) {
+	unsigned long count;
+	return query(tree, point, point, dst, &count);
+}
+
+unsigned long it_count_overlaps(ITree *tree, long lo, long hi) {
+	unsigned long count;
+	query(tree, lo, hi, NULL, &count);
+	return count;
+}
+
+// Frees each node once its children are on the stack. The stack holds the
+// root, or the left children of the nodes on the way to the node freed.
+void it_clear(ITree *tree) {
+	ITNode *stack[DS_AVL_MAX_HEIGHT + 1];
+	int top = 0;
+	if (tree->root) {
+		stack[top++] = tree->root;
+	}
+	while (top > 0) {
+		ITNode *node = stack[--top];
+		if (node->left) {
+			stack[top++] = node->left;
+		}
+		if (node->right) {
+			stack[top++] = node->right;
+		}
+		ds_free_with(tree->allocator, node, NODE_SIZE(tree));
+		DS_STAT(&tree->stats, frees, 1);
+	}
+	tree->root = NULL;
+	tree->length = 0;
+}
+
+int it_check(ITree *tree) {
+	return check(tree, tree->root, NULL, NULL) >= 0;
+}
+
+
+static int compare(ITree *tree, const void *a, const void *b) {
+	const ITInterval *x = a;
+	const ITInterval *y = b;
+	DS_STAT(&tree->stats, compares, 1);
+	if (x->lo != y->lo) {
+		return x->lo < y->lo ? -1 : 1;
+	}
+	if (x->hi != y->hi) {
+		return x->hi < y->hi ? -1 : 1;
+	}
+	return memcmp(a, b, tree->data_size);
+}
+
+static ITNode *new_node(ITree *tree, const void *data) {
+	ITNode *node = ds_alloc_with(tree->allocator, NODE_SIZE(tree));
+	if (node) {
+		node->left = NULL;
+		node->right = NULL;
+		node->height = 1;
+		memcpy(RECORD(node), data, tree->data_size);
+		node->max = INTERVAL(node)->hi;
+		DS_STAT(&tree->stats, allocations, 1);
+		DS_STAT(&tree->stats, bytes_moved, tree->data_size);
+	}
+	return node;
+}
+
+// the end of the interval of node or the greatest end kept by a child
+static long greatest_end(ITNode *node) {
+	long max = INTERVAL(node)->hi;
+	if (node->left && node->left->max > max) {
+		max = node->left->max;
+	}
+	if (node->right && node->right->max > max) {
+		max = node->right->max;
+	}
+	return max;
+}
+
+static void update(ITNode *node) {
+	int left = HEIGHT(node->left);
+	int right = HEIGHT(node->right);
+	node->height = (left > right ? left : right) + 1;
+	node->max = greatest_end(node);
+}
+
+// A rotation changes the subtrees of only the node that goes down and the
+// one that comes up, so it updates those two, the lower one first.
+static void rotate_left(ITNode **link) {
+	ITNode *node = *link;
+	ITNode *right = node->right;
+	node->right = right->left;
+	right->left = node;
+	update(node);
+	update(right);
+	*link = right;
+}
+
+static void rotate_right(ITNode **link) {
+	ITNode *node = *link;
+	ITNode *left = node->left;
+	node->left = left->right;
+	left->right = node;
+	update(node);
+	update(left);
+	*link = left;
+}
+
+// Updates the node at link after one of its subtrees changed, and rotates
+// it if their heights now differ by 2.
+static void balance(ITNode **link) {
+	ITNode *node = *link;
+	int factor;
+	update(node);
+	factor = HEIGHT(node->right) - HEIGHT(node->left);
+	if (factor > 1) {
+		if (HEIGHT(node->right->right) < HEIGHT(node->right->left)) {
+			rotate_right(&node->right);
+		}
+		rotate_left(link);
+	}
+	else if (factor < -1) {
+		if (HEIGHT(node->left->left) < HEIGHT(node->left->right)) {
+			rotate_left(&node->left);
+		}
+		rotate_right(link);
+	}
+}
+
+// Balances the nodes at the links on the path from the bottom up. Above
+// the one at until, it stops at the first subtree whose root, height and
+// greatest end did not change, as nothing above it changes either.
+static void rebalance(ITNode ***path, int depth, int until) {
+	while (depth-- > 0) {
+		ITNode *node = *path[depth];
+		int height = node->height;
+		long max = node->max;
+		balance(path[depth]);
+		if (depth < until && *path[depth] == node && node->height == height && node->max == max) {
+			break;
+		}
+	}
+}
+
+// Walks the tree in order, skipping the subtrees whose greatest end is
+// before lo, and stops at the first record that starts after hi. Copies the
+// records found to dst, if it is not NULL.
+static int query(ITree *tree, long lo, long hi, AList *dst, unsigned long *out_count) {
+	ITNode *stack[DS_AVL_MAX_HEIGHT];
+	int top = 0;
+	ITNode *node = tree->root;
+	unsigned long count = 0;
+	unsigned long visited = 0;
+	DS_STAT(&tree->stats, ops, 1);
+	if (dst) {
+		dst->length = 0;
+	}
+	for (;;) {
+		while (node && node->max >= lo) {
+			stack[top++] = node;
+			node = node->left;
+		}
+		if (top == 0) {
+			break;
+		}
+		node = stack[--top];
+		visited++;
+		if (INTERVAL(node)->lo > hi) {
+			break;
+		}
+		if (INTERVAL(node)->hi >= lo) {
+			if (dst) {
+				if (count == dst->max_length) {
+					dst->length = count;
+					*out_count = count;
+					return DS_OVERFLOW;
+				}
+				memcpy(dst->array + count * dst->data_size, RECORD(node), tree->data_size);
+			}
+			count++;
+		}
+		node = node->right;
+	}
+	DS_STAT(&tree->stats, compares, visited);
+	DS_STAT_COST(&tree->stats, visited);
+	if (dst) {
+		dst->length = count;
+		DS_STAT(&tree->stats, bytes_moved, count * tree->data_size);
+	}
+	*out_count = count;
+	return DS_OK;
+}
+
+// Returns the height of the subtree, or -1 if an interval in it is empty,
+// a record is out of the bounds lo and hi set by the nodes above, a node is
+// out of balance, or a height or a greatest end kept in a node is wrong.
+// The bounds are inclusive, as equal records can end up on both sides of
+// each other after rotations.
+static int check(ITree *tree, ITNode *node, const void *lo, const void *hi) {
+	int left, right;
+	if (!node) {
+		return 0;
+	}
+	if (INTERVAL(node)->lo > INTERVAL(node)->hi) {
+		return -1;
+	}
+	if ((lo && compare(tree, RECORD(node), lo) < 0) || (hi && compare(tree, RECORD(node), hi) > 0)) {
+		return -1;
+	}
+	left = check(tree, node->left, lo, RECORD(node));
+	right = check(tree, node->right, RECORD(node), hi);
+	if (left < 0 || right < 0 || left - right > 1 || right - left > 1) {
+		return -1;
+	}
+	if (node->height != (left > right ? left : right) + 1) {
+		return -1;
+	}
+	if (node->max != greatest_end(node)) {
+		return -1;
+	}
+	return node->height;
+}
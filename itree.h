@@ -0,0 +1,75 @@
+#ifndef __ITREE_H__
+#define __ITREE_H__
+
+#include "alist.h"
+
+/*
+ * Interval Tree
+ * AVL tree of records of data_size bytes that start with an ITInterval, a
+ * closed range [lo, hi] of longs, as time ranges, ordered by lo, then by
+ * hi, then byte for byte. Each node keeps the greatest hi in its subtree,
+ * so that queries skip the subtrees where no interval reaches that far,
+ * instead of scanning all the intervals that start before the query ends.
+ * Insert and remove are O(log n), and a query that finds k intervals
+ * visits O((k + 1) log n) nodes.
+ *
+ * typedef struct Event {
+ *     ITInterval when;
+ *     int id;
+ * } Event;
+ *
+ * ITree *tree = it_new(sizeof(Event));
+ * Event event = { { 10, 20 }, 1 };
+ * it_insert(tree, &event);
+ *
+ * Several records may have the same interval, and the same bytes.
+ * it_insert returns DS_OUT_OF_BOUNDS if lo is greater than hi. it_remove
+ * removes one record equal to data, byte for byte, or returns
+ * DS_NOT_FOUND.
+ *
+ * it_overlaps copies the records whose intervals overlap [lo, hi] to dst,
+ * in order, and it_stab those whose intervals hold point. Both clear dst,
+ * which must have the same data_size as the tree, and return DS_OVERFLOW
+ * if the records do not fit. it_count_overlaps counts them without copying.
+ *
+ * The nodes are allocated one by one, and records are copied in and out,
+ * so pointers into the tree are never handed out.
+ *
+ * it_check returns 1 if the tree is ordered and balanced and its heights
+ * and greatest ends are right, 0 otherwise.
+ */
+typedef struct ITInterval {
+	long lo;
+	long hi;
+} ITInterval;
+
+struct ITNode;
+
+typedef struct ITree {
+	struct ITNode *root;
+	unsigned long length;
+	unsigned long data_size;
+	const DSAllocator *allocator;
+	DS_STATS_MEMBER
+} ITree;
+
+
+ITree *it_new(unsigned long data_size);
+ITree *it_new_in(DSArena *arena, unsigned long data_size);
+ITree *it_new_with(const DSAllocator *allocator, unsigned long data_size);
+void it_delete(ITree *tree);
+
+unsigned long it_length(ITree *tree);
+
+int it_insert(ITree *tree, const void *data);
+int it_remove(ITree *tree, const void *data);
+
+int it_overlaps(ITree *tree, long lo, long hi, AList *dst);
+int it_stab(ITree *tree, long point, AList *dst);
+unsigned long it_count_overlaps(ITree *tree, long lo, long hi);
+
+void it_clear(ITree *tree);
+int it_check(ITree *tree);
+
+
+#endif  // __ITREE_H__
@@ -0,0 +1,160 @@
+#include "itree.h"
+#include <assert.h>
+#include <stdlib.h>
+#include <stdio.h>
+#include <string.h>
+
+#define MAX_LENGTH 3000
+#define RANGE 10000
+
+typedef struct Event {
+	ITInterval when;
+	int id;
+} Event;
+
+// the events of the reference array that overlap [lo, hi], by brute force
+unsigned long count_overlaps(const Event *events, unsigned long length, long lo, long hi) {
+	unsigned long count = 0;
+	for (unsigned long i = 0; i < length; i++) {
+		count += events[i].when.lo <= hi && events[i].when.hi >= lo;
+	}
+	return count;
+}
+
+// checks that the query found exactly the overlapping events, in order
+void check_query(ITree *tree, const Event *events, unsigned long length, long lo, long hi, AList *found) {
+	assert(it_overlaps(tree, lo, hi, found) == DS_OK);
+	assert(found->length == count_overlaps(events, length, lo, hi));
+	assert(it_count_overlaps(tree, lo, hi) == found->length);
+	for (unsigned long i = 0; i < found->length; i++) {
+		Event *event = (Event *) found->array + i;
+		assert(event->when.lo <= hi && event->when.hi >= lo);
+		if (i > 0) {
+			assert(event[-1].when.lo <= event->when.lo);
+		}
+		int present = 0;
+		for (unsigned long j = 0; j < length && !present; j++) {
+			present = memcmp(&events[j], event, sizeof(Event)) == 0;
+		}
+		assert(present);
+	}
+}
+
+int main() {
+	srand(5);
+
+	// random inserts and removes against an array, queries checked by brute force
+	{
+		static Event events[MAX_LENGTH];
+		unsigned long length = 0;
+		ITree *tree = it_new(sizeof(Event));
+		AList *found = alist_new(MAX_LENGTH, sizeof(Event));
+		Event event;
+		memset(&event, 0, sizeof(Event));
+		assert(it_new(sizeof(long)) == NULL);
+		assert(it_length(tree) == 0);
+		assert(it_stab(tree, 0, found) == DS_OK && found->length == 0);
+		event.when.lo = 2;
+		event.when.hi = 1;
+		assert(it_insert(tree, &event) == DS_OUT_OF_BOUNDS);
+		assert(it_remove(tree, &event) == DS_NOT_FOUND);
+
+		for (int it = 0; it < 20000; it++) {
+			if (length < MAX_LENGTH && (length == 0 || rand() % 3)) {
+				memset(&event, 0, sizeof(Event));
+				event.when.lo = rand() % RANGE;
+				// mostly short ranges, some long ones
+				event.when.hi = event.when.lo + (rand() % 10 == 0 ? rand() % RANGE : rand() % 50);
+				event.id = rand() % 4;
+				assert(it_insert(tree, &event) == DS_OK);
+				events[length++] = event;
+			}
+			else {
+				unsigned long i = (unsigned long) rand() % length;
+				assert(it_remove(tree, &events[i]) == DS_OK);
+				events[i] = events[--length];
+			}
+			assert(it_length(tree) == length);
+			if (it % 500 == 0) {
+				assert(it_check(tree));
+				for (int q = 0; q < 20; q++) {
+					long lo = rand() % RANGE;
+					check_query(tree, events, length, lo, lo + rand() % 100, found);
+					check_query(tree, events, length, lo, lo, found);
+				}
+			}
+		}
+		assert(it_check(tree));
+
+		// stabbing
+		long point = events[0].when.lo;
+		assert(it_stab(tree, point, found) == DS_OK);
+		assert(found->length == count_overlaps(events, length, point, point));
+		assert(found->length > 0);
+
+		// everything, and a dst too small
+		assert(it_overlaps(tree, -1, RANGE * 2, found) == DS_OK);
+		assert(found->length == length);
+		AList *small = alist_new(10, sizeof(Event));
+		assert(it_overlaps(tree, -1, RANGE * 2, small) == DS_OVERFLOW);
+		assert(small->length == 10);
+		assert(memcmp(small->array, found->array, 10 * sizeof(Event)) == 0);
+		alist_delete(small);
+
+		// the same event twice is two records
+		event = events[0];
+		assert(it_insert(tree, &event) == DS_OK);
+		assert(it_count_overlaps(tree, event.when.lo, event.when.lo) == count_overlaps(events, length, event.when.lo, event.when.lo) + 1);
+		assert(it_remove(tree, &event) == DS_OK);
+		assert(it_remove(tree, &event) == DS_OK);
+		assert(it_length(tree) == length - 1);
+		assert(it_check(tree));
+
+		it_clear(tree);
+		assert(it_length(tree) == 0);
+		assert(it_count_overlaps(tree, 0, RANGE) == 0);
+		alist_delete(found);
+		it_delete(tree);
+	}
+
+	// in order down to empty
+	{
+		ITree *tree = it_new(sizeof(ITInterval));
+		for (long i = 0; i < 1000; i++) {
+			ITInterval interval = { i, i + 10 };
+			assert(it_insert(tree, &interval) == DS_OK);
+		}
+		assert(it_check(tree));
+		assert(it_count_overlaps(tree, 500, 500) == 11);
+		assert(it_count_overlaps(tree, 2000, 3000) == 0);
+		assert(it_count_overlaps(tree, -100, -1) == 0);
+		for (long i = 0; i < 1000; i++) {
+			ITInterval interval = { (i * 7) % 1000, (i * 7) % 1000 + 10 };
+			assert(it_remove(tree, &interval) == DS_OK);
+			assert(it_check(tree));
+		}
+		assert(it_length(tree) == 0);
+		it_delete(tree);
+	}
+
+	// from an arena
+	{
+		DSArena *arena = ds_arena_new(1 << 16);
+		ITree *tree = it_new_in(arena, sizeof(Event));
+		for (int i = 0; i < 100; i++) {
+			Event event = { { i * 10, i * 10 + 15 }, i };
+			assert(it_insert(tree, &event) == DS_OK);
+		}
+		AList *found = alist_new_in(arena, 10, sizeof(Event));
+		assert(it_stab(tree, 507, found) == DS_OK);
+		assert(found->length == 1);
+		assert(((Event *) found->array)[0].id == 50);
+		assert(it_stab(tree, 505, found) == DS_OK);
+		assert(found->length == 2);
+		assert(((Event *) found->array)[0].id == 49);
+		it_delete(tree);
+		ds_arena_delete(arena);
+	}
+
+	return 0;
+}
@@ -5,6 +5,10 @@
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
+#include "commons.h"
+#if defined(__linux__)
+#include <sys/mman.h>
+#endif
 
 /*
  * Array List
@@ -58,15 +62,15 @@
 		int length;														\
 	} List_##Type;														\
 																		\
-	void al_##Type##_push(List_##Type *list, Type elm) {				\
+	static inline void al_##Type##_push(List_##Type *list, Type elm) {			\
 		list->elms[list->length++] = elm;								\
 	}																	\
 																		\
-	Type al_##Type##_pop(List_##Type *list) {							\
+	static inline Type al_##Type##_pop(List_##Type *list) {						\
 		return list->elms[--list->length];								\
 	}																	\
 																		\
-	void al_##Type##_insert(List_##Type *list, int index, Type elm) {	\
+	static inline void al_##Type##_insert(List_##Type *list, int index, Type elm) {	\
 		for (int i = list->length; i > index; i--) {					\
 			list->elms[i] = list->elms[i-1];							\
 		}																\
@@ -74,22 +78,22 @@
 		list->length += 1;												\
 	}																	\
 																		\
-	void al_##Type##_remove(List_##Type *list, int index) {				\
+	static inline void al_##Type##_remove(List_##Type *list, int index) {		\
 		for (int i = index; i < list->length; i++) {					\
 			list->elms[i] = list->elms[i+1];							\
 		}																\
 		list->length -= 1;												\
 	}																	\
 																		\
-	void al_##Type##_set(List_##Type *list, int index, Type elm) {		\
+	static inline void al_##Type##_set(List_##Type *list, int index, Type elm) {	\
 		list->elms[index] = elm;										\
 	}																	\
 																		\
-	Type al_##Type##_get(List_##Type *list, int index) {				\
+	static inline Type al_##Type##_get(List_##Type *list, int index) {			\
 		return list->elms[index];										\
 	}																	\
 																		\
-	void al_##Type##_clear(List_##Type *list) {							\
+	static inline void al_##Type##_clear(List_##Type *list) {					\
 		list->length = 0;												\
 	}
 
@@ -102,15 +106,15 @@
 		int length;														\
 	} List_##Type##_ptr;												\
 																		\
-	void al_##Type##_ptr_push(List_##Type##_ptr *list, Type *elm) {		\
+	static inline void al_##Type##_ptr_push(List_##Type##_ptr *list, Type *elm) {	\
 		list->elms[list->length++] = elm;								\
 	}																	\
 																		\
-	Type *al_##Type##_ptr_pop(List_##Type##_ptr *list) {				\
+	static inline Type *al_##Type##_ptr_pop(List_##Type##_ptr *list) {			\
 		return list->elms[--list->length];								\
 	}																	\
 																		\
-	void al_##Type##_ptr_insert(List_##Type##_ptr *list, int index, Type *elm) {	\
+	static inline void al_##Type##_ptr_insert(List_##Type##_ptr *list, int index, Type *elm) {	\
 		for (int i = list->length; i > index; i--) {					\
 			list->elms[i] = list->elms[i-1];							\
 		}																\
@@ -118,22 +122,22 @@
 		list->length += 1;												\
 	}																	\
 																		\
-	void al_##Type##_ptr_remove(List_##Type##_ptr *list, int index) {	\
+	static inline void al_##Type##_ptr_remove(List_##Type##_ptr *list, int index) {	\
 		for (int i = index; i < list->length; i++) {					\
 			list->elms[i] = list->elms[i+1];							\
 		}																\
 		list->length -= 1;												\
 	}																	\
 																		\
-	void al_##Type##_ptr_set(List_##Type##_ptr *list, int index, Type *elm) {		\
+	static inline void al_##Type##_ptr_set(List_##Type##_ptr *list, int index, Type *elm) {	\
 		list->elms[index] = elm;										\
 	}																	\
 																		\
-	Type *al_##Type##_ptr_get(List_##Type##_ptr *list, int index) {		\
+	static inline Type *al_##Type##_ptr_get(List_##Type##_ptr *list, int index) {	\
 		return list->elms[index];										\
 	}																	\
 																		\
-	void al_##Type##_ptr_clear(List_##Type##_ptr *list) {				\
+	static inline void al_##Type##_ptr_clear(List_##Type##_ptr *list) {			\
 		list->length = 0;												\
 	}
 		
@@ -217,31 +221,31 @@
 		int tail;														\
 	} CList_##Type;														\
 																		\
-	int cl_##Type##_index(int index) {									\
+	static inline int cl_##Type##_index(int index) {							\
 		return (index % size + size) % size;							\
 	}																	\
 																		\
-	int cl_##Type##_length(CList_##Type *list) {						\
+	static inline int cl_##Type##_length(CList_##Type *list) {					\
 		return list->tail - list->head;									\
 	}																	\
 																		\
-	void cl_##Type##_push_tail(CList_##Type *list, Type elm) {			\
+	static inline void cl_##Type##_push_tail(CList_##Type *list, Type elm) {	\
 		list->elms[cl_##Type##_index(list->tail++)] = elm;				\
 	}																	\
 																		\
-	Type cl_##Type##_pop_tail(CList_##Type *list) {						\
+	static inline Type cl_##Type##_pop_tail(CList_##Type *list) {				\
 		return list->elms[cl_##Type##_index(--list->tail)];				\
 	}																	\
 																		\
-	void cl_##Type##_push_head(CList_##Type *list, Type elm) {			\
+	static inline void cl_##Type##_push_head(CList_##Type *list, Type elm) {	\
 		list->elms[cl_##Type##_index(--list->head)] = elm;				\
 	}																	\
 																		\
-	Type cl_##Type##_pop_head(CList_##Type *list) {						\
+	static inline Type cl_##Type##_pop_head(CList_##Type *list) {				\
 		return list->elms[cl_##Type##_index(list->head++)];				\
 	}																	\
 																		\
-	void cl_##Type##_insert(CList_##Type *list, int index, Type elm) {	\
+	static inline void cl_##Type##_insert(CList_##Type *list, int index, Type elm) {	\
 		for (int i = cl_##Type##_length(list); i > index; i--) {		\
 			list->elms[cl_##Type##_index(list->head + i)] = list->elms[cl_##Type##_index(list->head + i - 1)];	\
 		}																\
@@ -249,22 +253,22 @@
 		list->tail += 1;												\
 	}																	\
 																		\
-	void cl_##Type##_remove(CList_##Type *list, int index) {			\
+	static inline void cl_##Type##_remove(CList_##Type *list, int index) {		\
 		for (int i = index; i < cl_##Type##_length(list); i++) {		\
 			list->elms[cl_##Type##_index(list->head + i)] = list->elms[cl_##Type##_index(list->head + i + 1)];	\
 		}																\
 		list->tail -= 1;												\
 	}																	\
 																		\
-	void cl_##Type##_set(CList_##Type *list, int index, Type elm) {		\
+	static inline void cl_##Type##_set(CList_##Type *list, int index, Type elm) {	\
 		list->elms[cl_##Type##_index(list->head + index)] = elm;					\
 	}																	\
 																		\
-	Type cl_##Type##_get(CList_##Type *list, int index) {				\
+	static inline Type cl_##Type##_get(CList_##Type *list, int index) {			\
 		return list->elms[cl_##Type##_index(list->head + index)];					\
 	}																	\
 																		\
-	void cl_##Type##_clear(CList_##Type *list) {						\
+	static inline void cl_##Type##_clear(CList_##Type *list) {					\
 		list->head = 0;													\
 		list->tail = 0;													\
 	}
@@ -276,31 +280,31 @@
 		int tail;														\
 	} CList_##Type##_ptr;														\
 																		\
-	int cl_##Type##_ptr_index(int index) {									\
+	static inline int cl_##Type##_ptr_index(int index) {						\
 		return (index % size + size) % size;							\
 	}																	\
 																		\
-	int cl_##Type##_ptr_length(CList_##Type##_ptr *list) {						\
+	static inline int cl_##Type##_ptr_length(CList_##Type##_ptr *list) {		\
 		return list->tail - list->head;									\
 	}																	\
 																		\
-	void cl_##Type##_ptr_push_tail(CList_##Type##_ptr *list, Type *elm) {			\
+	static inline void cl_##Type##_ptr_push_tail(CList_##Type##_ptr *list, Type *elm) {	\
 		list->elms[cl_##Type##_ptr_index(list->tail++)] = elm;				\
 	}																	\
 																		\
-	Type *cl_##Type##_ptr_pop_tail(CList_##Type##_ptr *list) {						\
+	static inline Type *cl_##Type##_ptr_pop_tail(CList_##Type##_ptr *list) {	\
 		return list->elms[cl_##Type##_ptr_index(--list->tail)];				\
 	}																	\
 																		\
-	void cl_##Type##_ptr_push_head(CList_##Type##_ptr *list, Type *elm) {			\
+	static inline void cl_##Type##_ptr_push_head(CList_##Type##_ptr *list, Type *elm) {	\
 		list->elms[cl_##Type##_ptr_index(--list->head)] = elm;				\
 	}																	\
 																		\
-	Type *cl_##Type##_ptr_pop_head(CList_##Type##_ptr *list) {						\
+	static inline Type *cl_##Type##_ptr_pop_head(CList_##Type##_ptr *list) {	\
 		return list->elms[cl_##Type##_ptr_index(list->head++)];				\
 	}																	\
 																		\
-	void cl_##Type##_ptr_insert(CList_##Type##_ptr *list, int index, Type *elm) {	\
+	static inline void cl_##Type##_ptr_insert(CList_##Type##_ptr *list, int index, Type *elm) {	\
 		for (int i = cl_##Type##_ptr_length(list); i > index; i--) {		\
 			list->elms[cl_##Type##_ptr_index(list->head + i)] = list->elms[cl_##Type##_ptr_index(list->head + i - 1)];	\
 		}																\
@@ -308,22 +312,22 @@
 		list->tail += 1;												\
 	}																	\
 																		\
-	void cl_##Type##_ptr_remove(CList_##Type##_ptr *list, int index) {			\
+	static inline void cl_##Type##_ptr_remove(CList_##Type##_ptr *list, int index) {	\
 		for (int i = index; i < cl_##Type##_ptr_length(list); i++) {		\
 			list->elms[cl_##Type##_ptr_index(list->head + i)] = list->elms[cl_##Type##_ptr_index(list->head + i + 1)];	\
 		}																\
 		list->tail -= 1;												\
 	}																	\
 																		\
-	void cl_##Type##_ptr_set(CList_##Type##_ptr *list, int index, Type *elm) {		\
+	static inline void cl_##Type##_ptr_set(CList_##Type##_ptr *list, int index, Type *elm) {	\
 		list->elms[cl_##Type##_ptr_index(list->head + index)] = elm;					\
 	}																	\
 																		\
-	Type *cl_##Type##_ptr_get(CList_##Type##_ptr *list, int index) {				\
+	static inline Type *cl_##Type##_ptr_get(CList_##Type##_ptr *list, int index) {	\
 		return list->elms[cl_##Type##_ptr_index(list->head + index)];					\
 	}																	\
 																		\
-	void cl_##Type##_ptr_clear(CList_##Type##_ptr *list) {						\
+	static inline void cl_##Type##_ptr_clear(CList_##Type##_ptr *list) {		\
 		list->head = 0;													\
 		list->tail = 0;													\
 	}
@@ -337,23 +341,23 @@
 		int length;															\
 	} Stack_##Type;															\
 																			\
-	int st_##Type##_length(Stack_##Type *stack) {						\
+	static inline int st_##Type##_length(Stack_##Type *stack) {					\
 		return stack->length;									\
 	}																	\
 																		\
-	void st_##Type##_push(Stack_##Type *stack, Type elm) {					\
+	static inline void st_##Type##_push(Stack_##Type *stack, Type elm) {		\
 		stack->elms[stack->length++] = elm;								\
 	}																		\
 																			\
-	Type st_##Type##_pop(Stack_##Type *stack) {								\
+	static inline Type st_##Type##_pop(Stack_##Type *stack) {					\
 		return stack->elms[--stack->length];								\
 	}																		\
 																			\
-	Type st_##Type##_peek(Stack_##Type *stack) {							\
+	static inline Type st_##Type##_peek(Stack_##Type *stack) {					\
 		return stack->elms[stack->length - 1];								\
 	}																		\
 																			\
-	int st_##Type##_clear(Stack_##Type *stack) {							\
+	static inline void st_##Type##_clear(Stack_##Type *stack) {					\
 		stack->length = 0;													\
 	}																		\
 
@@ -363,23 +367,23 @@
 		int length;															\
 	} Stack_##Type##_ptr;													\
 																			\
-	int st_##Type##_ptr_length(Stack_##Type##_ptr *stack) {						\
+	static inline int st_##Type##_ptr_length(Stack_##Type##_ptr *stack) {		\
 		return stack->length;												\
 	}																		\
 																			\
-	void st_##Type##_ptr_push(Stack_##Type##_ptr *stack, Type *elm) {				\
+	static inline void st_##Type##_ptr_push(Stack_##Type##_ptr *stack, Type *elm) {	\
 		stack->elms[stack->length++] = elm;									\
 	}																		\
 																			\
-	Type *st_##Type##_ptr_pop(Stack_##Type##_ptr *stack) {						\
+	static inline Type *st_##Type##_ptr_pop(Stack_##Type##_ptr *stack) {		\
 		return stack->elms[--stack->length];								\
 	}																		\
 																			\
-	Type *st_##Type##_ptr_peek(Stack_##Type##_ptr *stack) {						\
+	static inline Type *st_##Type##_ptr_peek(Stack_##Type##_ptr *stack) {		\
 		return stack->elms[stack->length - 1];								\
 	}																		\
 																			\
-	int st_##Type##_ptr_clear(Stack_##Type##_ptr *stack) {						\
+	static inline void st_##Type##_ptr_clear(Stack_##Type##_ptr *stack) {		\
 		stack->length = 0;													\
 	}																		\
 
@@ -394,23 +398,23 @@
 		int tail;															\
 	} Queue_##Type;															\
 																			\
-	int qu_##Type##_length(Queue_##Type *queue) {							\
+	static inline int qu_##Type##_length(Queue_##Type *queue) {					\
 		return queue->tail - queue->head;									\
 	}																		\
 																			\
-	void qu_##Type##_push(Queue_##Type *queue, Type elm) {					\
+	static inline void qu_##Type##_push(Queue_##Type *queue, Type elm) {		\
 		queue->elms[queue->tail++ % size] = elm;							\
 	}																		\
 																			\
-	Type qu_##Type##_pop(Queue_##Type *queue) {								\
+	static inline Type qu_##Type##_pop(Queue_##Type *queue) {					\
 		return queue->elms[queue->head++ % size];							\
 	}																		\
 																			\
-	Type qu_##Type##_peek(Queue_##Type *queue) {							\
+	static inline Type qu_##Type##_peek(Queue_##Type *queue) {					\
 		return queue->elms[queue->head % size];								\
 	}																		\
 																			\
-	int qu_##Type##_clear(Queue_##Type *queue) {							\
+	static inline void qu_##Type##_clear(Queue_##Type *queue) {					\
 		queue->head = 0;													\
 		queue->tail = 0;													\
 	}																		\
@@ -422,28 +426,697 @@
 		int tail;															\
 	} Queue_##Type##_ptr;													\
 																			\
-	int qu_##Type##_ptr_length(Queue_##Type##_ptr *queue) {						\
+	static inline int qu_##Type##_ptr_length(Queue_##Type##_ptr *queue) {		\
 		return queue->tail - queue->head;									\
 	}																		\
 																			\
-	void qu_##Type##_ptr_push(Queue_##Type##_ptr *queue, Type *elm) {				\
+	static inline void qu_##Type##_ptr_push(Queue_##Type##_ptr *queue, Type *elm) {	\
 		queue->elms[queue->tail++ % size] = elm;							\
 	}																		\
 																			\
-	Type *qu_##Type##_ptr_pop(Queue_##Type##_ptr *queue) {						\
+	static inline Type *qu_##Type##_ptr_pop(Queue_##Type##_ptr *queue) {		\
 		return queue->elms[queue->head++ % size];							\
 	}																		\
 																			\
-	Type *qu_##Type##_ptr_peek(Queue_##Type##_ptr *queue) {						\
+	static inline Type *qu_##Type##_ptr_peek(Queue_##Type##_ptr *queue) {		\
 		return queue->elms[queue->head % size];								\
 	}																		\
 																			\
-	int qu_##Type##_ptr_clear(Queue_##Type##_ptr *queue) {						\
+	static inline void qu_##Type##_ptr_clear(Queue_##Type##_ptr *queue) {		\
 		queue->head = 0;													\
 		queue->tail = 0;													\
 	}																		\
 
 
+/*
+ * Heap
+ * Generic, simple, fast, unsafe priority queue.
+ * No memory is allocated.
+ * The heap has a fixed size, and boundaries are not checked.
+ *
+ * This is a min heap with four children for each node instead of two, so
+ * that the children of a node are next to each other in memory and the heap
+ * is half as tall. The element at the top is the least according to Compare,
+ * a function int Compare(const Type *a, const Type *b) that returns <0 if
+ * a<b, 0 if a==b and >0 if a>b. Push and pop are O(log n) and peek is O(1).
+ *
+ * Each element pushed gets a handle, an int lesser than size, that stays
+ * valid until the element is popped or removed, wherever the element moves
+ * in the heap. Use it to change the priority of the element with update
+ * (decrease-key or increase-key), to read it with get or to remove it.
+ * Handles are reused.
+ *
+ * The function heapify replaces the contents of the heap with an array in
+ * O(n). The element at index i of the array gets the handle i.
+ *
+ * Prepare the heap by using the macro DEFINE_HEAP. The first parameter is
+ * the type of the element, the second is the max size of the heap and the
+ * third is the compare function. An empty heap is a zeroed Heap_<type>.
+ *
+ * DEFINE_HEAP(int, 1024, compare_ints)
+ * Heap_int
+ * hp_int_length		(heap)					-> int
+ * hp_int_push			(heap, elm)				-> handle
+ * hp_int_pop			(heap)					-> elm
+ * hp_int_peek			(heap)					-> elm
+ * hp_int_heapify		(heap, array, length)
+ * hp_int_get			(heap, handle)			-> elm
+ * hp_int_update		(heap, handle, elm)
+ * hp_int_remove		(heap, handle)
+ * hp_int_clear			(heap)
+ *
+ * Members of the heap:
+ * - elms: the elements in heap order.
+ * - length: the number of elements. Do not change this value.
+ *
+ */
+#define DEFINE_HEAP(Type, size, Compare)										\
+	typedef struct Heap_##Type {												\
+		Type elms[size];														\
+		int handles[size];														\
+		int positions[size];													\
+		int length;																\
+		int used;																\
+	} Heap_##Type;																\
+																				\
+	static inline int hp_##Type##_length(Heap_##Type *heap) {					\
+		return heap->length;													\
+	}																			\
+																				\
+	static inline void hp_##Type##_place(Heap_##Type *heap, int index, Type elm, int handle) {	\
+		heap->elms[index] = elm;												\
+		heap->handles[index] = handle;											\
+		heap->positions[handle] = index;										\
+	}																			\
+																				\
+	static inline void hp_##Type##_sift_up(Heap_##Type *heap, int index) {		\
+		Type elm = heap->elms[index];											\
+		int handle = heap->handles[index];										\
+		while (index > 0) {														\
+			int parent = (index - 1) >> 2;										\
+			if (Compare(&elm, &heap->elms[parent]) >= 0) {						\
+				break;															\
+			}																	\
+			hp_##Type##_place(heap, index, heap->elms[parent], heap->handles[parent]);	\
+			index = parent;														\
+		}																		\
+		hp_##Type##_place(heap, index, elm, handle);							\
+	}																			\
+																				\
+	static inline void hp_##Type##_sift_down(Heap_##Type *heap, int index) {	\
+		Type elm = heap->elms[index];											\
+		int handle = heap->handles[index];										\
+		for (;;) {																\
+			int first = 4 * index + 1;											\
+			int last = first + 4 < heap->length ? first + 4 : heap->length;		\
+			int child = first;													\
+			if (first >= heap->length) {										\
+				break;															\
+			}																	\
+			for (int i = first + 1; i < last; i++) {							\
+				if (Compare(&heap->elms[i], &heap->elms[child]) < 0) {			\
+					child = i;													\
+				}																\
+			}																	\
+			if (Compare(&heap->elms[child], &elm) >= 0) {						\
+				break;															\
+			}																	\
+			hp_##Type##_place(heap, index, heap->elms[child], heap->handles[child]);	\
+			index = child;														\
+		}																		\
+		hp_##Type##_place(heap, index, elm, handle);							\
+	}																			\
+																				\
+	static inline void hp_##Type##_sift(Heap_##Type *heap, int index) {			\
+		if (index > 0 && Compare(&heap->elms[index], &heap->elms[(index - 1) >> 2]) < 0) {	\
+			hp_##Type##_sift_up(heap, index);									\
+		}																		\
+		else {																	\
+			hp_##Type##_sift_down(heap, index);									\
+		}																		\
+	}																			\
+																				\
+	static inline int hp_##Type##_push(Heap_##Type *heap, Type elm) {			\
+		int index = heap->length++;												\
+		int handle;																\
+		if (index == heap->used) {												\
+			heap->handles[index] = heap->used++;								\
+		}																		\
+		handle = heap->handles[index];											\
+		hp_##Type##_place(heap, index, elm, handle);							\
+		hp_##Type##_sift_up(heap, index);										\
+		return handle;															\
+	}																			\
+																				\
+	static inline void hp_##Type##_remove_at(Heap_##Type *heap, int index) {	\
+		int last = --heap->length;												\
+		if (index != last) {													\
+			int handle = heap->handles[index];									\
+			hp_##Type##_place(heap, index, heap->elms[last], heap->handles[last]);	\
+			heap->handles[last] = handle;										\
+			heap->positions[handle] = last;										\
+			hp_##Type##_sift(heap, index);										\
+		}																		\
+	}																			\
+																				\
+	static inline Type hp_##Type##_pop(Heap_##Type *heap) {						\
+		Type elm = heap->elms[0];												\
+		hp_##Type##_remove_at(heap, 0);											\
+		return elm;																\
+	}																			\
+																				\
+	static inline Type hp_##Type##_peek(Heap_##Type *heap) {					\
+		return heap->elms[0];													\
+	}																			\
+																				\
+	static inline void hp_##Type##_heapify(Heap_##Type *heap, const Type *array, int length) {	\
+		if (heap->used < length) {												\
+			heap->used = length;												\
+		}																		\
+		for (int i = 0; i < heap->used; i++) {									\
+			heap->handles[i] = i;												\
+			heap->positions[i] = i;												\
+		}																		\
+		for (int i = 0; i < length; i++) {										\
+			heap->elms[i] = array[i];											\
+		}																		\
+		heap->length = length;													\
+		for (int i = (length - 2) / 4; i >= 0 && length > 1; i--) {				\
+			hp_##Type##_sift_down(heap, i);										\
+		}																		\
+	}																			\
+																				\
+	static inline Type hp_##Type##_get(Heap_##Type *heap, int handle) {			\
+		return heap->elms[heap->positions[handle]];								\
+	}																			\
+																				\
+	static inline void hp_##Type##_update(Heap_##Type *heap, int handle, Type elm) {	\
+		heap->elms[heap->positions[handle]] = elm;								\
+		hp_##Type##_sift(heap, heap->positions[handle]);						\
+	}																			\
+																				\
+	static inline void hp_##Type##_remove(Heap_##Type *heap, int handle) {		\
+		hp_##Type##_remove_at(heap, heap->positions[handle]);					\
+	}																			\
+																				\
+	static inline void hp_##Type##_clear(Heap_##Type *heap) {					\
+		heap->length = 0;														\
+	}																			\
+
+
+/*
+ * Dynamic Array List, Circular Array List, Stack and Queue
+ * The same containers as above, but the array of elements is allocated
+ * at runtime instead of being embedded in the struct. This keeps large
+ * lists off the stack and allows the capacity to be decided at runtime.
+ *
+ * Prepare the containers with DEFINE_ARRAY_LIST_DYN,
+ * DEFINE_CIRCULAR_ARRAY_LIST_DYN, DEFINE_STACK_DYN or DEFINE_QUEUE_DYN.
+ * The only parameter is the type of the element. This will create structs
+ * called List_<type>_dyn, CList_<type>_dyn, Stack_<type>_dyn and
+ * Queue_<type>_dyn, with functions prefixed al_<type>_dyn_, cl_<type>_dyn_,
+ * st_<type>_dyn_ and qu_<type>_dyn_. For pointer lists, typedef the
+ * pointer type first.
+ *
+ * The elements are allocated once by init and released by free. Memory is
+ * aligned to a cache line, or to a huge page if the array is at least that
+ * big, so that the kernel can back it with transparent huge pages. The
+ * function init_with takes the memory from a DSAllocator instead, which
+ * is then in charge of its alignment.
+ *
+ * The operations are the same as the fixed size containers and they do not
+ * check boundaries either. The functions reserve and push_grow are the
+ * exception: reserve grows the capacity of the container, and push_grow
+ * doubles it when the container is full before pushing the element.
+ * Both return 0 if the memory could not be allocated, and 1 otherwise.
+ *
+ * The capacity of the circular list and of the queue is rounded up to a
+ * power of two, so that indices wrap around with a mask instead of a
+ * division. When they grow, the elements are moved so that the head is 0.
+ *
+ * DEFINE_ARRAY_LIST_DYN(int)
+ * List_int_dyn
+ * al_int_dyn_init		(list, capacity)		-> int
+ * al_int_dyn_init_with	(list, allocator, capacity)	-> int
+ * al_int_dyn_free		(list)
+ * al_int_dyn_reserve	(list, capacity)		-> int
+ * al_int_dyn_push		(list, elm)
+ * al_int_dyn_push_grow	(list, elm)				-> int
+ * al_int_dyn_pop		(list)					-> elm
+ * al_int_dyn_insert	(list, index, elm)
+ * al_int_dyn_remove	(list, index)
+ * al_int_dyn_set		(list, index, elm)
+ * al_int_dyn_get		(list, index)			-> elm
+ * al_int_dyn_clear		(list)
+ *
+ * DEFINE_CIRCULAR_ARRAY_LIST_DYN(int)
+ * CList_int_dyn
+ * cl_int_dyn_init		(list, capacity)		-> int
+ * cl_int_dyn_init_with	(list, allocator, capacity)	-> int
+ * cl_int_dyn_free		(list)
+ * cl_int_dyn_reserve	(list, capacity)		-> int
+ * cl_int_dyn_length	(list)					-> int
+ * cl_int_dyn_push_head	(list, elm)
+ * cl_int_dyn_pop_head	(list)					-> elm
+ * cl_int_dyn_push_tail	(list, elm)
+ * cl_int_dyn_push_grow	(list, elm)				-> int
+ * cl_int_dyn_pop_tail	(list)					-> elm
+ * cl_int_dyn_insert	(list, index, elm)
+ * cl_int_dyn_remove	(list, index)
+ * cl_int_dyn_set		(list, index, elm)
+ * cl_int_dyn_get		(list, index)			-> elm
+ * cl_int_dyn_clear		(list)
+ *
+ * DEFINE_STACK_DYN(int)
+ * Stack_int_dyn
+ * st_int_dyn_init		(stack, capacity)		-> int
+ * st_int_dyn_init_with	(stack, allocator, capacity)	-> int
+ * st_int_dyn_free		(stack)
+ * st_int_dyn_reserve	(stack, capacity)		-> int
+ * st_int_dyn_length	(stack)					-> int
+ * st_int_dyn_push		(stack, elm)
+ * st_int_dyn_push_grow	(stack, elm)			-> int
+ * st_int_dyn_pop		(stack)					-> elm
+ * st_int_dyn_peek		(stack)					-> elm
+ * st_int_dyn_clear		(stack)
+ *
+ * DEFINE_QUEUE_DYN(int)
+ * Queue_int_dyn
+ * qu_int_dyn_init		(queue, capacity)		-> int
+ * qu_int_dyn_init_with	(queue, allocator, capacity)	-> int
+ * qu_int_dyn_free		(queue)
+ * qu_int_dyn_reserve	(queue, capacity)		-> int
+ * qu_int_dyn_length	(queue)					-> int
+ * qu_int_dyn_push		(queue, elm)
+ * qu_int_dyn_push_grow	(queue, elm)			-> int
+ * qu_int_dyn_pop		(queue)					-> elm
+ * qu_int_dyn_peek		(queue)					-> elm
+ * qu_int_dyn_clear		(queue)
+ *
+ * Members of the containers, besides those of the fixed size ones:
+ * - capacity: the number of elements allocated. Do not change this value.
+ * - allocator: the allocator of the elements, or NULL. Do not change it.
+ *
+ */
+
+#define LIST_CACHE_LINE 64
+#define LIST_HUGE_PAGE (2UL * 1024UL * 1024UL)
+
+static inline void *_list_dyn_alloc(const DSAllocator *allocator, size_t bytes) {
+	size_t align = bytes >= LIST_HUGE_PAGE ? LIST_HUGE_PAGE : LIST_CACHE_LINE;
+	void *ptr;
+	if (allocator) {
+		return ds_alloc_with(allocator, bytes);
+	}
+	if (bytes == 0) {
+		bytes = 1;
+	}
+	bytes = (bytes + align - 1) / align * align;  // aligned_alloc wants a multiple of the alignment
+	ptr = aligned_alloc(align, bytes);
+#ifdef MADV_HUGEPAGE
+	if (ptr && align == LIST_HUGE_PAGE) {
+		madvise(ptr, bytes, MADV_HUGEPAGE);
+	}
+#endif
+	return ptr;
+}
+
+static inline void _list_dyn_free(const DSAllocator *allocator, void *ptr, size_t bytes) {
+	if (ptr) {
+		ds_free_with(allocator, ptr, bytes);
+	}
+}
+
+// smallest power of two that is greater than or equal to n
+static inline int _list_dyn_pow2(int n) {
+	int p = 1;
+	while (p < n) {
+		p <<= 1;
+	}
+	return p;
+}
+
+#define DEFINE_ARRAY_LIST_DYN(Type)												\
+	typedef struct {															\
+		Type *elms;																\
+		int length;																\
+		int capacity;															\
+		const DSAllocator *allocator;											\
+	} List_##Type##_dyn;														\
+																				\
+	static inline int al_##Type##_dyn_init_with(List_##Type##_dyn *list, const DSAllocator *allocator, int capacity) {	\
+		list->allocator = allocator;											\
+		list->elms = _list_dyn_alloc(list->allocator, (size_t) capacity * sizeof(Type));	\
+		list->length = 0;														\
+		list->capacity = list->elms ? capacity : 0;								\
+		return list->elms != NULL;												\
+	}																			\
+																				\
+	static inline int al_##Type##_dyn_init(List_##Type##_dyn *list, int capacity) {	\
+		return al_##Type##_dyn_init_with(list, NULL, capacity);					\
+	}																			\
+																				\
+	static inline void al_##Type##_dyn_free(List_##Type##_dyn *list) {			\
+		_list_dyn_free(list->allocator, list->elms, (size_t) list->capacity * sizeof(Type));	\
+		list->elms = NULL;														\
+		list->length = 0;														\
+		list->capacity = 0;														\
+	}																			\
+																				\
+	static inline int al_##Type##_dyn_reserve(List_##Type##_dyn *list, int capacity) {	\
+		Type *elms;																\
+		if (capacity <= list->capacity) {										\
+			return 1;															\
+		}																		\
+		elms = _list_dyn_alloc(list->allocator, (size_t) capacity * sizeof(Type));	\
+		if (!elms) {															\
+			return 0;															\
+		}																		\
+		if (list->length > 0) {													\
+			memcpy(elms, list->elms, (size_t) list->length * sizeof(Type));		\
+		}																		\
+		_list_dyn_free(list->allocator, list->elms, (size_t) list->capacity * sizeof(Type));	\
+		list->elms = elms;														\
+		list->capacity = capacity;												\
+		return 1;																\
+	}																			\
+																				\
+	static inline void al_##Type##_dyn_push(List_##Type##_dyn *list, Type elm) {	\
+		list->elms[list->length++] = elm;										\
+	}																			\
+																				\
+	static inline int al_##Type##_dyn_push_grow(List_##Type##_dyn *list, Type elm) {	\
+		if (list->length == list->capacity &&									\
+				!al_##Type##_dyn_reserve(list, list->capacity ? list->capacity * 2 : 16)) {	\
+			return 0;															\
+		}																		\
+		list->elms[list->length++] = elm;										\
+		return 1;																\
+	}																			\
+																				\
+	static inline Type al_##Type##_dyn_pop(List_##Type##_dyn *list) {			\
+		return list->elms[--list->length];										\
+	}																			\
+																				\
+	static inline void al_##Type##_dyn_insert(List_##Type##_dyn *list, int index, Type elm) {	\
+		for (int i = list->length; i > index; i--) {							\
+			list->elms[i] = list->elms[i-1];									\
+		}																		\
+		list->elms[index] = elm;												\
+		list->length += 1;														\
+	}																			\
+																				\
+	static inline void al_##Type##_dyn_remove(List_##Type##_dyn *list, int index) {	\
+		for (int i = index; i < list->length - 1; i++) {						\
+			list->elms[i] = list->elms[i+1];									\
+		}																		\
+		list->length -= 1;														\
+	}																			\
+																				\
+	static inline void al_##Type##_dyn_set(List_##Type##_dyn *list, int index, Type elm) {	\
+		list->elms[index] = elm;												\
+	}																			\
+																				\
+	static inline Type al_##Type##_dyn_get(List_##Type##_dyn *list, int index) {	\
+		return list->elms[index];												\
+	}																			\
+																				\
+	static inline void al_##Type##_dyn_clear(List_##Type##_dyn *list) {			\
+		list->length = 0;														\
+	}
+
+#define DEFINE_CIRCULAR_ARRAY_LIST_DYN(Type)									\
+	typedef struct {															\
+		Type *elms;																\
+		int head;																\
+		int tail;																\
+		int capacity;															\
+		const DSAllocator *allocator;											\
+	} CList_##Type##_dyn;														\
+																				\
+	static inline int cl_##Type##_dyn_index(CList_##Type##_dyn *list, int index) {	\
+		return index & (list->capacity - 1);									\
+	}																			\
+																				\
+	static inline int cl_##Type##_dyn_length(CList_##Type##_dyn *list) {		\
+		return list->tail - list->head;											\
+	}																			\
+																				\
+	static inline int cl_##Type##_dyn_init_with(CList_##Type##_dyn *list, const DSAllocator *allocator, int capacity) {	\
+		list->allocator = allocator;											\
+		capacity = _list_dyn_pow2(capacity);									\
+		list->elms = _list_dyn_alloc(list->allocator, (size_t) capacity * sizeof(Type));	\
+		list->head = 0;															\
+		list->tail = 0;															\
+		list->capacity = list->elms ? capacity : 0;								\
+		return list->elms != NULL;												\
+	}																			\
+																				\
+	static inline int cl_##Type##_dyn_init(CList_##Type##_dyn *list, int capacity) {	\
+		return cl_##Type##_dyn_init_with(list, NULL, capacity);					\
+	}																			\
+																				\
+	static inline void cl_##Type##_dyn_free(CList_##Type##_dyn *list) {			\
+		_list_dyn_free(list->allocator, list->elms, (size_t) list->capacity * sizeof(Type));	\
+		list->elms = NULL;														\
+		list->head = 0;															\
+		list->tail = 0;															\
+		list->capacity = 0;														\
+	}																			\
+																				\
+	static inline int cl_##Type##_dyn_reserve(CList_##Type##_dyn *list, int capacity) {	\
+		int length = cl_##Type##_dyn_length(list);								\
+		Type *elms;																\
+		if (capacity <= list->capacity) {										\
+			return 1;															\
+		}																		\
+		capacity = _list_dyn_pow2(capacity);									\
+		elms = _list_dyn_alloc(list->allocator, (size_t) capacity * sizeof(Type));	\
+		if (!elms) {															\
+			return 0;															\
+		}																		\
+		for (int i = 0; i < length; i++) {										\
+			elms[i] = list->elms[cl_##Type##_dyn_index(list, list->head + i)];	\
+		}																		\
+		_list_dyn_free(list->allocator, list->elms, (size_t) list->capacity * sizeof(Type));	\
+		list->elms = elms;														\
+		list->head = 0;															\
+		list->tail = length;													\
+		list->capacity = capacity;												\
+		return 1;																\
+	}																			\
+																				\
+	static inline void cl_##Type##_dyn_push_tail(CList_##Type##_dyn *list, Type elm) {	\
+		list->elms[cl_##Type##_dyn_index(list, list->tail++)] = elm;			\
+	}																			\
+																				\
+	static inline int cl_##Type##_dyn_push_grow(CList_##Type##_dyn *list, Type elm) {	\
+		if (cl_##Type##_dyn_length(list) == list->capacity &&					\
+				!cl_##Type##_dyn_reserve(list, list->capacity ? list->capacity * 2 : 16)) {	\
+			return 0;															\
+		}																		\
+		list->elms[cl_##Type##_dyn_index(list, list->tail++)] = elm;			\
+		return 1;																\
+	}																			\
+																				\
+	static inline Type cl_##Type##_dyn_pop_tail(CList_##Type##_dyn *list) {		\
+		return list->elms[cl_##Type##_dyn_index(list, --list->tail)];			\
+	}																			\
+																				\
+	static inline void cl_##Type##_dyn_push_head(CList_##Type##_dyn *list, Type elm) {	\
+		list->elms[cl_##Type##_dyn_index(list, --list->head)] = elm;			\
+	}																			\
+																				\
+	static inline Type cl_##Type##_dyn_pop_head(CList_##Type##_dyn *list) {		\
+		return list->elms[cl_##Type##_dyn_index(list, list->head++)];			\
+	}																			\
+																				\
+	static inline void cl_##Type##_dyn_insert(CList_##Type##_dyn *list, int index, Type elm) {	\
+		for (int i = cl_##Type##_dyn_length(list); i > index; i--) {			\
+			list->elms[cl_##Type##_dyn_index(list, list->head + i)] = list->elms[cl_##Type##_dyn_index(list, list->head + i - 1)];	\
+		}																		\
+		list->elms[cl_##Type##_dyn_index(list, list->head + index)] = elm;		\
+		list->tail += 1;														\
+	}																			\
+																				\
+	static inline void cl_##Type##_dyn_remove(CList_##Type##_dyn *list, int index) {	\
+		for (int i = index; i < cl_##Type##_dyn_length(list) - 1; i++) {		\
+			list->elms[cl_##Type##_dyn_index(list, list->head + i)] = list->elms[cl_##Type##_dyn_index(list, list->head + i + 1)];	\
+		}																		\
+		list->tail -= 1;														\
+	}																			\
+																				\
+	static inline void cl_##Type##_dyn_set(CList_##Type##_dyn *list, int index, Type elm) {	\
+		list->elms[cl_##Type##_dyn_index(list, list->head + index)] = elm;		\
+	}																			\
+																				\
+	static inline Type cl_##Type##_dyn_get(CList_##Type##_dyn *list, int index) {	\
+		return list->elms[cl_##Type##_dyn_index(list, list->head + index)];		\
+	}																			\
+																				\
+	static inline void cl_##Type##_dyn_clear(CList_##Type##_dyn *list) {		\
+		list->head = 0;															\
+		list->tail = 0;															\
+	}
+
+#define DEFINE_STACK_DYN(Type)													\
+	typedef struct Stack_##Type##_dyn {											\
+		Type *elms;																\
+		int length;																\
+		int capacity;															\
+		const DSAllocator *allocator;											\
+	} Stack_##Type##_dyn;														\
+																				\
+	static inline int st_##Type##_dyn_init_with(Stack_##Type##_dyn *stack, const DSAllocator *allocator, int capacity) {	\
+		stack->allocator = allocator;											\
+		stack->elms = _list_dyn_alloc(stack->allocator, (size_t) capacity * sizeof(Type));	\
+		stack->length = 0;														\
+		stack->capacity = stack->elms ? capacity : 0;							\
+		return stack->elms != NULL;												\
+	}																			\
+																				\
+	static inline int st_##Type##_dyn_init(Stack_##Type##_dyn *stack, int capacity) {	\
+		return st_##Type##_dyn_init_with(stack, NULL, capacity);				\
+	}																			\
+																				\
+	static inline void st_##Type##_dyn_free(Stack_##Type##_dyn *stack) {		\
+		_list_dyn_free(stack->allocator, stack->elms, (size_t) stack->capacity * sizeof(Type));	\
+		stack->elms = NULL;														\
+		stack->length = 0;														\
+		stack->capacity = 0;													\
+	}																			\
+																				\
+	static inline int st_##Type##_dyn_reserve(Stack_##Type##_dyn *stack, int capacity) {	\
+		Type *elms;																\
+		if (capacity <= stack->capacity) {										\
+			return 1;															\
+		}																		\
+		elms = _list_dyn_alloc(stack->allocator, (size_t) capacity * sizeof(Type));	\
+		if (!elms) {															\
+			return 0;															\
+		}																		\
+		if (stack->length > 0) {												\
+			memcpy(elms, stack->elms, (size_t) stack->length * sizeof(Type));	\
+		}																		\
+		_list_dyn_free(stack->allocator, stack->elms, (size_t) stack->capacity * sizeof(Type));	\
+		stack->elms = elms;														\
+		stack->capacity = capacity;												\
+		return 1;																\
+	}																			\
+																				\
+	static inline int st_##Type##_dyn_length(Stack_##Type##_dyn *stack) {		\
+		return stack->length;													\
+	}																			\
+																				\
+	static inline void st_##Type##_dyn_push(Stack_##Type##_dyn *stack, Type elm) {	\
+		stack->elms[stack->length++] = elm;										\
+	}																			\
+																				\
+	static inline int st_##Type##_dyn_push_grow(Stack_##Type##_dyn *stack, Type elm) {	\
+		if (stack->length == stack->capacity &&									\
+				!st_##Type##_dyn_reserve(stack, stack->capacity ? stack->capacity * 2 : 16)) {	\
+			return 0;															\
+		}																		\
+		stack->elms[stack->length++] = elm;										\
+		return 1;																\
+	}																			\
+																				\
+	static inline Type st_##Type##_dyn_pop(Stack_##Type##_dyn *stack) {			\
+		return stack->elms[--stack->length];									\
+	}																			\
+																				\
+	static inline Type st_##Type##_dyn_peek(Stack_##Type##_dyn *stack) {		\
+		return stack->elms[stack->length - 1];									\
+	}																			\
+																				\
+	static inline void st_##Type##_dyn_clear(Stack_##Type##_dyn *stack) {		\
+		stack->length = 0;														\
+	}
+
+#define DEFINE_QUEUE_DYN(Type)													\
+	typedef struct Queue_##Type##_dyn {											\
+		Type *elms;																\
+		int head;																\
+		int tail;																\
+		int capacity;															\
+		const DSAllocator *allocator;											\
+	} Queue_##Type##_dyn;														\
+																				\
+	static inline int qu_##Type##_dyn_init_with(Queue_##Type##_dyn *queue, const DSAllocator *allocator, int capacity) {	\
+		queue->allocator = allocator;											\
+		capacity = _list_dyn_pow2(capacity);									\
+		queue->elms = _list_dyn_alloc(queue->allocator, (size_t) capacity * sizeof(Type));	\
+		queue->head = 0;														\
+		queue->tail = 0;														\
+		queue->capacity = queue->elms ? capacity : 0;							\
+		return queue->elms != NULL;												\
+	}																			\
+																				\
+	static inline int qu_##Type##_dyn_init(Queue_##Type##_dyn *queue, int capacity) {	\
+		return qu_##Type##_dyn_init_with(queue, NULL, capacity);				\
+	}																			\
+																				\
+	static inline void qu_##Type##_dyn_free(Queue_##Type##_dyn *queue) {		\
+		_list_dyn_free(queue->allocator, queue->elms, (size_t) queue->capacity * sizeof(Type));	\
+		queue->elms = NULL;														\
+		queue->head = 0;														\
+		queue->tail = 0;														\
+		queue->capacity = 0;													\
+	}																			\
+																				\
+	static inline int qu_##Type##_dyn_length(Queue_##Type##_dyn *queue) {		\
+		return queue->tail - queue->head;										\
+	}																			\
+																				\
+	static inline int qu_##Type##_dyn_reserve(Queue_##Type##_dyn *queue, int capacity) {	\
+		int length = qu_##Type##_dyn_length(queue);								\
+		Type *elms;																\
+		if (capacity <= queue->capacity) {										\
+			return 1;															\
+		}																		\
+		capacity = _list_dyn_pow2(capacity);									\
+		elms = _list_dyn_alloc(queue->allocator, (size_t) capacity * sizeof(Type));	\
+		if (!elms) {															\
+			return 0;															\
+		}																		\
+		for (int i = 0; i < length; i++) {										\
+			elms[i] = queue->elms[(queue->head + i) & (queue->capacity - 1)];	\
+		}																		\
+		_list_dyn_free(queue->allocator, queue->elms, (size_t) queue->capacity * sizeof(Type));	\
+		queue->elms = elms;														\
+		queue->head = 0;														\
+		queue->tail = length;													\
+		queue->capacity = capacity;												\
+		return 1;																\
+	}																			\
+																				\
+	static inline void qu_##Type##_dyn_push(Queue_##Type##_dyn *queue, Type elm) {	\
+		queue->elms[queue->tail++ & (queue->capacity - 1)] = elm;				\
+	}																			\
+																				\
+	static inline int qu_##Type##_dyn_push_grow(Queue_##Type##_dyn *queue, Type elm) {	\
+		if (qu_##Type##_dyn_length(queue) == queue->capacity &&					\
+				!qu_##Type##_dyn_reserve(queue, queue->capacity ? queue->capacity * 2 : 16)) {	\
+			return 0;															\
+		}																		\
+		queue->elms[queue->tail++ & (queue->capacity - 1)] = elm;				\
+		return 1;																\
+	}																			\
+																				\
+	static inline Type qu_##Type##_dyn_pop(Queue_##Type##_dyn *queue) {			\
+		return queue->elms[queue->head++ & (queue->capacity - 1)];				\
+	}																			\
+																				\
+	static inline Type qu_##Type##_dyn_peek(Queue_##Type##_dyn *queue) {		\
+		return queue->elms[queue->head & (queue->capacity - 1)];				\
+	}																			\
+																				\
+	static inline void qu_##Type##_dyn_clear(Queue_##Type##_dyn *queue) {		\
+		queue->head = 0;														\
+		queue->tail = 0;														\
+	}
+
+
 /*
  * Linked List
  * Generic, simple, fast, doubly linked list.
@@ -480,6 +1153,58 @@
  * function will calculate the length of the list from the node you give 
  * it forwards.
  *
+ * List Handle
+ * The macros also define a handle, LLHandle_<type>, that keeps references
+ * to the head and the tail of a list and counts its nodes, so that length
+ * is O(1). Its functions have the prefix llh_<type>_. An empty list is a
+ * zeroed handle. Do not mix the node functions above with a handle, as they
+ * do not update it.
+ *
+ * The functions link_front, link_back and unlink attach and detach a node
+ * without allocating or freeing it, and move_front and move_back use them
+ * to move a node to an end of the list, as in LRU lists. The function splice
+ * moves all the nodes of another handle after a node, or to the front if the
+ * node is NULL, in O(1). The function split moves a node and all the nodes
+ * after it to an empty handle. It is O(1) if it is given the number of
+ * nodes moved, or it counts them if the number is negative. The function
+ * sort is a stable merge sort of the nodes in place, with a compare function
+ * that returns <0 if a<b, 0 if a==b and >0 if a>b.
+ *
+ * DEFINE_LINKED_LIST(int)
+ * LLHandle_int
+ * llh_int_length		(list)					-> int
+ * llh_int_push_front	(list, elm)				-> node
+ * llh_int_push_back	(list, elm)				-> node
+ * llh_int_pop_front	(list)					-> elm
+ * llh_int_pop_back		(list)					-> elm
+ * llh_int_link_front	(list, node)
+ * llh_int_link_back	(list, node)
+ * llh_int_unlink		(list, node)
+ * llh_int_remove		(list, node)
+ * llh_int_move_front	(list, node)
+ * llh_int_move_back	(list, node)
+ * llh_int_splice		(list, node, other)
+ * llh_int_split		(list, node, count, out)
+ * llh_int_sort			(list, compare)
+ * llh_int_clear		(list)
+ * llh_int_stats		(list)					-> stats
+ *
+ * Push returns NULL if the memory for the node could not be allocated.
+ *
+ * With DS_STATS defined, the handle counts its operations, compares,
+ * allocations and frees, and stats returns them; otherwise it returns
+ * NULL. The node functions record into the stats bound with ds_stats_bind.
+ *
+ * Arena and Allocator
+ * The functions push, insert, pop and remove have variants with the suffix
+ * _in that take a DSArena as first argument and allocate the nodes from it,
+ * and variants with the suffix _with that take a DSAllocator; clear has a
+ * _with variant too. Likewise, a handle whose allocator field is set
+ * allocates its nodes with it; use ds_arena_allocator for an arena. Nodes
+ * in an arena are not freed one by one, and clearing such a handle only
+ * forgets its nodes; they are all released together with ds_arena_reset
+ * or ds_arena_delete. A NULL arena or allocator means malloc and free.
+ *
  */
 #define DEFINE_LINKED_LIST(Type)												\
 	struct LList_##Type;														\
@@ -489,7 +1214,7 @@
 		struct LList_##Type *prev;												\
 	} LList_##Type;																\
 																				\
-	Type ll_##Type##_length(LList_##Type *list) {								\
+	static inline int ll_##Type##_length(LList_##Type *list) {					\
 		int count = 0;															\
 		for (; list != NULL; list = list->next) {								\
 			count += 1;															\
@@ -497,8 +1222,12 @@
 		return count;															\
 	}																			\
 																				\
-	LList_##Type *ll_##Type##_push(LList_##Type *node, Type elm) {				\
-		LList_##Type *l = malloc(sizeof(LList_##Type));							\
+	static inline LList_##Type *ll_##Type##_push_with(const DSAllocator *allocator, LList_##Type *node, Type elm) {	\
+		LList_##Type *l = ds_alloc_with(allocator, sizeof(LList_##Type));		\
+		if (!l) {																\
+			return NULL;														\
+		}																		\
+		DS_STAT(ds_stats_bound(), allocations, 1);								\
 		l->elm = elm;															\
 		l->prev = NULL;															\
 		l->next = NULL;															\
@@ -513,7 +1242,15 @@
 		return l;																\
 	}																			\
 																				\
-	LList_##Type *ll_##Type##_pop(LList_##Type *node) {							\
+	static inline LList_##Type *ll_##Type##_push_in(DSArena *arena, LList_##Type *node, Type elm) {	\
+		return ll_##Type##_push_with(ds_arena_allocator(arena), node, elm);		\
+	}																			\
+																				\
+	static inline LList_##Type *ll_##Type##_push(LList_##Type *node, Type elm) {	\
+		return ll_##Type##_push_with(NULL, node, elm);							\
+	}																			\
+																				\
+	static inline LList_##Type *ll_##Type##_pop_with(const DSAllocator *allocator, LList_##Type *node) {	\
 		LList_##Type *prev = node->prev;										\
 		if (node->prev) {														\
 			node->prev->next = node->next;										\
@@ -521,12 +1258,25 @@
 		if (node->next) {														\
 			node->next->prev = node->prev;										\
 		}																		\
-		free(node);																\
+		ds_free_with(allocator, node, sizeof(LList_##Type));					\
+		DS_STAT(ds_stats_bound(), frees, 1);									\
 		return prev;															\
 	}																			\
 																				\
-	LList_##Type *ll_##Type##_insert(LList_##Type *node, Type elm) {			\
-		LList_##Type *l = malloc(sizeof(LList_##Type));							\
+	static inline LList_##Type *ll_##Type##_pop_in(DSArena *arena, LList_##Type *node) {	\
+		return ll_##Type##_pop_with(ds_arena_allocator(arena), node);			\
+	}																			\
+																				\
+	static inline LList_##Type *ll_##Type##_pop(LList_##Type *node) {			\
+		return ll_##Type##_pop_with(NULL, node);								\
+	}																			\
+																				\
+	static inline LList_##Type *ll_##Type##_insert_with(const DSAllocator *allocator, LList_##Type *node, Type elm) {	\
+		LList_##Type *l = ds_alloc_with(allocator, sizeof(LList_##Type));		\
+		if (!l) {																\
+			return NULL;														\
+		}																		\
+		DS_STAT(ds_stats_bound(), allocations, 1);								\
 		l->elm = elm;															\
 		l->next = NULL;															\
 		l->prev = NULL;															\
@@ -541,7 +1291,15 @@
 		return l;																\
 	}																			\
 																				\
-	LList_##Type *ll_##Type##_remove(LList_##Type *node) {						\
+	static inline LList_##Type *ll_##Type##_insert_in(DSArena *arena, LList_##Type *node, Type elm) {	\
+		return ll_##Type##_insert_with(ds_arena_allocator(arena), node, elm);	\
+	}																			\
+																				\
+	static inline LList_##Type *ll_##Type##_insert(LList_##Type *node, Type elm) {	\
+		return ll_##Type##_insert_with(NULL, node, elm);						\
+	}																			\
+																				\
+	static inline LList_##Type *ll_##Type##_remove_with(const DSAllocator *allocator, LList_##Type *node) {	\
 		LList_##Type *next = node->next;										\
 		if (node->prev) {														\
 			node->prev->next = node->next;										\
@@ -549,16 +1307,265 @@
 		if (node->next) {														\
 			node->next->prev = node->prev;										\
 		}																		\
-		free(node);																\
+		ds_free_with(allocator, node, sizeof(LList_##Type));					\
+		DS_STAT(ds_stats_bound(), frees, 1);									\
 		return next;															\
 	}																			\
 																				\
-	void ll_##Type##_clear(LList_##Type *head) {								\
+	static inline LList_##Type *ll_##Type##_remove_in(DSArena *arena, LList_##Type *node) {	\
+		return ll_##Type##_remove_with(ds_arena_allocator(arena), node);		\
+	}																			\
+																				\
+	static inline LList_##Type *ll_##Type##_remove(LList_##Type *node) {		\
+		return ll_##Type##_remove_with(NULL, node);								\
+	}																			\
+																				\
+	static inline void ll_##Type##_clear_with(const DSAllocator *allocator, LList_##Type *head) {	\
 		LList_##Type *next;														\
 		for (LList_##Type *node = head; node != NULL; node = next) {			\
 			next = node->next;													\
-			free(node);															\
+			ds_free_with(allocator, node, sizeof(LList_##Type));				\
+			DS_STAT(ds_stats_bound(), frees, 1);								\
+		}																		\
+	}																			\
+																				\
+	static inline void ll_##Type##_clear(LList_##Type *head) {					\
+		ll_##Type##_clear_with(NULL, head);										\
+	}																			\
+																				\
+	typedef struct LLHandle_##Type {											\
+		LList_##Type *head;														\
+		LList_##Type *tail;														\
+		int length;																\
+		const DSAllocator *allocator;											\
+		DS_STATS_MEMBER															\
+	} LLHandle_##Type;															\
+																				\
+	static inline int llh_##Type##_length(LLHandle_##Type *list) {				\
+		return list->length;													\
+	}																			\
+																				\
+	static inline const DSStats *llh_##Type##_stats(LLHandle_##Type *list) {	\
+		return DS_STATS_OF(list);												\
+	}																			\
+																				\
+	static inline void llh_##Type##_link_front(LLHandle_##Type *list, LList_##Type *node) {	\
+		node->prev = NULL;														\
+		node->next = list->head;												\
+		if (list->head) {														\
+			list->head->prev = node;											\
+		}																		\
+		else {																	\
+			list->tail = node;													\
+		}																		\
+		list->head = node;														\
+		list->length += 1;														\
+	}																			\
+																				\
+	static inline void llh_##Type##_link_back(LLHandle_##Type *list, LList_##Type *node) {	\
+		node->next = NULL;														\
+		node->prev = list->tail;												\
+		if (list->tail) {														\
+			list->tail->next = node;											\
+		}																		\
+		else {																	\
+			list->head = node;													\
+		}																		\
+		list->tail = node;														\
+		list->length += 1;														\
+	}																			\
+																				\
+	static inline void llh_##Type##_unlink(LLHandle_##Type *list, LList_##Type *node) {	\
+		if (node->prev) {														\
+			node->prev->next = node->next;										\
+		}																		\
+		else {																	\
+			list->head = node->next;											\
+		}																		\
+		if (node->next) {														\
+			node->next->prev = node->prev;										\
+		}																		\
+		else {																	\
+			list->tail = node->prev;											\
+		}																		\
+		node->next = NULL;														\
+		node->prev = NULL;														\
+		list->length -= 1;														\
+	}																			\
+																				\
+	static inline LList_##Type *llh_##Type##_push_front(LLHandle_##Type *list, Type elm) {	\
+		LList_##Type *node = ds_alloc_with(list->allocator, sizeof(LList_##Type));	\
+		DS_STAT(&list->stats, ops, 1);											\
+		DS_STAT(&list->stats, allocations, 1);									\
+		if (node) {																\
+			node->elm = elm;													\
+			llh_##Type##_link_front(list, node);								\
+		}																		\
+		return node;															\
+	}																			\
+																				\
+	static inline LList_##Type *llh_##Type##_push_back(LLHandle_##Type *list, Type elm) {	\
+		LList_##Type *node = ds_alloc_with(list->allocator, sizeof(LList_##Type));	\
+		DS_STAT(&list->stats, ops, 1);											\
+		DS_STAT(&list->stats, allocations, 1);									\
+		if (node) {																\
+			node->elm = elm;													\
+			llh_##Type##_link_back(list, node);									\
 		}																		\
+		return node;															\
+	}																			\
+																				\
+	static inline Type llh_##Type##_pop_front(LLHandle_##Type *list) {			\
+		LList_##Type *node = list->head;										\
+		Type elm = node->elm;													\
+		llh_##Type##_unlink(list, node);										\
+		ds_free_with(list->allocator, node, sizeof(LList_##Type));				\
+		DS_STAT(&list->stats, ops, 1);											\
+		DS_STAT(&list->stats, frees, 1);										\
+		return elm;																\
+	}																			\
+																				\
+	static inline Type llh_##Type##_pop_back(LLHandle_##Type *list) {			\
+		LList_##Type *node = list->tail;										\
+		Type elm = node->elm;													\
+		llh_##Type##_unlink(list, node);										\
+		ds_free_with(list->allocator, node, sizeof(LList_##Type));				\
+		DS_STAT(&list->stats, ops, 1);											\
+		DS_STAT(&list->stats, frees, 1);										\
+		return elm;																\
+	}																			\
+																				\
+	static inline void llh_##Type##_remove(LLHandle_##Type *list, LList_##Type *node) {	\
+		llh_##Type##_unlink(list, node);										\
+		ds_free_with(list->allocator, node, sizeof(LList_##Type));				\
+		DS_STAT(&list->stats, ops, 1);											\
+		DS_STAT(&list->stats, frees, 1);										\
+	}																			\
+																				\
+	static inline void llh_##Type##_move_front(LLHandle_##Type *list, LList_##Type *node) {	\
+		if (list->head != node) {												\
+			llh_##Type##_unlink(list, node);									\
+			llh_##Type##_link_front(list, node);								\
+		}																		\
+	}																			\
+																				\
+	static inline void llh_##Type##_move_back(LLHandle_##Type *list, LList_##Type *node) {	\
+		if (list->tail != node) {												\
+			llh_##Type##_unlink(list, node);									\
+			llh_##Type##_link_back(list, node);									\
+		}																		\
+	}																			\
+																				\
+	static inline void llh_##Type##_splice(LLHandle_##Type *list, LList_##Type *pos, LLHandle_##Type *other) {	\
+		LList_##Type *next;														\
+		if (!other->head) {														\
+			return;																\
+		}																		\
+		next = pos ? pos->next : list->head;									\
+		other->head->prev = pos;												\
+		other->tail->next = next;												\
+		if (pos) {																\
+			pos->next = other->head;											\
+		}																		\
+		else {																	\
+			list->head = other->head;											\
+		}																		\
+		if (next) {																\
+			next->prev = other->tail;											\
+		}																		\
+		else {																	\
+			list->tail = other->tail;											\
+		}																		\
+		list->length += other->length;											\
+		other->head = NULL;														\
+		other->tail = NULL;														\
+		other->length = 0;														\
+	}																			\
+																				\
+	static inline void llh_##Type##_split(LLHandle_##Type *list, LList_##Type *node, int count, LLHandle_##Type *out) {	\
+		if (count < 0) {														\
+			count = 0;															\
+			for (LList_##Type *n = node; n != NULL; n = n->next) {				\
+				count += 1;														\
+			}																	\
+		}																		\
+		out->head = node;														\
+		out->tail = list->tail;													\
+		out->length = count;													\
+		list->tail = node->prev;												\
+		if (node->prev) {														\
+			node->prev->next = NULL;											\
+		}																		\
+		else {																	\
+			list->head = NULL;													\
+		}																		\
+		node->prev = NULL;														\
+		list->length -= count;													\
+	}																			\
+																				\
+	static inline void llh_##Type##_sort(LLHandle_##Type *list, int (*compare)(const Type *a, const Type *b)) {	\
+		DS_STAT(&list->stats, ops, 1);											\
+		LList_##Type *head = list->head;										\
+		LList_##Type *tail = NULL;												\
+		if (!head) {															\
+			return;																\
+		}																		\
+		for (int width = 1; ; width *= 2) {										\
+			LList_##Type *p = head;												\
+			int merges = 0;														\
+			head = NULL;														\
+			tail = NULL;														\
+			while (p) {															\
+				LList_##Type *q = p;											\
+				int psize = 0;													\
+				int qsize = width;												\
+				merges += 1;													\
+				for (; psize < width && q; psize++) {							\
+					q = q->next;												\
+				}																\
+				while (psize > 0 || (qsize > 0 && q)) {							\
+					if (psize > 0 && qsize > 0 && q) {							\
+						DS_STAT(&list->stats, compares, 1);						\
+					}															\
+					LList_##Type *e;											\
+					if (psize == 0 || (qsize > 0 && q && compare(&q->elm, &p->elm) < 0)) {	\
+						e = q;													\
+						q = q->next;											\
+						qsize--;												\
+					}															\
+					else {														\
+						e = p;													\
+						p = p->next;											\
+						psize--;												\
+					}															\
+					if (tail) {													\
+						tail->next = e;											\
+					}															\
+					else {														\
+						head = e;												\
+					}															\
+					e->prev = tail;												\
+					tail = e;													\
+				}																\
+				p = q;															\
+			}																	\
+			tail->next = NULL;													\
+			if (merges <= 1) {													\
+				break;															\
+			}																	\
+		}																		\
+		list->head = head;														\
+		list->tail = tail;														\
+	}																			\
+																				\
+	static inline void llh_##Type##_clear(LLHandle_##Type *list) {				\
+		if (!list->allocator || list->allocator->free) {						\
+			DS_STAT(&list->stats, frees, list->length);							\
+			ll_##Type##_clear_with(list->allocator, list->head);				\
+		}																		\
+		list->head = NULL;														\
+		list->tail = NULL;														\
+		list->length = 0;														\
 	}																			\
 
 #define DEFINE_LINKED_LIST_PTR(Type)												\
@@ -569,7 +1576,7 @@
 		struct LList_##Type##_ptr *prev;												\
 	} LList_##Type##_ptr;																\
 																				\
-	Type ll_##Type##_ptr_length(LList_##Type##_ptr *list) {								\
+	static inline int ll_##Type##_ptr_length(LList_##Type##_ptr *list) {		\
 		int count = 0;															\
 		for (; list != NULL; list = list->next) {								\
 			count += 1;															\
@@ -577,8 +1584,12 @@
 		return count;															\
 	}																			\
 																				\
-	LList_##Type##_ptr *ll_##Type##_ptr_push(LList_##Type##_ptr *node, Type *elm) {				\
-		LList_##Type##_ptr *l = malloc(sizeof(LList_##Type##_ptr));							\
+	static inline LList_##Type##_ptr *ll_##Type##_ptr_push_with(const DSAllocator *allocator, LList_##Type##_ptr *node, Type *elm) {	\
+		LList_##Type##_ptr *l = ds_alloc_with(allocator, sizeof(LList_##Type##_ptr));	\
+		if (!l) {																\
+			return NULL;														\
+		}																		\
+		DS_STAT(ds_stats_bound(), allocations, 1);								\
 		l->elm = elm;															\
 		l->prev = NULL;															\
 		l->next = NULL;															\
@@ -593,7 +1604,15 @@
 		return l;																\
 	}																			\
 																				\
-	LList_##Type##_ptr *ll_##Type##_ptr_pop(LList_##Type##_ptr *node) {							\
+	static inline LList_##Type##_ptr *ll_##Type##_ptr_push_in(DSArena *arena, LList_##Type##_ptr *node, Type *elm) {	\
+		return ll_##Type##_ptr_push_with(ds_arena_allocator(arena), node, elm);	\
+	}																			\
+																				\
+	static inline LList_##Type##_ptr *ll_##Type##_ptr_push(LList_##Type##_ptr *node, Type *elm) {	\
+		return ll_##Type##_ptr_push_with(NULL, node, elm);						\
+	}																			\
+																				\
+	static inline LList_##Type##_ptr *ll_##Type##_ptr_pop_with(const DSAllocator *allocator, LList_##Type##_ptr *node) {	\
 		LList_##Type##_ptr *prev = node->prev;										\
 		if (node->prev) {														\
 			node->prev->next = node->next;										\
@@ -601,12 +1620,25 @@
 		if (node->next) {														\
 			node->next->prev = node->prev;										\
 		}																		\
-		free(node);																\
+		ds_free_with(allocator, node, sizeof(LList_##Type##_ptr));				\
+		DS_STAT(ds_stats_bound(), frees, 1);									\
 		return prev;															\
 	}																			\
 																				\
-	LList_##Type##_ptr *ll_##Type##_ptr_insert(LList_##Type##_ptr *node, Type *elm) {			\
-		LList_##Type##_ptr *l = malloc(sizeof(LList_##Type##_ptr));							\
+	static inline LList_##Type##_ptr *ll_##Type##_ptr_pop_in(DSArena *arena, LList_##Type##_ptr *node) {	\
+		return ll_##Type##_ptr_pop_with(ds_arena_allocator(arena), node);		\
+	}																			\
+																				\
+	static inline LList_##Type##_ptr *ll_##Type##_ptr_pop(LList_##Type##_ptr *node) {	\
+		return ll_##Type##_ptr_pop_with(NULL, node);							\
+	}																			\
+																				\
+	static inline LList_##Type##_ptr *ll_##Type##_ptr_insert_with(const DSAllocator *allocator, LList_##Type##_ptr *node, Type *elm) {	\
+		LList_##Type##_ptr *l = ds_alloc_with(allocator, sizeof(LList_##Type##_ptr));	\
+		if (!l) {																\
+			return NULL;														\
+		}																		\
+		DS_STAT(ds_stats_bound(), allocations, 1);								\
 		l->elm = elm;															\
 		l->next = NULL;															\
 		l->prev = NULL;															\
@@ -621,7 +1653,15 @@
 		return l;																\
 	}																			\
 																				\
-	LList_##Type##_ptr *ll_##Type##_ptr_remove(LList_##Type##_ptr *node) {						\
+	static inline LList_##Type##_ptr *ll_##Type##_ptr_insert_in(DSArena *arena, LList_##Type##_ptr *node, Type *elm) {	\
+		return ll_##Type##_ptr_insert_with(ds_arena_allocator(arena), node, elm);	\
+	}																			\
+																				\
+	static inline LList_##Type##_ptr *ll_##Type##_ptr_insert(LList_##Type##_ptr *node, Type *elm) {	\
+		return ll_##Type##_ptr_insert_with(NULL, node, elm);					\
+	}																			\
+																				\
+	static inline LList_##Type##_ptr *ll_##Type##_ptr_remove_with(const DSAllocator *allocator, LList_##Type##_ptr *node) {	\
 		LList_##Type##_ptr *next = node->next;										\
 		if (node->prev) {														\
 			node->prev->next = node->next;										\
@@ -629,16 +1669,695 @@
 		if (node->next) {														\
 			node->next->prev = node->prev;										\
 		}																		\
-		free(node);																\
+		ds_free_with(allocator, node, sizeof(LList_##Type##_ptr));				\
+		DS_STAT(ds_stats_bound(), frees, 1);									\
 		return next;															\
 	}																			\
 																				\
-	void ll_##Type##_ptr_clear(LList_##Type##_ptr *head) {								\
+	static inline LList_##Type##_ptr *ll_##Type##_ptr_remove_in(DSArena *arena, LList_##Type##_ptr *node) {	\
+		return ll_##Type##_ptr_remove_with(ds_arena_allocator(arena), node);	\
+	}																			\
+																				\
+	static inline LList_##Type##_ptr *ll_##Type##_ptr_remove(LList_##Type##_ptr *node) {	\
+		return ll_##Type##_ptr_remove_with(NULL, node);							\
+	}																			\
+																				\
+	static inline void ll_##Type##_ptr_clear_with(const DSAllocator *allocator, LList_##Type##_ptr *head) {	\
 		LList_##Type##_ptr *next;														\
 		for (LList_##Type##_ptr *node = head; node != NULL; node = next) {			\
 			next = node->next;													\
-			free(node);															\
+			ds_free_with(allocator, node, sizeof(LList_##Type##_ptr));			\
+			DS_STAT(ds_stats_bound(), frees, 1);								\
+		}																		\
+	}																			\
+																				\
+	static inline void ll_##Type##_ptr_clear(LList_##Type##_ptr *head) {		\
+		ll_##Type##_ptr_clear_with(NULL, head);									\
+	}																			\
+																				\
+	typedef struct LLHandle_##Type##_ptr {										\
+		LList_##Type##_ptr *head;												\
+		LList_##Type##_ptr *tail;												\
+		int length;																\
+		const DSAllocator *allocator;											\
+		DS_STATS_MEMBER															\
+	} LLHandle_##Type##_ptr;													\
+																				\
+	static inline int llh_##Type##_ptr_length(LLHandle_##Type##_ptr *list) {	\
+		return list->length;													\
+	}																			\
+																				\
+	static inline const DSStats *llh_##Type##_ptr_stats(LLHandle_##Type##_ptr *list) {	\
+		return DS_STATS_OF(list);												\
+	}																			\
+																				\
+	static inline void llh_##Type##_ptr_link_front(LLHandle_##Type##_ptr *list, LList_##Type##_ptr *node) {	\
+		node->prev = NULL;														\
+		node->next = list->head;												\
+		if (list->head) {														\
+			list->head->prev = node;											\
+		}																		\
+		else {																	\
+			list->tail = node;													\
+		}																		\
+		list->head = node;														\
+		list->length += 1;														\
+	}																			\
+																				\
+	static inline void llh_##Type##_ptr_link_back(LLHandle_##Type##_ptr *list, LList_##Type##_ptr *node) {	\
+		node->next = NULL;														\
+		node->prev = list->tail;												\
+		if (list->tail) {														\
+			list->tail->next = node;											\
+		}																		\
+		else {																	\
+			list->head = node;													\
+		}																		\
+		list->tail = node;														\
+		list->length += 1;														\
+	}																			\
+																				\
+	static inline void llh_##Type##_ptr_unlink(LLHandle_##Type##_ptr *list, LList_##Type##_ptr *node) {	\
+		if (node->prev) {														\
+			node->prev->next = node->next;										\
+		}																		\
+		else {																	\
+			list->head = node->next;											\
+		}																		\
+		if (node->next) {														\
+			node->next->prev = node->prev;										\
+		}																		\
+		else {																	\
+			list->tail = node->prev;											\
+		}																		\
+		node->next = NULL;														\
+		node->prev = NULL;														\
+		list->length -= 1;														\
+	}																			\
+																				\
+	static inline LList_##Type##_ptr *llh_##Type##_ptr_push_front(LLHandle_##Type##_ptr *list, Type *elm) {	\
+		LList_##Type##_ptr *node = ds_alloc_with(list->allocator, sizeof(LList_##Type##_ptr));	\
+		DS_STAT(&list->stats, ops, 1);											\
+		DS_STAT(&list->stats, allocations, 1);									\
+		if (node) {																\
+			node->elm = elm;													\
+			llh_##Type##_ptr_link_front(list, node);							\
+		}																		\
+		return node;															\
+	}																			\
+																				\
+	static inline LList_##Type##_ptr *llh_##Type##_ptr_push_back(LLHandle_##Type##_ptr *list, Type *elm) {	\
+		LList_##Type##_ptr *node = ds_alloc_with(list->allocator, sizeof(LList_##Type##_ptr));	\
+		DS_STAT(&list->stats, ops, 1);											\
+		DS_STAT(&list->stats, allocations, 1);									\
+		if (node) {																\
+			node->elm = elm;													\
+			llh_##Type##_ptr_link_back(list, node);								\
+		}																		\
+		return node;															\
+	}																			\
+																				\
+	static inline Type *llh_##Type##_ptr_pop_front(LLHandle_##Type##_ptr *list) {	\
+		LList_##Type##_ptr *node = list->head;									\
+		Type *elm = node->elm;													\
+		llh_##Type##_ptr_unlink(list, node);									\
+		ds_free_with(list->allocator, node, sizeof(LList_##Type##_ptr));		\
+		DS_STAT(&list->stats, ops, 1);											\
+		DS_STAT(&list->stats, frees, 1);										\
+		return elm;																\
+	}																			\
+																				\
+	static inline Type *llh_##Type##_ptr_pop_back(LLHandle_##Type##_ptr *list) {	\
+		LList_##Type##_ptr *node = list->tail;									\
+		Type *elm = node->elm;													\
+		llh_##Type##_ptr_unlink(list, node);									\
+		ds_free_with(list->allocator, node, sizeof(LList_##Type##_ptr));		\
+		DS_STAT(&list->stats, ops, 1);											\
+		DS_STAT(&list->stats, frees, 1);										\
+		return elm;																\
+	}																			\
+																				\
+	static inline void llh_##Type##_ptr_remove(LLHandle_##Type##_ptr *list, LList_##Type##_ptr *node) {	\
+		llh_##Type##_ptr_unlink(list, node);									\
+		ds_free_with(list->allocator, node, sizeof(LList_##Type##_ptr));		\
+		DS_STAT(&list->stats, ops, 1);											\
+		DS_STAT(&list->stats, frees, 1);										\
+	}																			\
+																				\
+	static inline void llh_##Type##_ptr_move_front(LLHandle_##Type##_ptr *list, LList_##Type##_ptr *node) {	\
+		if (list->head != node) {												\
+			llh_##Type##_ptr_unlink(list, node);								\
+			llh_##Type##_ptr_link_front(list, node);							\
+		}																		\
+	}																			\
+																				\
+	static inline void llh_##Type##_ptr_move_back(LLHandle_##Type##_ptr *list, LList_##Type##_ptr *node) {	\
+		if (list->tail != node) {												\
+			llh_##Type##_ptr_unlink(list, node);								\
+			llh_##Type##_ptr_link_back(list, node);								\
+		}																		\
+	}																			\
+																				\
+	static inline void llh_##Type##_ptr_splice(LLHandle_##Type##_ptr *list, LList_##Type##_ptr *pos, LLHandle_##Type##_ptr *other) {	\
+		LList_##Type##_ptr *next;												\
+		if (!other->head) {														\
+			return;																\
+		}																		\
+		next = pos ? pos->next : list->head;									\
+		other->head->prev = pos;												\
+		other->tail->next = next;												\
+		if (pos) {																\
+			pos->next = other->head;											\
+		}																		\
+		else {																	\
+			list->head = other->head;											\
+		}																		\
+		if (next) {																\
+			next->prev = other->tail;											\
+		}																		\
+		else {																	\
+			list->tail = other->tail;											\
+		}																		\
+		list->length += other->length;											\
+		other->head = NULL;														\
+		other->tail = NULL;														\
+		other->length = 0;														\
+	}																			\
+																				\
+	static inline void llh_##Type##_ptr_split(LLHandle_##Type##_ptr *list, LList_##Type##_ptr *node, int count, LLHandle_##Type##_ptr *out) {	\
+		if (count < 0) {														\
+			count = 0;															\
+			for (LList_##Type##_ptr *n = node; n != NULL; n = n->next) {		\
+				count += 1;														\
+			}																	\
+		}																		\
+		out->head = node;														\
+		out->tail = list->tail;													\
+		out->length = count;													\
+		list->tail = node->prev;												\
+		if (node->prev) {														\
+			node->prev->next = NULL;											\
+		}																		\
+		else {																	\
+			list->head = NULL;													\
+		}																		\
+		node->prev = NULL;														\
+		list->length -= count;													\
+	}																			\
+																				\
+	static inline void llh_##Type##_ptr_sort(LLHandle_##Type##_ptr *list, int (*compare)(const Type *a, const Type *b)) {	\
+		DS_STAT(&list->stats, ops, 1);											\
+		LList_##Type##_ptr *head = list->head;									\
+		LList_##Type##_ptr *tail = NULL;										\
+		if (!head) {															\
+			return;																\
+		}																		\
+		for (int width = 1; ; width *= 2) {										\
+			LList_##Type##_ptr *p = head;										\
+			int merges = 0;														\
+			head = NULL;														\
+			tail = NULL;														\
+			while (p) {															\
+				LList_##Type##_ptr *q = p;										\
+				int psize = 0;													\
+				int qsize = width;												\
+				merges += 1;													\
+				for (; psize < width && q; psize++) {							\
+					q = q->next;												\
+				}																\
+				while (psize > 0 || (qsize > 0 && q)) {							\
+					if (psize > 0 && qsize > 0 && q) {							\
+						DS_STAT(&list->stats, compares, 1);						\
+					}															\
+					LList_##Type##_ptr *e;										\
+					if (psize == 0 || (qsize > 0 && q && compare(q->elm, p->elm) < 0)) {	\
+						e = q;													\
+						q = q->next;											\
+						qsize--;												\
+					}															\
+					else {														\
+						e = p;													\
+						p = p->next;											\
+						psize--;												\
+					}															\
+					if (tail) {													\
+						tail->next = e;											\
+					}															\
+					else {														\
+						head = e;												\
+					}															\
+					e->prev = tail;												\
+					tail = e;													\
+				}																\
+				p = q;															\
+			}																	\
+			tail->next = NULL;													\
+			if (merges <= 1) {													\
+				break;															\
+			}																	\
+		}																		\
+		list->head = head;														\
+		list->tail = tail;														\
+	}																			\
+																				\
+	static inline void llh_##Type##_ptr_clear(LLHandle_##Type##_ptr *list) {	\
+		if (!list->allocator || list->allocator->free) {						\
+			DS_STAT(&list->stats, frees, list->length);							\
+			ll_##Type##_ptr_clear_with(list->allocator, list->head);			\
 		}																		\
+		list->head = NULL;														\
+		list->tail = NULL;														\
+		list->length = 0;														\
+	}																			\
+
+
+/*
+ * Chunked List
+ * Generic doubly linked list of chunks, also known as an unrolled linked list.
+ * Memory is allocated for each chunk of elements instead of each element.
+ *
+ * Each node holds an array of up to chunk elements, so iterating over the
+ * list reads mostly contiguous memory, and the pointers are paid once per
+ * chunk instead of once per element. The list keeps a reference to its
+ * first and last nodes and counts its elements, so length is O(1).
+ *
+ * It can be used as a deque unlimited in size: push_head, pop_head,
+ * push_tail and pop_tail are O(1). As a queue, push with push_tail and pop
+ * with pop_head. The node emptied last is kept as a spare, so a queue that
+ * oscillates around a chunk boundary does not allocate on every push.
+ * Pushing returns 0 if the memory for a new chunk could not be allocated,
+ * and 1 otherwise.
+ *
+ * Random access with get and set walks the chunks from the closest end, so
+ * it is O(n / chunk). The function splice moves all elements of a list to
+ * the tail of another by linking the chunks, and it does not copy elements.
+ *
+ * Prepare the list by using the macro DEFINE_CHUNKED_LIST. The first
+ * parameter is the type of the element and the second is the number of
+ * elements in each chunk. An empty list is a zeroed CkList_<type>. To take
+ * the chunks from a DSAllocator, set the allocator member before pushing;
+ * lists spliced together must share it.
+ *
+ * DEFINE_CHUNKED_LIST(int, 64)
+ * CkList_int
+ * ck_int_length		(list)					-> int
+ * ck_int_push_head		(list, elm)				-> int
+ * ck_int_pop_head		(list)					-> elm
+ * ck_int_peek_head		(list)					-> elm
+ * ck_int_push_tail		(list, elm)				-> int
+ * ck_int_pop_tail		(list)					-> elm
+ * ck_int_peek_tail		(list)					-> elm
+ * ck_int_set			(list, index, elm)
+ * ck_int_get			(list, index)			-> elm
+ * ck_int_splice		(list, other)
+ * ck_int_clear			(list)
+ *
+ * Members of the list:
+ * - first: the first node, or NULL if the list is empty.
+ * - last: the last node, or NULL if the list is empty.
+ * - length: the number of elements in the list. Do not change this value.
+ * - allocator: the allocator of the chunks, or NULL for malloc and free.
+ *
+ * Members of the node CkNode_<type>:
+ * - elms: the elements of the chunk, valid from head to tail - 1.
+ * - next, prev: the neighbouring nodes.
+ *
+ * Iterate over the list like this:
+ *
+ * for (CkNode_int *node = list.first; node != NULL; node = node->next) {
+ *     for (int i = node->head; i < node->tail; i++) {
+ *         node->elms[i];
+ *     }
+ * }
+ *
+ */
+#define DEFINE_CHUNKED_LIST(Type, chunk)										\
+	typedef struct CkNode_##Type {												\
+		struct CkNode_##Type *next;												\
+		struct CkNode_##Type *prev;												\
+		int head;																\
+		int tail;																\
+		Type elms[chunk];														\
+	} CkNode_##Type;															\
+																				\
+	typedef struct CkList_##Type {												\
+		CkNode_##Type *first;													\
+		CkNode_##Type *last;													\
+		CkNode_##Type *spare;													\
+		int length;																\
+		const DSAllocator *allocator;											\
+	} CkList_##Type;															\
+																				\
+	static inline CkNode_##Type *ck_##Type##_new_node(CkList_##Type *list, int offset) {	\
+		CkNode_##Type *node = list->spare;										\
+		if (node) {																\
+			list->spare = NULL;													\
+		}																		\
+		else {																	\
+			node = ds_alloc_with(list->allocator, sizeof(CkNode_##Type));		\
+			if (!node) {														\
+				return NULL;													\
+			}																	\
+		}																		\
+		node->next = NULL;														\
+		node->prev = NULL;														\
+		node->head = offset;													\
+		node->tail = offset;													\
+		return node;															\
+	}																			\
+																				\
+	static inline void ck_##Type##_drop_node(CkList_##Type *list, CkNode_##Type *node) {	\
+		if (node->prev) {														\
+			node->prev->next = node->next;										\
+		}																		\
+		else {																	\
+			list->first = node->next;											\
+		}																		\
+		if (node->next) {														\
+			node->next->prev = node->prev;										\
+		}																		\
+		else {																	\
+			list->last = node->prev;											\
+		}																		\
+		if (list->spare) {														\
+			ds_free_with(list->allocator, list->spare, sizeof(CkNode_##Type));	\
+		}																		\
+		list->spare = node;														\
+	}																			\
+																				\
+	static inline int ck_##Type##_length(CkList_##Type *list) {					\
+		return list->length;													\
+	}																			\
+																				\
+	static inline int ck_##Type##_push_tail(CkList_##Type *list, Type elm) {	\
+		CkNode_##Type *node = list->last;										\
+		if (!node || node->tail == chunk) {										\
+			node = ck_##Type##_new_node(list, 0);								\
+			if (!node) {														\
+				return 0;														\
+			}																	\
+			node->prev = list->last;											\
+			if (list->last) {													\
+				list->last->next = node;										\
+			}																	\
+			else {																\
+				list->first = node;												\
+			}																	\
+			list->last = node;													\
+		}																		\
+		node->elms[node->tail++] = elm;											\
+		list->length += 1;														\
+		return 1;																\
+	}																			\
+																				\
+	static inline int ck_##Type##_push_head(CkList_##Type *list, Type elm) {	\
+		CkNode_##Type *node = list->first;										\
+		if (!node || node->head == 0) {											\
+			node = ck_##Type##_new_node(list, chunk);							\
+			if (!node) {														\
+				return 0;														\
+			}																	\
+			node->next = list->first;											\
+			if (list->first) {													\
+				list->first->prev = node;										\
+			}																	\
+			else {																\
+				list->last = node;												\
+			}																	\
+			list->first = node;													\
+		}																		\
+		node->elms[--node->head] = elm;											\
+		list->length += 1;														\
+		return 1;																\
+	}																			\
+																				\
+	static inline Type ck_##Type##_pop_tail(CkList_##Type *list) {				\
+		CkNode_##Type *node = list->last;										\
+		Type elm = node->elms[--node->tail];									\
+		if (node->head == node->tail) {											\
+			ck_##Type##_drop_node(list, node);									\
+		}																		\
+		list->length -= 1;														\
+		return elm;																\
+	}																			\
+																				\
+	static inline Type ck_##Type##_pop_head(CkList_##Type *list) {				\
+		CkNode_##Type *node = list->first;										\
+		Type elm = node->elms[node->head++];									\
+		if (node->head == node->tail) {											\
+			ck_##Type##_drop_node(list, node);									\
+		}																		\
+		list->length -= 1;														\
+		return elm;																\
+	}																			\
+																				\
+	static inline Type ck_##Type##_peek_tail(CkList_##Type *list) {				\
+		return list->last->elms[list->last->tail - 1];							\
+	}																			\
+																				\
+	static inline Type ck_##Type##_peek_head(CkList_##Type *list) {				\
+		return list->first->elms[list->first->head];							\
+	}																			\
+																				\
+	static inline Type *ck_##Type##_at(CkList_##Type *list, int index) {		\
+		CkNode_##Type *node;													\
+		if (index < list->length / 2) {											\
+			for (node = list->first; index >= node->tail - node->head; node = node->next) {	\
+				index -= node->tail - node->head;								\
+			}																	\
+			return &node->elms[node->head + index];								\
+		}																		\
+		else {																	\
+			index = list->length - 1 - index;									\
+			for (node = list->last; index >= node->tail - node->head; node = node->prev) {	\
+				index -= node->tail - node->head;								\
+			}																	\
+			return &node->elms[node->tail - 1 - index];							\
+		}																		\
+	}																			\
+																				\
+	static inline void ck_##Type##_set(CkList_##Type *list, int index, Type elm) {	\
+		*ck_##Type##_at(list, index) = elm;										\
+	}																			\
+																				\
+	static inline Type ck_##Type##_get(CkList_##Type *list, int index) {		\
+		return *ck_##Type##_at(list, index);									\
+	}																			\
+																				\
+	static inline void ck_##Type##_splice(CkList_##Type *list, CkList_##Type *other) {	\
+		if (!other->first) {													\
+			return;																\
+		}																		\
+		if (list->last) {														\
+			list->last->next = other->first;									\
+			other->first->prev = list->last;									\
+		}																		\
+		else {																	\
+			list->first = other->first;											\
+		}																		\
+		list->last = other->last;												\
+		list->length += other->length;											\
+		other->first = NULL;													\
+		other->last = NULL;														\
+		other->length = 0;														\
+	}																			\
+																				\
+	static inline void ck_##Type##_clear(CkList_##Type *list) {					\
+		CkNode_##Type *next;													\
+		for (CkNode_##Type *node = list->first; node != NULL; node = next) {	\
+			next = node->next;													\
+			ds_free_with(list->allocator, node, sizeof(CkNode_##Type));			\
+		}																		\
+		if (list->spare) {														\
+			ds_free_with(list->allocator, list->spare, sizeof(CkNode_##Type));	\
+		}																		\
+		list->first = NULL;														\
+		list->last = NULL;														\
+		list->spare = NULL;														\
+		list->length = 0;														\
+	}																			\
+
+
+/*
+ * Intrusive Linked List
+ * Generic doubly linked list of objects that embed their own links.
+ * No memory is allocated.
+ *
+ * Instead of allocating a node that holds the element, the element holds
+ * the node: embed an ILink member in the struct and the list links the
+ * objects through it. The list never owns the objects, so an object can be
+ * in several lists at once by embedding one ILink for each list, and moving
+ * it between lists costs no allocation. Given a link, the object is found
+ * by subtracting the offset of the member, with ds_container_of.
+ *
+ * Prepare the list by using the macro DEFINE_INTRUSIVE_LIST. The first
+ * parameter is a name for the list, the second is the type of the objects
+ * and the third is the name of the ILink member. This will create a struct
+ * called IList_<name>, with functions prefixed il_<name>_. An empty list is
+ * a zeroed IList_<name>. An object must be in a list at most once for each
+ * link, and must be removed before it is freed.
+ *
+ * typedef struct Conn { int fd; ILink lru; ILink owner; } Conn;
+ * DEFINE_INTRUSIVE_LIST(lru, Conn, lru)
+ * IList_lru
+ * il_lru_length		(list)					-> int
+ * il_lru_first			(list)					-> obj
+ * il_lru_last			(list)					-> obj
+ * il_lru_next			(obj)					-> obj
+ * il_lru_prev			(obj)					-> obj
+ * il_lru_push_front	(list, obj)
+ * il_lru_push_back		(list, obj)
+ * il_lru_pop_front		(list)					-> obj
+ * il_lru_pop_back		(list)					-> obj
+ * il_lru_insert_after	(list, pos, obj)
+ * il_lru_remove		(list, obj)
+ * il_lru_move_front	(list, obj)
+ * il_lru_move_back		(list, obj)
+ * il_lru_splice		(list, other)
+ * il_lru_clear			(list)
+ *
+ * The functions first, last, next, prev and the pops return NULL when there
+ * is no such object. The function splice moves all the objects of another
+ * list to the tail of the list in O(1). The function clear empties the list
+ * without touching the objects.
+ *
+ */
+typedef struct ILink {
+	struct ILink *next;
+	struct ILink *prev;
+} ILink;
+
+#define DEFINE_INTRUSIVE_LIST(Name, Type, member)								\
+	typedef struct IList_##Name {												\
+		ILink *head;															\
+		ILink *tail;															\
+		int length;																\
+	} IList_##Name;																\
+																				\
+	static inline Type *il_##Name##_entry(ILink *link) {						\
+		return link ? ds_container_of(link, Type, member) : NULL;				\
+	}																			\
+																				\
+	static inline int il_##Name##_length(IList_##Name *list) {					\
+		return list->length;													\
+	}																			\
+																				\
+	static inline Type *il_##Name##_first(IList_##Name *list) {					\
+		return il_##Name##_entry(list->head);									\
+	}																			\
+																				\
+	static inline Type *il_##Name##_last(IList_##Name *list) {					\
+		return il_##Name##_entry(list->tail);									\
+	}																			\
+																				\
+	static inline Type *il_##Name##_next(Type *obj) {							\
+		return il_##Name##_entry(obj->member.next);								\
+	}																			\
+																				\
+	static inline Type *il_##Name##_prev(Type *obj) {							\
+		return il_##Name##_entry(obj->member.prev);								\
+	}																			\
+																				\
+	static inline void il_##Name##_insert_after(IList_##Name *list, Type *pos, Type *obj) {	\
+		ILink *link = &obj->member;												\
+		ILink *prev = pos ? &pos->member : NULL;								\
+		ILink *next = prev ? prev->next : list->head;							\
+		link->prev = prev;														\
+		link->next = next;														\
+		if (prev) {																\
+			prev->next = link;													\
+		}																		\
+		else {																	\
+			list->head = link;													\
+		}																		\
+		if (next) {																\
+			next->prev = link;													\
+		}																		\
+		else {																	\
+			list->tail = link;													\
+		}																		\
+		list->length += 1;														\
+	}																			\
+																				\
+	static inline void il_##Name##_push_front(IList_##Name *list, Type *obj) {	\
+		il_##Name##_insert_after(list, NULL, obj);								\
+	}																			\
+																				\
+	static inline void il_##Name##_push_back(IList_##Name *list, Type *obj) {	\
+		il_##Name##_insert_after(list, il_##Name##_last(list), obj);			\
+	}																			\
+																				\
+	static inline void il_##Name##_remove(IList_##Name *list, Type *obj) {		\
+		ILink *link = &obj->member;												\
+		if (link->prev) {														\
+			link->prev->next = link->next;										\
+		}																		\
+		else {																	\
+			list->head = link->next;											\
+		}																		\
+		if (link->next) {														\
+			link->next->prev = link->prev;										\
+		}																		\
+		else {																	\
+			list->tail = link->prev;											\
+		}																		\
+		link->next = NULL;														\
+		link->prev = NULL;														\
+		list->length -= 1;														\
+	}																			\
+																				\
+	static inline Type *il_##Name##_pop_front(IList_##Name *list) {				\
+		Type *obj = il_##Name##_first(list);									\
+		if (obj) {																\
+			il_##Name##_remove(list, obj);										\
+		}																		\
+		return obj;																\
+	}																			\
+																				\
+	static inline Type *il_##Name##_pop_back(IList_##Name *list) {				\
+		Type *obj = il_##Name##_last(list);										\
+		if (obj) {																\
+			il_##Name##_remove(list, obj);										\
+		}																		\
+		return obj;																\
+	}																			\
+																				\
+	static inline void il_##Name##_move_front(IList_##Name *list, Type *obj) {	\
+		if (list->head != &obj->member) {										\
+			il_##Name##_remove(list, obj);										\
+			il_##Name##_push_front(list, obj);									\
+		}																		\
+	}																			\
+																				\
+	static inline void il_##Name##_move_back(IList_##Name *list, Type *obj) {	\
+		if (list->tail != &obj->member) {										\
+			il_##Name##_remove(list, obj);										\
+			il_##Name##_push_back(list, obj);									\
+		}																		\
+	}																			\
+																				\
+	static inline void il_##Name##_splice(IList_##Name *list, IList_##Name *other) {	\
+		if (!other->head) {														\
+			return;																\
+		}																		\
+		if (list->tail) {														\
+			list->tail->next = other->head;										\
+			other->head->prev = list->tail;										\
+		}																		\
+		else {																	\
+			list->head = other->head;											\
+		}																		\
+		list->tail = other->tail;												\
+		list->length += other->length;											\
+		other->head = NULL;														\
+		other->tail = NULL;														\
+		other->length = 0;														\
+	}																			\
+																				\
+	static inline void il_##Name##_clear(IList_##Name *list) {					\
+		list->head = NULL;														\
+		list->tail = NULL;														\
+		list->length = 0;														\
 	}																			\
 
 
@@ -3,13 +3,54 @@
 #include <stdlib.h>
 #include <string.h>
 #include <assert.h>
+#include <time.h>
 
 
+int compare_longs(const long *a, const long *b) {
+	return (*a > *b) - (*a < *b);
+}
+
+typedef struct Ref {
+	int *ptr;
+} Ref;
+
+typedef int Slot;
+
+typedef struct Conn {
+	int fd;
+	ILink lru;
+	ILink owner;
+} Conn;
+
+DEFINE_ARRAY_LIST(int, 12)
+DEFINE_ARRAY_LIST(Slot, 32)
+DEFINE_ARRAY_LIST(Ref, 12)
+DEFINE_ARRAY_LIST_PTR(int, 12)
+DEFINE_CIRCULAR_ARRAY_LIST(int, 12)
+DEFINE_CIRCULAR_ARRAY_LIST_PTR(int, 12)
+DEFINE_STACK(int, 12)
+DEFINE_STACK_PTR(int, 12)
+DEFINE_QUEUE(int, 12)
+DEFINE_QUEUE_PTR(int, 12)
+DEFINE_HEAP(long, 64, compare_longs)
+DEFINE_ARRAY_LIST_DYN(int)
+DEFINE_ARRAY_LIST_DYN(long)
+DEFINE_CIRCULAR_ARRAY_LIST_DYN(int)
+DEFINE_STACK_DYN(int)
+DEFINE_QUEUE_DYN(int)
+DEFINE_LINKED_LIST(int)
+DEFINE_LINKED_LIST_PTR(int)
+DEFINE_LINKED_LIST(long)
+DEFINE_CHUNKED_LIST(long, 8)
+DEFINE_LINKED_LIST_PTR(long)
+DEFINE_CHUNKED_LIST(int, 4)
+DEFINE_INTRUSIVE_LIST(lru, Conn, lru)
+DEFINE_INTRUSIVE_LIST(owner, Conn, owner)
+
 int main(void) {
 
 	// array list
 	{
-		DEFINE_ARRAY_LIST(int, 12)
 		List_int list = { 0 };
 
 		for (int i = 0; i < 10; i++) {
@@ -47,21 +88,16 @@ int main(void) {
 
 	}
 	{
-		DEFINE_ARRAY_LIST(int, 32)
-		List_int list = { 0 };
+		List_Slot list = { 0 };
 		for (int i = 0; i < 10; i++) {
-			al_int_push(&list, i);
+			al_Slot_push(&list, i);
 		}
 		assert(list.length == 10);
 	}
 	{
-		typedef struct Ref {
-			int *ptr;
-		} Ref;
 		int v[] = { 0, 1, 2, 3, 4, 5, 6, 7, 8, 9 };
 		int w[] = { 0, 11, 22, 33, 44, 55, 66, 77, 88, 99 };
 
-		DEFINE_ARRAY_LIST(Ref, 12);
 
 		List_Ref list = { 0 };
 
@@ -100,7 +136,6 @@ int main(void) {
 
 	}
 	{
-		DEFINE_ARRAY_LIST_PTR(int, 12)
 		int v[] = { 0, 1, 2, 3, 4, 5, 6, 7, 8, 9 };
 		int w[] = { 0, 11, 22, 33, 44, 55, 66, 77, 88, 99 };
 
@@ -144,7 +179,6 @@ int main(void) {
 
 	// circular array list
 	{
-		DEFINE_CIRCULAR_ARRAY_LIST(int, 12)
 		CList_int list = { 0 };
 
 		for (int i = 0; i < 10; i++) {
@@ -211,7 +245,6 @@ int main(void) {
 
 	}
 	{
-		DEFINE_CIRCULAR_ARRAY_LIST_PTR(int, 12)
 		CList_int_ptr list = { 0 };
 		int v[] = { 0, 1, 2, 3, 4, 5, 6, 7, 8, 9 };
 		int w[] = { 0, 11, 22, 33, 44, 55, 66, 77, 88, 99 };
@@ -282,7 +315,6 @@ int main(void) {
 
 	// stack
 	{
-		DEFINE_STACK(int, 12)
 		Stack_int stack = { 0 };
 
 		for (int i = 0; i < 10; i++) {
@@ -297,7 +329,6 @@ int main(void) {
 		}
 	}
 	{
-		DEFINE_STACK_PTR(int, 12)
 		int v[] = { 0, 1, 2, 3, 4, 5, 6, 7, 8, 9 };
 		Stack_int_ptr stack = { 0 };
 
@@ -315,7 +346,6 @@ int main(void) {
 
 	// queue
 	{
-		DEFINE_QUEUE(int, 12)
 		Queue_int queue = { 0 };
 
 		for (int i = 0; i < 10; i++) {
@@ -342,7 +372,6 @@ int main(void) {
 		assert(queue.head == queue.tail);
 	}
 	{
-		DEFINE_QUEUE_PTR(int, 12)
 		int v[] = { 0, 1, 2, 3, 4, 5, 6, 7, 8, 9 };
 		Queue_int_ptr queue = { 0 };
 
@@ -370,9 +399,185 @@ int main(void) {
 		assert(queue.head == queue.tail);
 	}
 
+	// heap
+	{
+		Heap_long heap = { 0 };
+		long values[] = { 5, 3, 8, 1, 9, 0, 2, 7, 4, 6 };
+		int handles[10];
+
+		for (int i = 0; i < 10; i++) {
+			handles[i] = hp_long_push(&heap, values[i]);
+		}
+		assert(hp_long_length(&heap) == 10);
+		assert(hp_long_peek(&heap) == 0);
+		for (int i = 0; i < 10; i++) {
+			assert(hp_long_get(&heap, handles[i]) == values[i]);
+		}
+
+		hp_long_update(&heap, handles[2], -1);
+		assert(hp_long_peek(&heap) == -1);
+		hp_long_update(&heap, handles[2], 8);
+		assert(hp_long_peek(&heap) == 0);
+		hp_long_remove(&heap, handles[5]);
+		assert(hp_long_length(&heap) == 9);
+
+		for (long i = 1; i < 10; i++) {
+			assert(hp_long_pop(&heap) == i);
+		}
+		assert(hp_long_length(&heap) == 0);
+
+		// handles are reused
+		int h = hp_long_push(&heap, 11);
+		assert(h < 10);
+		assert(hp_long_get(&heap, h) == 11);
+		hp_long_clear(&heap);
+
+		srand(time(NULL));
+		for (int it = 0; it < 20; it++) {
+			long array[64];
+			int length = rand() % 64;
+			for (int i = 0; i < length; i++) {
+				array[i] = rand() % 100;
+			}
+			hp_long_heapify(&heap, array, length);
+			assert(hp_long_length(&heap) == length);
+			for (int i = 0; i < length; i++) {
+				assert(hp_long_get(&heap, i) == array[i]);
+			}
+			long p = -1;
+			while (hp_long_length(&heap) > 0) {
+				long n = hp_long_pop(&heap);
+				assert(n >= p);
+				p = n;
+			}
+		}
+	}
+
+	// dynamic array list
+	{
+		List_int_dyn list;
+		assert(al_int_dyn_init(&list, 12));
+		assert(list.capacity == 12);
+
+		for (int i = 0; i < 10; i++) {
+			al_int_dyn_push(&list, i);
+		}
+		assert(list.length == 10);
+		for (int i = 0; i < 10; i++) {
+			assert(al_int_dyn_get(&list, i) == i);
+		}
+		al_int_dyn_insert(&list, 4, 44);
+		assert(list.length == 11);
+		assert(al_int_dyn_get(&list, 4) == 44);
+		al_int_dyn_remove(&list, 4);
+		assert(al_int_dyn_get(&list, 4) == 4);
+		al_int_dyn_set(&list, 0, 11);
+		assert(al_int_dyn_get(&list, 0) == 11);
+		for (int i = 9; i > 0; i--) {
+			assert(al_int_dyn_pop(&list) == i);
+		}
+		al_int_dyn_clear(&list);
+		assert(list.length == 0);
+
+		for (int i = 0; i < 1000; i++) {
+			assert(al_int_dyn_push_grow(&list, i));
+		}
+		assert(list.length == 1000);
+		assert(list.capacity >= 1000);
+		for (int i = 0; i < 1000; i++) {
+			assert(al_int_dyn_get(&list, i) == i);
+		}
+		al_int_dyn_free(&list);
+		assert(list.elms == NULL);
+	}
+	{
+		// large enough to be aligned to a huge page, too big for the stack
+		List_long_dyn list;
+		int max = 1 << 20;
+		assert(al_long_dyn_init(&list, max));
+		for (int i = 0; i < max; i++) {
+			al_long_dyn_push(&list, i);
+		}
+		assert(al_long_dyn_get(&list, max - 1) == max - 1);
+		al_long_dyn_free(&list);
+	}
+	{
+		CList_int_dyn list;
+		assert(cl_int_dyn_init(&list, 12));
+		assert(list.capacity == 16);
+
+		for (int i = 0; i < 10; i++) {
+			cl_int_dyn_push_head(&list, i);
+		}
+		assert(cl_int_dyn_length(&list) == 10);
+		for (int i = 0; i < 10; i++) {
+			assert(cl_int_dyn_get(&list, i) == 9 - i);
+		}
+		cl_int_dyn_insert(&list, 4, 44);
+		assert(cl_int_dyn_get(&list, 4) == 44);
+		assert(cl_int_dyn_length(&list) == 11);
+		cl_int_dyn_remove(&list, 4);
+		assert(cl_int_dyn_get(&list, 4) == 5);
+		cl_int_dyn_set(&list, 0, 99);
+		assert(cl_int_dyn_get(&list, 0) == 99);
+		assert(cl_int_dyn_pop_head(&list) == 99);
+		assert(cl_int_dyn_pop_tail(&list) == 0);
+		cl_int_dyn_push_tail(&list, 100);
+		assert(cl_int_dyn_length(&list) == 9);
+
+		// grow while the head is negative
+		for (int i = 0; i < 100; i++) {
+			assert(cl_int_dyn_push_grow(&list, i));
+		}
+		assert(cl_int_dyn_length(&list) == 109);
+		assert(list.head == 0);
+		assert(cl_int_dyn_get(&list, 0) == 8);
+		assert(cl_int_dyn_get(&list, 8) == 100);
+		assert(cl_int_dyn_get(&list, 108) == 99);
+
+		cl_int_dyn_clear(&list);
+		assert(cl_int_dyn_length(&list) == 0);
+		cl_int_dyn_free(&list);
+	}
+	{
+		Stack_int_dyn stack;
+		assert(st_int_dyn_init(&stack, 4));
+
+		for (int i = 0; i < 10; i++) {
+			assert(st_int_dyn_push_grow(&stack, i));
+		}
+		assert(st_int_dyn_peek(&stack) == 9);
+		assert(st_int_dyn_length(&stack) == 10);
+		for (int i = 9; i >= 0; i--) {
+			assert(st_int_dyn_pop(&stack) == i);
+		}
+		st_int_dyn_free(&stack);
+	}
+	{
+		Queue_int_dyn queue;
+		assert(qu_int_dyn_init(&queue, 12));
+
+		for (int i = 0; i < 10; i++) {
+			qu_int_dyn_push(&queue, i);
+		}
+		assert(qu_int_dyn_peek(&queue) == 0);
+		assert(qu_int_dyn_length(&queue) == 10);
+		for (int i = 0; i < 5; i++) {
+			assert(qu_int_dyn_pop(&queue) == i);
+		}
+		for (int i = 10; i < 40; i++) {
+			assert(qu_int_dyn_push_grow(&queue, i));
+		}
+		assert(qu_int_dyn_length(&queue) == 35);
+		for (int i = 5; i < 40; i++) {
+			assert(qu_int_dyn_pop(&queue) == i);
+		}
+		assert(qu_int_dyn_length(&queue) == 0);
+		qu_int_dyn_free(&queue);
+	}
+
 	// linked list
 	{
-		DEFINE_LINKED_LIST(int)
 		LList_int *head = ll_int_push(NULL, 0);
 		LList_int *tail = head;
 		for (int i = 1; i < 10; i++) {
@@ -399,6 +604,7 @@ int main(void) {
 
 		tail = ll_int_insert(NULL, 0);
 		head = tail;
+		ll_int_clear(head);
 
 		tail = ll_int_insert(NULL, 9);
 		head = tail;
@@ -428,7 +634,6 @@ int main(void) {
 
 	}
 	{
-		DEFINE_LINKED_LIST_PTR(int)
 		int v[] = { 0, 1, 2, 3, 4, 5, 6, 7, 8, 9 };
 		int w[] = { 0, 11, 22, 33, 44, 55, 66, 77, 88, 99 };
 		LList_int_ptr *head = ll_int_ptr_push(NULL, &v[0]);
@@ -457,6 +662,7 @@ int main(void) {
 
 		tail = ll_int_ptr_insert(NULL, &v[0]);
 		head = tail;
+		ll_int_ptr_clear(head);
 
 		tail = ll_int_ptr_insert(NULL, &v[9]);
 		head = tail;
@@ -485,5 +691,300 @@ int main(void) {
 		tail = NULL;
 
 	}
+
+	// linked list handle
+	{
+		LLHandle_long list = { 0 };
+
+		for (long i = 0; i < 10; i++) {
+			assert(llh_long_push_back(&list, i) != NULL);
+		}
+		assert(llh_long_length(&list) == 10);
+		assert(ll_long_length(list.head) == 10);
+		assert(list.head->elm == 0);
+		assert(list.tail->elm == 9);
+
+		assert(llh_long_push_front(&list, -1) != NULL);
+		assert(llh_long_pop_front(&list) == -1);
+		assert(llh_long_pop_back(&list) == 9);
+		assert(llh_long_length(&list) == 9);
+
+		// move to front, as in an LRU list
+		LList_long *node = list.head->next->next;
+		llh_long_move_front(&list, node);
+		assert(list.head == node);
+		assert(list.head->elm == 2);
+		assert(list.head->next->elm == 0);
+		llh_long_move_back(&list, node);
+		assert(list.tail == node);
+		assert(list.tail->prev->elm == 8);
+		assert(llh_long_length(&list) == 9);
+
+		// split and splice
+		LLHandle_long other = { 0 };
+		llh_long_split(&list, list.head->next->next->next, -1, &other);
+		assert(llh_long_length(&list) == 3);
+		assert(llh_long_length(&other) == 6);
+		assert(list.tail->elm == 3);
+		assert(list.tail->next == NULL);
+		assert(other.head->elm == 4);
+		assert(other.head->prev == NULL);
+		assert(other.tail->elm == 2);
+
+		llh_long_splice(&list, NULL, &other);
+		assert(llh_long_length(&list) == 9);
+		assert(llh_long_length(&other) == 0);
+		assert(list.head->elm == 4);
+		assert(list.tail->elm == 3);
+
+		llh_long_split(&list, list.tail, 1, &other);
+		llh_long_splice(&list, list.head, &other);
+		assert(list.head->next->elm == 3);
+		assert(ll_long_length(list.head) == 9);
+
+		llh_long_sort(&list, compare_longs);
+		long i = 0;
+		for (LList_long *node = list.head; node != NULL; node = node->next) {
+			assert(node->elm == i++);
+		}
+		i = 9;
+		for (LList_long *node = list.tail; node != NULL; node = node->prev) {
+			assert(node->elm == --i);
+		}
+
+		llh_long_remove(&list, list.head->next);
+		assert(llh_long_length(&list) == 8);
+		assert(list.head->next->elm == 2);
+
+		llh_long_clear(&list);
+		assert(list.head == NULL);
+		assert(llh_long_length(&list) == 0);
+
+		srand(time(NULL));
+		for (int i = 0; i < 1000; i++) {
+			llh_long_push_back(&list, rand() % 100);
+		}
+		llh_long_sort(&list, compare_longs);
+		assert(llh_long_length(&list) == 1000);
+		for (LList_long *node = list.head; node->next != NULL; node = node->next) {
+			assert(node->elm <= node->next->elm);
+			assert(node->next->prev == node);
+		}
+		llh_long_clear(&list);
+
+		// nodes from an arena
+		DSArena *arena = ds_arena_new(256);
+		list.allocator = ds_arena_allocator(arena);
+		for (long i = 0; i < 100; i++) {
+			assert(llh_long_push_back(&list, i) != NULL);
+		}
+		assert(llh_long_pop_front(&list) == 0);
+		llh_long_remove(&list, list.tail);
+		assert(llh_long_length(&list) == 98);
+		llh_long_clear(&list);
+		assert(list.head == NULL);
+
+		ds_arena_reset(arena);
+		LList_long *head = ll_long_push_in(arena, NULL, 1);
+		ll_long_push_in(arena, head, 2);
+		ll_long_insert_in(arena, head->next, 0);
+		assert(ll_long_length(head) == 3);
+		assert(head->next->elm == 0);
+		ll_long_remove_in(arena, head->next);
+		assert(ll_long_length(head) == 2);
+
+		// containers with an allocator
+		List_long_dyn dyn;
+		assert(al_long_dyn_init_with(&dyn, ds_arena_allocator(arena), 4));
+		for (long i = 0; i < 100; i++) {
+			assert(al_long_dyn_push_grow(&dyn, i));
+		}
+		assert(al_long_dyn_get(&dyn, 99) == 99);
+		al_long_dyn_free(&dyn);
+
+		CkList_long chunks = { 0 };
+		chunks.allocator = &ds_malloc_allocator;
+		for (long i = 0; i < 100; i++) {
+			assert(ck_long_push_tail(&chunks, i));
+		}
+		assert(ck_long_get(&chunks, 50) == 50);
+		ck_long_clear(&chunks);
+		ds_arena_delete(arena);
+	}
+	{
+		long v[] = { 5, 3, 8, 1, 9, 0, 2, 7, 4, 6 };
+		LLHandle_long_ptr list = { 0 };
+
+		for (int i = 0; i < 10; i++) {
+			llh_long_ptr_push_front(&list, &v[i]);
+		}
+		assert(llh_long_ptr_length(&list) == 10);
+		assert(*list.head->elm == 6);
+
+		llh_long_ptr_sort(&list, compare_longs);
+		long i = 0;
+		for (LList_long_ptr *node = list.head; node != NULL; node = node->next) {
+			assert(*node->elm == i++);
+		}
+		assert(*llh_long_ptr_pop_back(&list) == 9);
+		assert(*llh_long_ptr_pop_front(&list) == 0);
+		assert(llh_long_ptr_length(&list) == 8);
+		llh_long_ptr_clear(&list);
+	}
+
+	// chunked list
+	{
+		CkList_int list = { 0 };
+
+		for (int i = 0; i < 10; i++) {
+			assert(ck_int_push_tail(&list, i));
+		}
+		assert(ck_int_length(&list) == 10);
+		for (int i = 0; i < 10; i++) {
+			assert(ck_int_get(&list, i) == i);
+		}
+		assert(ck_int_peek_head(&list) == 0);
+		assert(ck_int_peek_tail(&list) == 9);
+
+		for (int i = 1; i <= 10; i++) {
+			assert(ck_int_push_head(&list, -i));
+		}
+		assert(ck_int_length(&list) == 20);
+		for (int i = 0; i < 20; i++) {
+			assert(ck_int_get(&list, i) == i - 10);
+		}
+		ck_int_set(&list, 15, 55);
+		assert(ck_int_get(&list, 15) == 55);
+		ck_int_set(&list, 15, 5);
+
+		int i = -10;
+		for (CkNode_int *node = list.first; node != NULL; node = node->next) {
+			for (int j = node->head; j < node->tail; j++) {
+				assert(node->elms[j] == i++);
+			}
+		}
+		assert(i == 10);
+
+		for (int i = -10; i < 0; i++) {
+			assert(ck_int_pop_head(&list) == i);
+		}
+		for (int i = 9; i >= 5; i--) {
+			assert(ck_int_pop_tail(&list) == i);
+		}
+		assert(ck_int_length(&list) == 5);
+
+		CkList_int other = { 0 };
+		for (int i = 5; i < 10; i++) {
+			assert(ck_int_push_tail(&other, i));
+		}
+		ck_int_splice(&list, &other);
+		assert(ck_int_length(&list) == 10);
+		assert(ck_int_length(&other) == 0);
+		assert(other.first == NULL);
+		for (int i = 0; i < 10; i++) {
+			assert(ck_int_pop_head(&list) == i);
+		}
+		assert(ck_int_length(&list) == 0);
+		assert(list.first == NULL);
+		assert(list.last == NULL);
+
+		// queue around a chunk boundary
+		for (int i = 0; i < 100; i++) {
+			assert(ck_int_push_tail(&list, i));
+			assert(ck_int_pop_head(&list) == i);
+		}
+		assert(ck_int_length(&list) == 0);
+
+		ck_int_clear(&list);
+		ck_int_clear(&other);
+	}
+
+	// intrusive list
+	{
+		Conn conns[10];
+		IList_lru lru = { 0 };
+		IList_owner even = { 0 };
+		IList_owner odd = { 0 };
+
+		for (int i = 0; i < 10; i++) {
+			conns[i].fd = i;
+			il_lru_push_back(&lru, &conns[i]);
+			il_owner_push_front(i % 2 ? &odd : &even, &conns[i]);
+		}
+		assert(il_lru_length(&lru) == 10);
+		assert(il_owner_length(&even) == 5);
+		assert(il_owner_length(&odd) == 5);
+
+		int i = 0;
+		for (Conn *c = il_lru_first(&lru); c != NULL; c = il_lru_next(c)) {
+			assert(c->fd == i++);
+		}
+		i = 8;
+		for (Conn *c = il_owner_first(&even); c != NULL; c = il_owner_next(c)) {
+			assert(c->fd == i);
+			i -= 2;
+		}
+
+		// the same object, moved in one list, stays in place in the other
+		il_lru_move_front(&lru, &conns[6]);
+		assert(il_lru_first(&lru) == &conns[6]);
+		assert(il_lru_next(&conns[5]) == &conns[7]);
+		assert(il_owner_next(&conns[8]) == &conns[6]);
+		il_lru_move_back(&lru, &conns[6]);
+		assert(il_lru_last(&lru) == &conns[6]);
+		assert(il_lru_prev(&conns[6]) == &conns[9]);
+
+		il_owner_remove(&even, &conns[4]);
+		assert(il_owner_length(&even) == 4);
+		assert(il_owner_next(&conns[6]) == &conns[2]);
+		il_owner_insert_after(&even, &conns[2], &conns[4]);
+		assert(il_owner_next(&conns[2]) == &conns[4]);
+		assert(il_owner_last(&even) == &conns[0]);
+
+		il_owner_splice(&even, &odd);
+		assert(il_owner_length(&even) == 10);
+		assert(il_owner_length(&odd) == 0);
+		assert(il_owner_next(&conns[0]) == &conns[9]);
+
+		assert(il_lru_pop_front(&lru) == &conns[0]);
+		assert(il_lru_pop_back(&lru) == &conns[6]);
+		assert(il_lru_length(&lru) == 8);
+		il_lru_clear(&lru);
+		assert(il_lru_pop_front(&lru) == NULL);
+	}
+	{
+		LLHandle_long list = { 0 };
+		DSStats bound;
+		for (long i = 0; i < 10; i++) {
+			llh_long_push_back(&list, 9 - i);
+		}
+		llh_long_sort(&list, compare_longs);
+		llh_long_pop_front(&list);
+#ifdef DS_STATS
+		const DSStats *stats = llh_long_stats(&list);
+		assert(stats->ops == 12);
+		assert(stats->allocations == 10);
+		assert(stats->frees == 1);
+		assert(stats->compares > 0);
+#else
+		assert(llh_long_stats(&list) == NULL);
+#endif
+		llh_long_clear(&list);
+
+		ds_stats_reset(&bound);
+		ds_stats_bind(&bound);
+		LList_long *head = ll_long_push(NULL, 1);
+		ll_long_push(head, 2);
+		ll_long_remove(head->next);
+		ll_long_clear(head);
+		ds_stats_bind(NULL);
+#ifdef DS_STATS
+		assert(bound.allocations == 2);
+		assert(bound.frees == 2);
+#else
+		assert(bound.allocations == 0);
+#endif
+	}
+
 	return 0;
 }
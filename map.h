@@ -0,0 +1,479 @@
+#ifndef __MAP__H__
+#define __MAP__H__
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "commons.h"
+
+/*
+ * Hash Map
+ * Generic, fast hash map with open addressing.
+ * Memory is allocated for the table, which grows as elements are added.
+ *
+ * The entries are kept in a single array, and collisions are resolved by
+ * probing the next slots (Robin Hood hashing): an entry that is far from
+ * its home slot takes the place of one that is closer to its own, so that
+ * all probe sequences are short and a lookup stops as soon as it meets an
+ * entry closer to home than the key would be. Each slot has a control
+ * number with the distance of its entry from home plus one, or 0 if the
+ * slot is empty, kept apart from the entries so that probing reads a
+ * compact array.
+ *
+ * Removing an entry shifts the following entries of the cluster back by
+ * one slot, so there are no tombstones and lookups do not slow down after
+ * many removals.
+ *
+ * When the table is more than 7/8 full, a table twice as big is allocated
+ * and the entries are moved to it a few at a time, in every put and
+ * remove, instead of all at once, so no single operation pays for the
+ * whole rehash. Until all entries are moved, lookups search both tables.
+ *
+ * Prepare the map by using the macro DEFINE_HASH_MAP. The parameters are
+ * the type of the key, the type of the value, a hash function
+ * unsigned long Hash(const Key *key) and an equality function
+ * int Eq(const Key *a, const Key *b) that returns nonzero if the keys are
+ * equal. This will create a struct called HashMap_<key>_<value> with
+ * functions prefixed hm_<key>_<value>_. An empty map is a zeroed
+ * HashMap_<key>_<value>, or one prepared with init to reserve a capacity.
+ * To take the memory of the tables from a DSAllocator, prepare the map with
+ * init_with, or set the allocator member of a zeroed map.
+ *
+ * The functions init and put return 0 if memory could not be allocated,
+ * and 1 otherwise. The functions get and remove return 1 if the key was
+ * found, and 0 otherwise. The function find returns a pointer to the value
+ * of a key, or NULL. This pointer, like the entries returned by next, is
+ * valid until the next put or remove.
+ *
+ * DEFINE_HASH_MAP(long, int, hash_long, eq_long)
+ * HashMap_long_int
+ * hm_long_int_init		(map, capacity)			-> int
+ * hm_long_int_init_with	(map, allocator, capacity)	-> int
+ * hm_long_int_free		(map)
+ * hm_long_int_length	(map)					-> unsigned long
+ * hm_long_int_put		(map, key, value)		-> int
+ * hm_long_int_get		(map, key, &value)		-> int
+ * hm_long_int_find		(map, key)				-> value pointer
+ * hm_long_int_remove	(map, key)				-> int
+ * hm_long_int_next		(map, &iterator)		-> entry pointer
+ * hm_long_int_clear	(map)
+ *
+ * Iterate over the map like this:
+ *
+ * unsigned long it = 0;
+ * for (HMEntry_long_int *e; (e = hm_long_int_next(&map, &it)) != NULL; ) {
+ *     e->key; e->value;
+ * }
+ *
+ */
+
+#define HM_MIN_CAPACITY 8
+#define HM_MIGRATE_STEP 4
+
+#define DEFINE_HASH_MAP(Key, Value, Hash, Eq)									\
+	typedef struct HMEntry_##Key##_##Value {									\
+		Key key;																\
+		Value value;															\
+	} HMEntry_##Key##_##Value;													\
+																				\
+	typedef struct HashMap_##Key##_##Value {									\
+		unsigned short *control;												\
+		HMEntry_##Key##_##Value *entries;										\
+		unsigned long capacity;													\
+		unsigned long length;													\
+		unsigned short *old_control;											\
+		HMEntry_##Key##_##Value *old_entries;									\
+		unsigned long old_capacity;												\
+		unsigned long old_start;												\
+		unsigned long old_done;													\
+		const DSAllocator *allocator;											\
+	} HashMap_##Key##_##Value;													\
+																				\
+	static inline unsigned long hm_##Key##_##Value##_length(HashMap_##Key##_##Value *map) {	\
+		return map->length;														\
+	}																			\
+																				\
+	/* free a table of capacity slots, which may be NULL */						\
+	static inline void hm_##Key##_##Value##_free_table(HashMap_##Key##_##Value *map, unsigned short *control, HMEntry_##Key##_##Value *entries, unsigned long capacity) {	\
+		if (control) {															\
+			ds_free_with(map->allocator, control, capacity * sizeof(unsigned short));	\
+		}																		\
+		if (entries) {															\
+			ds_free_with(map->allocator, entries, capacity * sizeof(HMEntry_##Key##_##Value));	\
+		}																		\
+	}																			\
+																				\
+	/* allocate a table of capacity empty slots */								\
+	static inline int hm_##Key##_##Value##_new_table(HashMap_##Key##_##Value *map, unsigned short **control, HMEntry_##Key##_##Value **entries, unsigned long capacity) {	\
+		*control = ds_alloc_with(map->allocator, capacity * sizeof(unsigned short));	\
+		*entries = ds_alloc_with(map->allocator, capacity * sizeof(HMEntry_##Key##_##Value));	\
+		if (!*control || !*entries) {											\
+			hm_##Key##_##Value##_free_table(map, *control, *entries, capacity);	\
+			*control = NULL;													\
+			*entries = NULL;													\
+			return 0;															\
+		}																		\
+		memset(*control, 0, capacity * sizeof(unsigned short));					\
+		return 1;																\
+	}																			\
+																				\
+	static inline int hm_##Key##_##Value##_init_with(HashMap_##Key##_##Value *map, const DSAllocator *allocator, unsigned long capacity) {	\
+		unsigned long c = HM_MIN_CAPACITY;										\
+		while (c - c / 8 < capacity) {											\
+			c *= 2;																\
+		}																		\
+		memset(map, 0, sizeof(HashMap_##Key##_##Value));						\
+		map->allocator = allocator;												\
+		if (!hm_##Key##_##Value##_new_table(map, &map->control, &map->entries, c)) {	\
+			return 0;															\
+		}																		\
+		map->capacity = c;														\
+		return 1;																\
+	}																			\
+																				\
+	static inline int hm_##Key##_##Value##_init(HashMap_##Key##_##Value *map, unsigned long capacity) {	\
+		return hm_##Key##_##Value##_init_with(map, NULL, capacity);				\
+	}																			\
+																				\
+	static inline void hm_##Key##_##Value##_free(HashMap_##Key##_##Value *map) {	\
+		const DSAllocator *allocator = map->allocator;							\
+		hm_##Key##_##Value##_free_table(map, map->control, map->entries, map->capacity);	\
+		hm_##Key##_##Value##_free_table(map, map->old_control, map->old_entries, map->old_capacity);	\
+		memset(map, 0, sizeof(HashMap_##Key##_##Value));						\
+		map->allocator = allocator;												\
+	}																			\
+																				\
+	/* index of the key in the current table, or capacity */					\
+	static inline unsigned long hm_##Key##_##Value##_probe(HashMap_##Key##_##Value *map, const Key *key, unsigned long hash) {	\
+		unsigned long mask = map->capacity - 1;									\
+		unsigned long pos = hash & mask;										\
+		unsigned long dist = 1;													\
+		if (map->capacity == 0) {												\
+			return 0;															\
+		}																		\
+		for (;; pos = (pos + 1) & mask, dist++) {								\
+			unsigned long c = map->control[pos];								\
+			if (c < dist) {														\
+				return map->capacity;											\
+			}																	\
+			if (c == dist && Eq(&map->entries[pos].key, key)) {					\
+				return pos;														\
+			}																	\
+		}																		\
+	}																			\
+																				\
+	/* index of the key in the old table, or old_capacity. */					\
+	/* Probes skip the slots that were already moved. */						\
+	static inline unsigned long hm_##Key##_##Value##_probe_old(HashMap_##Key##_##Value *map, const Key *key, unsigned long hash) {	\
+		unsigned long mask = map->old_capacity - 1;								\
+		unsigned long pos = hash & mask;										\
+		unsigned long dist = 1;													\
+		if (!map->old_control) {												\
+			return map->old_capacity;											\
+		}																		\
+		for (;; pos = (pos + 1) & mask, dist++) {								\
+			unsigned long offset = (pos - map->old_start) & mask;				\
+			unsigned long c;													\
+			if (offset < map->old_done) {										\
+				dist += map->old_done - offset;									\
+				pos = (map->old_start + map->old_done) & mask;					\
+				if (map->old_done == map->old_capacity) {						\
+					return map->old_capacity;									\
+				}																\
+			}																	\
+			c = map->old_control[pos];											\
+			if (c < dist) {														\
+				return map->old_capacity;										\
+			}																	\
+			if (c == dist && Eq(&map->old_entries[pos].key, key)) {				\
+				return pos;														\
+			}																	\
+		}																		\
+	}																			\
+																				\
+	/* insert an entry that is not in the table, there must be room for it */	\
+	static inline void hm_##Key##_##Value##_place(HashMap_##Key##_##Value *map, HMEntry_##Key##_##Value entry, unsigned long hash) {	\
+		unsigned long mask = map->capacity - 1;									\
+		unsigned long pos = hash & mask;										\
+		unsigned short dist = 1;												\
+		for (;; pos = (pos + 1) & mask, dist++) {								\
+			unsigned short c = map->control[pos];								\
+			if (c == 0) {														\
+				map->control[pos] = dist;										\
+				map->entries[pos] = entry;										\
+				return;															\
+			}																	\
+			if (c < dist) {														\
+				HMEntry_##Key##_##Value tmp = map->entries[pos];				\
+				map->entries[pos] = entry;										\
+				map->control[pos] = dist;										\
+				entry = tmp;													\
+				dist = c;														\
+			}																	\
+		}																		\
+	}																			\
+																				\
+	/* empty a slot and shift the rest of its cluster back */					\
+	static inline void hm_##Key##_##Value##_erase(unsigned short *control, HMEntry_##Key##_##Value *entries, unsigned long mask, unsigned long pos) {	\
+		unsigned long next = (pos + 1) & mask;									\
+		while (control[next] > 1) {												\
+			control[pos] = control[next] - 1;									\
+			entries[pos] = entries[next];										\
+			pos = next;															\
+			next = (next + 1) & mask;											\
+		}																		\
+		control[pos] = 0;														\
+	}																			\
+																				\
+	static inline void hm_##Key##_##Value##_migrate(HashMap_##Key##_##Value *map, unsigned long steps) {	\
+		unsigned long mask = map->old_capacity - 1;								\
+		if (!map->old_control) {												\
+			return;																\
+		}																		\
+		for (; steps > 0 && map->old_done < map->old_capacity; steps--) {		\
+			unsigned long pos = (map->old_start + map->old_done) & mask;		\
+			if (map->old_control[pos]) {										\
+				HMEntry_##Key##_##Value *e = &map->old_entries[pos];			\
+				hm_##Key##_##Value##_place(map, *e, Hash(&e->key));				\
+				map->old_control[pos] = 0;										\
+			}																	\
+			map->old_done++;													\
+		}																		\
+		if (map->old_done == map->old_capacity) {								\
+			hm_##Key##_##Value##_free_table(map, map->old_control, map->old_entries, map->old_capacity);	\
+			map->old_control = NULL;											\
+			map->old_entries = NULL;											\
+			map->old_capacity = 0;												\
+		}																		\
+	}																			\
+																				\
+	static inline int hm_##Key##_##Value##_grow(HashMap_##Key##_##Value *map) {	\
+		unsigned long capacity = map->capacity ? map->capacity * 2 : HM_MIN_CAPACITY;	\
+		unsigned short *control;												\
+		HMEntry_##Key##_##Value *entries;										\
+		hm_##Key##_##Value##_migrate(map, (unsigned long) -1);					\
+		if (!hm_##Key##_##Value##_new_table(map, &control, &entries, capacity)) {	\
+			return 0;															\
+		}																		\
+		if (map->capacity) {													\
+			/* start draining at the beginning of a cluster */					\
+			unsigned long start = 0;											\
+			while (map->control[start] > 1) {									\
+				start++;														\
+			}																	\
+			map->old_control = map->control;									\
+			map->old_entries = map->entries;									\
+			map->old_capacity = map->capacity;									\
+			map->old_start = start;												\
+			map->old_done = 0;													\
+		}																		\
+		map->control = control;													\
+		map->entries = entries;													\
+		map->capacity = capacity;												\
+		return 1;																\
+	}																			\
+																				\
+	static inline Value *hm_##Key##_##Value##_find(HashMap_##Key##_##Value *map, Key key) {	\
+		unsigned long hash = Hash(&key);										\
+		unsigned long pos = hm_##Key##_##Value##_probe(map, &key, hash);		\
+		if (pos < map->capacity) {												\
+			return &map->entries[pos].value;									\
+		}																		\
+		pos = hm_##Key##_##Value##_probe_old(map, &key, hash);					\
+		if (pos < map->old_capacity) {											\
+			return &map->old_entries[pos].value;								\
+		}																		\
+		return NULL;															\
+	}																			\
+																				\
+	static inline int hm_##Key##_##Value##_get(HashMap_##Key##_##Value *map, Key key, Value *out_value) {	\
+		Value *value = hm_##Key##_##Value##_find(map, key);						\
+		if (value) {															\
+			*out_value = *value;												\
+		}																		\
+		return value != NULL;													\
+	}																			\
+																				\
+	static inline int hm_##Key##_##Value##_put(HashMap_##Key##_##Value *map, Key key, Value value) {	\
+		unsigned long hash = Hash(&key);										\
+		Value *found;															\
+		hm_##Key##_##Value##_migrate(map, HM_MIGRATE_STEP);						\
+		found = hm_##Key##_##Value##_find(map, key);							\
+		if (found) {															\
+			*found = value;														\
+			return 1;															\
+		}																		\
+		if (map->length + 1 > map->capacity - map->capacity / 8) {				\
+			if (!hm_##Key##_##Value##_grow(map)) {								\
+				return 0;														\
+			}																	\
+		}																		\
+		hm_##Key##_##Value##_place(map, (HMEntry_##Key##_##Value) { key, value }, hash);	\
+		map->length++;															\
+		return 1;																\
+	}																			\
+																				\
+	static inline int hm_##Key##_##Value##_remove(HashMap_##Key##_##Value *map, Key key) {	\
+		unsigned long hash = Hash(&key);										\
+		unsigned long pos;														\
+		hm_##Key##_##Value##_migrate(map, HM_MIGRATE_STEP);						\
+		pos = hm_##Key##_##Value##_probe(map, &key, hash);						\
+		if (pos < map->capacity) {												\
+			hm_##Key##_##Value##_erase(map->control, map->entries, map->capacity - 1, pos);	\
+			map->length--;														\
+			return 1;															\
+		}																		\
+		pos = hm_##Key##_##Value##_probe_old(map, &key, hash);					\
+		if (pos < map->old_capacity) {											\
+			hm_##Key##_##Value##_erase(map->old_control, map->old_entries, map->old_capacity - 1, pos);	\
+			map->length--;														\
+			return 1;															\
+		}																		\
+		return 0;																\
+	}																			\
+																				\
+	static inline HMEntry_##Key##_##Value *hm_##Key##_##Value##_next(HashMap_##Key##_##Value *map, unsigned long *iterator) {	\
+		for (; *iterator < map->old_capacity; (*iterator)++) {					\
+			if (map->old_control[*iterator]) {									\
+				return &map->old_entries[(*iterator)++];						\
+			}																	\
+		}																		\
+		for (; *iterator < map->old_capacity + map->capacity; (*iterator)++) {	\
+			unsigned long pos = *iterator - map->old_capacity;					\
+			if (map->control[pos]) {											\
+				(*iterator)++;													\
+				return &map->entries[pos];										\
+			}																	\
+		}																		\
+		return NULL;															\
+	}																			\
+																				\
+	static inline void hm_##Key##_##Value##_clear(HashMap_##Key##_##Value *map) {	\
+		if (map->capacity) {													\
+			memset(map->control, 0, map->capacity * sizeof(unsigned short));	\
+		}																		\
+		hm_##Key##_##Value##_free_table(map, map->old_control, map->old_entries, map->old_capacity);	\
+		map->old_control = NULL;												\
+		map->old_entries = NULL;												\
+		map->old_capacity = 0;													\
+		map->length = 0;														\
+	}																			\
+
+/*
+ * Hash Set
+ * A hash map without values, with the same hashing as DEFINE_HASH_MAP.
+ *
+ * Prepare the set by using the macro DEFINE_HASH_SET. The parameters are
+ * the type of the key, the hash function and the equality function, as in
+ * DEFINE_HASH_MAP. This will create a struct called HashSet_<key> with
+ * functions prefixed hs_<key>_, besides the hash map they are built on.
+ * An empty set is a zeroed HashSet_<key>.
+ *
+ * The set operations union, intersection and difference write their result
+ * into dst, which is cleared first and must not be one of the operands.
+ * Intersection iterates over the smaller operand and looks its keys up in
+ * the larger. The functions init, add and the set operations return 0 if
+ * memory could not be allocated, and 1 otherwise.
+ *
+ * DEFINE_HASH_SET(long, hash_long, eq_long)
+ * HashSet_long
+ * hs_long_init			(set, capacity)			-> int
+ * hs_long_init_with	(set, allocator, capacity)	-> int
+ * hs_long_free			(set)
+ * hs_long_length		(set)					-> unsigned long
+ * hs_long_add			(set, key)				-> int
+ * hs_long_contains		(set, key)				-> int
+ * hs_long_remove		(set, key)				-> int
+ * hs_long_next			(set, &iterator)		-> key pointer
+ * hs_long_clear		(set)
+ * hs_long_union		(dst, a, b)				-> int
+ * hs_long_intersection	(dst, a, b)				-> int
+ * hs_long_difference	(dst, a, b)				-> int
+ *
+ */
+typedef unsigned char HSUnit;
+
+#define DEFINE_HASH_SET(Key, Hash, Eq)											\
+	DEFINE_HASH_MAP(Key, HSUnit, Hash, Eq)										\
+																				\
+	typedef HashMap_##Key##_HSUnit HashSet_##Key;								\
+																				\
+	static inline int hs_##Key##_init(HashSet_##Key *set, unsigned long capacity) {	\
+		return hm_##Key##_HSUnit_init(set, capacity);							\
+	}																			\
+																				\
+	static inline int hs_##Key##_init_with(HashSet_##Key *set, const DSAllocator *allocator, unsigned long capacity) {	\
+		return hm_##Key##_HSUnit_init_with(set, allocator, capacity);			\
+	}																			\
+																				\
+	static inline void hs_##Key##_free(HashSet_##Key *set) {					\
+		hm_##Key##_HSUnit_free(set);											\
+	}																			\
+																				\
+	static inline unsigned long hs_##Key##_length(HashSet_##Key *set) {			\
+		return set->length;														\
+	}																			\
+																				\
+	static inline int hs_##Key##_add(HashSet_##Key *set, Key key) {				\
+		return hm_##Key##_HSUnit_put(set, key, 0);								\
+	}																			\
+																				\
+	static inline int hs_##Key##_contains(HashSet_##Key *set, Key key) {		\
+		return hm_##Key##_HSUnit_find(set, key) != NULL;						\
+	}																			\
+																				\
+	static inline int hs_##Key##_remove(HashSet_##Key *set, Key key) {			\
+		return hm_##Key##_HSUnit_remove(set, key);								\
+	}																			\
+																				\
+	static inline Key *hs_##Key##_next(HashSet_##Key *set, unsigned long *iterator) {	\
+		HMEntry_##Key##_HSUnit *entry = hm_##Key##_HSUnit_next(set, iterator);	\
+		return entry ? &entry->key : NULL;										\
+	}																			\
+																				\
+	static inline void hs_##Key##_clear(HashSet_##Key *set) {					\
+		hm_##Key##_HSUnit_clear(set);											\
+	}																			\
+																				\
+	/* add all keys of src that are not in unless */							\
+	static inline int hs_##Key##_add_all(HashSet_##Key *dst, HashSet_##Key *src, HashSet_##Key *unless) {	\
+		unsigned long it = 0;													\
+		for (Key *key; (key = hs_##Key##_next(src, &it)) != NULL; ) {			\
+			if (unless && hs_##Key##_contains(unless, *key)) {					\
+				continue;														\
+			}																	\
+			if (!hs_##Key##_add(dst, *key)) {									\
+				return 0;														\
+			}																	\
+		}																		\
+		return 1;																\
+	}																			\
+																				\
+	static inline int hs_##Key##_union(HashSet_##Key *dst, HashSet_##Key *a, HashSet_##Key *b) {	\
+		hs_##Key##_clear(dst);													\
+		return hs_##Key##_add_all(dst, a, NULL) && hs_##Key##_add_all(dst, b, NULL);	\
+	}																			\
+																				\
+	static inline int hs_##Key##_intersection(HashSet_##Key *dst, HashSet_##Key *a, HashSet_##Key *b) {	\
+		unsigned long it = 0;													\
+		hs_##Key##_clear(dst);													\
+		if (a->length > b->length) {											\
+			HashSet_##Key *tmp = a;												\
+			a = b;																\
+			b = tmp;															\
+		}																		\
+		for (Key *key; (key = hs_##Key##_next(a, &it)) != NULL; ) {				\
+			if (hs_##Key##_contains(b, *key) && !hs_##Key##_add(dst, *key)) {	\
+				return 0;														\
+			}																	\
+		}																		\
+		return 1;																\
+	}																			\
+																				\
+	static inline int hs_##Key##_difference(HashSet_##Key *dst, HashSet_##Key *a, HashSet_##Key *b) {	\
+		hs_##Key##_clear(dst);													\
+		return hs_##Key##_add_all(dst, a, b);									\
+	}																			\
+
+
+#endif  // __MAP__H__
@@ -0,0 +1,184 @@
+#include "map.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <assert.h>
+#include <time.h>
+
+
+unsigned long hash_long(const long *key) {
+	return ds_hash_ulong((unsigned long) *key);
+}
+
+// all keys in few buckets, to make long clusters
+unsigned long hash_long_poor(const long *key) {
+	return (unsigned long) (*key % 4);
+}
+
+int eq_long(const long *a, const long *b) {
+	return *a == *b;
+}
+
+DEFINE_HASH_MAP(long, int, hash_long, eq_long)
+DEFINE_HASH_SET(long, hash_long, eq_long)
+
+typedef long PoorKey;
+unsigned long hash_poor(const PoorKey *key) {
+	return hash_long_poor(key);
+}
+int eq_poor(const PoorKey *a, const PoorKey *b) {
+	return *a == *b;
+}
+
+DEFINE_HASH_MAP(PoorKey, long, hash_poor, eq_poor)
+
+int main(void) {
+
+	{
+		HashMap_long_int map = { 0 };
+		assert(hm_long_int_length(&map) == 0);
+		assert(hm_long_int_find(&map, 1) == NULL);
+		assert(hm_long_int_remove(&map, 1) == 0);
+
+		for (long i = 0; i < 1000; i++) {
+			assert(hm_long_int_put(&map, i, (int) i * 2));
+		}
+		assert(hm_long_int_length(&map) == 1000);
+		for (long i = 0; i < 1000; i++) {
+			int value;
+			assert(hm_long_int_get(&map, i, &value));
+			assert(value == i * 2);
+		}
+		assert(hm_long_int_find(&map, 1000) == NULL);
+
+		// update
+		assert(hm_long_int_put(&map, 10, -1));
+		assert(*hm_long_int_find(&map, 10) == -1);
+		assert(hm_long_int_length(&map) == 1000);
+		*hm_long_int_find(&map, 10) = 20;
+
+		for (long i = 0; i < 1000; i += 2) {
+			assert(hm_long_int_remove(&map, i));
+		}
+		assert(hm_long_int_length(&map) == 500);
+		for (long i = 0; i < 1000; i++) {
+			assert((hm_long_int_find(&map, i) != NULL) == (i % 2 == 1));
+		}
+
+		unsigned long it = 0;
+		unsigned long count = 0;
+		for (HMEntry_long_int *e; (e = hm_long_int_next(&map, &it)) != NULL; ) {
+			assert(e->key % 2 == 1);
+			assert(e->value == e->key * 2);
+			count++;
+		}
+		assert(count == 500);
+
+		hm_long_int_clear(&map);
+		assert(hm_long_int_length(&map) == 0);
+		assert(hm_long_int_find(&map, 1) == NULL);
+		hm_long_int_free(&map);
+	}
+
+	// random operations against a reference, through many rehashes
+	{
+		HashMap_long_int map;
+		HashMap_PoorKey_long poor = { 0 };
+		const int max_key = 5000;
+		int *reference = calloc(max_key, sizeof(int));
+		assert(hm_long_int_init(&map, 10));
+
+		srand(time(NULL));
+		for (int op = 0; op < 100000; op++) {
+			long key = rand() % max_key;
+			if (rand() % 3) {
+				int value = rand() % 1000 + 1;
+				assert(hm_long_int_put(&map, key, value));
+				assert(hm_PoorKey_long_put(&poor, key, value));
+				reference[key] = value;
+			}
+			else {
+				assert(hm_long_int_remove(&map, key) == (reference[key] != 0));
+				assert(hm_PoorKey_long_remove(&poor, key) == (reference[key] != 0));
+				reference[key] = 0;
+			}
+			if (op % 1000 == 0) {
+				unsigned long length = 0;
+				for (long k = 0; k < max_key; k++) {
+					int *value = hm_long_int_find(&map, k);
+					long *poor_value = hm_PoorKey_long_find(&poor, k);
+					assert(reference[k] ? value && *value == reference[k] : value == NULL);
+					assert(reference[k] ? poor_value && *poor_value == reference[k] : poor_value == NULL);
+					length += reference[k] != 0;
+				}
+				assert(hm_long_int_length(&map) == length);
+				assert(hm_PoorKey_long_length(&poor) == length);
+			}
+		}
+		free(reference);
+		hm_long_int_free(&map);
+		hm_PoorKey_long_free(&poor);
+	}
+
+	// hash set
+	{
+		HashSet_long a = { 0 };
+		HashSet_long b = { 0 };
+		HashSet_long dst = { 0 };
+		for (long i = 0; i < 100; i++) {
+			assert(hs_long_add(&a, i));
+		}
+		for (long i = 50; i < 1000; i += 2) {
+			assert(hs_long_add(&b, i));
+		}
+		assert(hs_long_add(&a, 5));
+		assert(hs_long_length(&a) == 100);
+		assert(hs_long_length(&b) == 475);
+		assert(hs_long_contains(&a, 99));
+		assert(!hs_long_contains(&a, 100));
+
+		assert(hs_long_union(&dst, &a, &b));
+		assert(hs_long_length(&dst) == 100 + 475 - 25);
+		assert(hs_long_intersection(&dst, &a, &b));
+		assert(hs_long_length(&dst) == 25);
+		unsigned long it = 0;
+		for (long *key; (key = hs_long_next(&dst, &it)) != NULL; ) {
+			assert(*key >= 50 && *key < 100 && *key % 2 == 0);
+		}
+		assert(hs_long_intersection(&dst, &b, &a));
+		assert(hs_long_length(&dst) == 25);
+		assert(hs_long_difference(&dst, &a, &b));
+		assert(hs_long_length(&dst) == 75);
+		assert(hs_long_contains(&dst, 51));
+		assert(!hs_long_contains(&dst, 52));
+
+		assert(hs_long_remove(&a, 5));
+		assert(!hs_long_remove(&a, 5));
+		hs_long_clear(&a);
+		assert(hs_long_length(&a) == 0);
+
+		hs_long_free(&a);
+		hs_long_free(&b);
+		hs_long_free(&dst);
+	}
+
+	// tables from an arena, which are never freed piece by piece
+	{
+		DSArena *arena = ds_arena_new(4096);
+		HashMap_long_int map;
+		assert(hm_long_int_init_with(&map, ds_arena_allocator(arena), 0));
+		for (long i = 0; i < 1000; i++) {
+			assert(hm_long_int_put(&map, i, (int) i));
+		}
+		for (long i = 0; i < 1000; i += 2) {
+			assert(hm_long_int_remove(&map, i));
+		}
+		assert(hm_long_int_length(&map) == 500);
+		assert(*hm_long_int_find(&map, 999) == 999);
+		hm_long_int_free(&map);
+		assert(map.allocator == ds_arena_allocator(arena));
+		ds_arena_delete(arena);
+	}
+
+	return 0;
+}
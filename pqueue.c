@@ -0,0 +1,220 @@
+#include "pqueue.h"
+#include <stdlib.h>
+#include <string.h>
+
+#define RECORD(pq, i) ((pq)->list->array + (i) * (pq)->list->data_size)
+#define TMP(pq) RECORD(pq, (pq)->list->max_length)
+
+static void place(PQueue *pq, unsigned long index, unsigned long handle);
+static void sift_up(PQueue *pq, unsigned long index);
+static void sift_down(PQueue *pq, unsigned long index);
+static void sift(PQueue *pq, unsigned long index);
+static void remove_at(PQueue *pq, unsigned long index);
+
+
+PQueue *pq_new(unsigned long max_length, unsigned long data_size, DSCompare compare) {
+	return pq_new_with(NULL, max_length, data_size, compare);
+}
+
+PQueue *pq_new_with(const DSAllocator *allocator, unsigned long max_length, unsigned long data_size, DSCompare compare) {
+	PQueue *pq;
+	pq = ds_alloc_with(allocator, sizeof(PQueue));
+	if (!pq) {
+		return NULL;
+	}
+	pq->compare = compare;
+	pq->allocator = allocator;
+	pq->list = alist_new_with(allocator, max_length, data_size);
+	pq->handles = ds_alloc_with(allocator, max_length * sizeof(unsigned long));
+	pq->positions = ds_alloc_with(allocator, max_length * sizeof(unsigned long));
+	if (!pq->list || !pq->handles || !pq->positions) {
+		alist_delete(pq->list);
+		if (pq->handles) {
+			ds_free_with(allocator, pq->handles, max_length * sizeof(unsigned long));
+		}
+		if (pq->positions) {
+			ds_free_with(allocator, pq->positions, max_length * sizeof(unsigned long));
+		}
+		ds_free_with(allocator, pq, sizeof(PQueue));
+		return NULL;
+	}
+	for (unsigned long i = 0; i < max_length; i++) {
+		pq->handles[i] = i;
+		pq->positions[i] = i;
+	}
+	return pq;
+}
+
+void pq_delete(PQueue *pq) {
+	if (pq) {
+		unsigned long max_length = pq->list->max_length;
+		alist_delete(pq->list);
+		ds_free_with(pq->allocator, pq->handles, max_length * sizeof(unsigned long));
+		ds_free_with(pq->allocator, pq->positions, max_length * sizeof(unsigned long));
+		ds_free_with(pq->allocator, pq, sizeof(PQueue));
+	}
+}
+
+unsigned long pq_length(PQueue *pq) {
+	return pq->list->length;
+}
+
+int pq_push(PQueue *pq, const void *data, unsigned long *out_handle) {
+	unsigned long index = pq->list->length;
+	if (index == pq->list->max_length) {
+		return DS_OVERFLOW;
+	}
+	memcpy(RECORD(pq, index), data, pq->list->data_size);
+	pq->list->length++;
+	if (out_handle) {
+		*out_handle = pq->handles[index];
+	}
+	sift_up(pq, index);
+	return DS_OK;
+}
+
+int pq_offer(PQueue *pq, const void *data) {
+	if (pq->list->length < pq->list->max_length) {
+		return pq_push(pq, data, NULL);
+	}
+	if (pq->list->length == 0 || pq->compare(data, RECORD(pq, 0)) <= 0) {
+		return DS_OVERFLOW;
+	}
+	memcpy(RECORD(pq, 0), data, pq->list->data_size);
+	sift_down(pq, 0);
+	return DS_OK;
+}
+
+int pq_pop(PQueue *pq, void *out_data) {
+	if (pq->list->length == 0) {
+		return DS_EMPTY;
+	}
+	memcpy(out_data, RECORD(pq, 0), pq->list->data_size);
+	remove_at(pq, 0);
+	return DS_OK;
+}
+
+int pq_peek(PQueue *pq, void *out_data) {
+	if (pq->list->length == 0) {
+		return DS_EMPTY;
+	}
+	memcpy(out_data, RECORD(pq, 0), pq->list->data_size);
+	return DS_OK;
+}
+
+int pq_heapify(PQueue *pq, const void *array, unsigned long length) {
+	if (length > pq->list->max_length) {
+		return DS_OVERFLOW;
+	}
+	memcpy(pq->list->array, array, length * pq->list->data_size);
+	pq->list->length = length;
+	for (unsigned long i = 0; i < pq->list->max_length; i++) {
+		pq->handles[i] = i;
+		pq->positions[i] = i;
+	}
+	for (unsigned long i = length / 2; i > 0; i--) {
+		sift_down(pq, i - 1);
+	}
+	return DS_OK;
+}
+
+int pq_get(PQueue *pq, unsigned long handle, void *out_data) {
+	if (handle >= pq->list->max_length || pq->positions[handle] >= pq->list->length) {
+		return DS_OUT_OF_BOUNDS;
+	}
+	memcpy(out_data, RECORD(pq, pq->positions[handle]), pq->list->data_size);
+	return DS_OK;
+}
+
+int pq_update(PQueue *pq, unsigned long handle, const void *data) {
+	if (handle >= pq->list->max_length || pq->positions[handle] >= pq->list->length) {
+		return DS_OUT_OF_BOUNDS;
+	}
+	memcpy(RECORD(pq, pq->positions[handle]), data, pq->list->data_size);
+	sift(pq, pq->positions[handle]);
+	return DS_OK;
+}
+
+int pq_remove(PQueue *pq, unsigned long handle) {
+	if (handle >= pq->list->max_length || pq->positions[handle] >= pq->list->length) {
+		return DS_OUT_OF_BOUNDS;
+	}
+	remove_at(pq, pq->positions[handle]);
+	return DS_OK;
+}
+
+void pq_clear(PQueue *pq) {
+	alist_clear(pq->list);
+}
+
+
+static void place(PQueue *pq, unsigned long index, unsigned long handle) {
+	pq->handles[index] = handle;
+	pq->positions[handle] = index;
+}
+
+// the record at index is held in tmp while the records above it move down
+static void sift_up(PQueue *pq, unsigned long index) {
+	unsigned long data_size = pq->list->data_size;
+	unsigned long handle = pq->handles[index];
+	memcpy(TMP(pq), RECORD(pq, index), data_size);
+	while (index > 0) {
+		unsigned long parent = (index - 1) / 2;
+		if (pq->compare(TMP(pq), RECORD(pq, parent)) >= 0) {
+			break;
+		}
+		memcpy(RECORD(pq, index), RECORD(pq, parent), data_size);
+		place(pq, index, pq->handles[parent]);
+		index = parent;
+	}
+	memcpy(RECORD(pq, index), TMP(pq), data_size);
+	place(pq, index, handle);
+}
+
+// the record at index is held in tmp while the records below it move up
+static void sift_down(PQueue *pq, unsigned long index) {
+	unsigned long data_size = pq->list->data_size;
+	unsigned long length = pq->list->length;
+	unsigned long handle = pq->handles[index];
+	memcpy(TMP(pq), RECORD(pq, index), data_size);
+	for (;;) {
+		unsigned long child = 2 * index + 1;
+		if (child >= length) {
+			break;
+		}
+		if (child + 1 < length && pq->compare(RECORD(pq, child + 1), RECORD(pq, child)) < 0) {
+			child++;
+		}
+		if (pq->compare(RECORD(pq, child), TMP(pq)) >= 0) {
+			break;
+		}
+		memcpy(RECORD(pq, index), RECORD(pq, child), data_size);
+		place(pq, index, pq->handles[child]);
+		index = child;
+	}
+	memcpy(RECORD(pq, index), TMP(pq), data_size);
+	place(pq, index, handle);
+}
+
+static void sift(PQueue *pq, unsigned long index) {
+	if (index > 0 && pq->compare(RECORD(pq, index), RECORD(pq, (index - 1) / 2)) < 0) {
+		sift_up(pq, index);
+	}
+	else {
+		sift_down(pq, index);
+	}
+}
+
+// swap the record at index with the last one, so the freed handle is kept after length
+static void remove_at(PQueue *pq, unsigned long index) {
+	unsigned long last = --pq->list->length;
+	if (index != last) {
+		unsigned long data_size = pq->list->data_size;
+		unsigned long handle = pq->handles[index];
+		memcpy(RECORD(pq, index), RECORD(pq, last), data_size);
+		place(pq, index, pq->handles[last]);
+		place(pq, last, handle);
+		sift(pq, index);
+	}
+}
+
@@ -0,0 +1,57 @@
+#ifndef __PQUEUE_H__
+#define __PQUEUE_H__
+
+#include "alist.h"
+
+/*
+ * Priority Queue
+ * Binary min heap of records of data_size bytes, stored in an AList.
+ * The record at the top is the least according to the compare function.
+ *
+ * Each record pushed gets a handle that stays valid until the record is
+ * popped or removed, regardless of where the record moves in the heap.
+ * Handles are numbers lesser than max_length and are reused. Use them to
+ * change the priority of a record with pq_update (decrease-key or
+ * increase-key), to read it or to remove it.
+ *
+ * pq_offer keeps the greatest records offered to a full queue, for a top-k
+ * of a stream in O(n log k): it pushes the record if there is room, else it
+ * replaces the top with it if it is greater, and returns DS_OVERFLOW if it
+ * is not. The record replaced loses its handle to the new one. Popping the
+ * queue then gives the top-k in ascending order.
+ *
+ * pq_heapify replaces the contents of the queue with an array of records
+ * in O(n). The record at index i of the array gets the handle i.
+ *
+ * pq_new_with takes all the memory of the queue from an allocator.
+ */
+typedef struct PQueue {
+	AList *list;
+	unsigned long *handles;    // heap index -> handle
+	unsigned long *positions;  // handle -> heap index
+	DSCompare compare;
+	const DSAllocator *allocator;
+} PQueue;
+
+
+PQueue *pq_new(unsigned long max_length, unsigned long data_size, DSCompare compare);
+PQueue *pq_new_with(const DSAllocator *allocator, unsigned long max_length, unsigned long data_size, DSCompare compare);
+void pq_delete(PQueue *pq);
+
+unsigned long pq_length(PQueue *pq);
+
+int pq_push(PQueue *pq, const void *data, unsigned long *out_handle);
+int pq_offer(PQueue *pq, const void *data);
+int pq_pop(PQueue *pq, void *out_data);
+int pq_peek(PQueue *pq, void *out_data);
+
+int pq_heapify(PQueue *pq, const void *array, unsigned long length);
+
+int pq_get(PQueue *pq, unsigned long handle, void *out_data);
+int pq_update(PQueue *pq, unsigned long handle, const void *data);
+int pq_remove(PQueue *pq, unsigned long handle);
+
+void pq_clear(PQueue *pq);
+
+
+#endif  // __PQUEUE_H__
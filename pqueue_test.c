@@ -0,0 +1,177 @@
+#include "pqueue.h"
+#include <assert.h>
+#include <stdlib.h>
+#include <stdio.h>
+#include <time.h>
+#include <string.h>
+
+typedef struct Job {
+	int priority;
+	char name[28];
+} Job;
+
+int compare_jobs(const Job *a, const Job *b) {
+	return a->priority - b->priority;
+}
+
+int compare_ints(const int *a, const int *b) {
+	return *a - *b;
+}
+
+int main() {
+
+	// push, peek, pop
+	{
+		PQueue *pq = pq_new(10, sizeof(int), (DSCompare) compare_ints);
+		assert(pq);
+		assert(pq_length(pq) == 0);
+
+		int values[] = { 5, 3, 8, 1, 9, 0, 2, 7, 4, 6 };
+		for (int i = 0; i < 10; i++) {
+			int rval = pq_push(pq, &values[i], NULL);
+			assert(rval == DS_OK);
+		}
+		assert(pq_length(pq) == 10);
+		{
+			int n = 10;
+			int rval = pq_push(pq, &n, NULL);
+			assert(rval == DS_OVERFLOW);
+		}
+		{
+			int n;
+			int rval = pq_peek(pq, &n);
+			assert(rval == DS_OK);
+			assert(n == 0);
+		}
+		for (int i = 0; i < 10; i++) {
+			int n;
+			int rval = pq_pop(pq, &n);
+			assert(rval == DS_OK);
+			assert(n == i);
+		}
+		{
+			int n;
+			int rval = pq_pop(pq, &n);
+			assert(rval == DS_EMPTY);
+			rval = pq_peek(pq, &n);
+			assert(rval == DS_EMPTY);
+		}
+		pq_delete(pq);
+	}
+
+	// handles, update, remove
+	{
+		PQueue *pq = pq_new(8, sizeof(Job), (DSCompare) compare_jobs);
+		unsigned long handles[8];
+		for (int i = 0; i < 8; i++) {
+			Job job = { 10 * (i + 1), "" };
+			snprintf(job.name, sizeof(job.name), "job %d", i);
+			int rval = pq_push(pq, &job, &handles[i]);
+			assert(rval == DS_OK);
+		}
+		{
+			Job job;
+			int rval = pq_get(pq, handles[5], &job);
+			assert(rval == DS_OK);
+			assert(job.priority == 60);
+			assert(strcmp(job.name, "job 5") == 0);
+		}
+
+		// decrease-key to the top
+		{
+			Job job = { 5, "job 5" };
+			int rval = pq_update(pq, handles[5], &job);
+			assert(rval == DS_OK);
+			pq_peek(pq, &job);
+			assert(strcmp(job.name, "job 5") == 0);
+		}
+		// increase-key to the bottom
+		{
+			Job job = { 100, "job 0" };
+			int rval = pq_update(pq, handles[0], &job);
+			assert(rval == DS_OK);
+			pq_get(pq, handles[0], &job);
+			assert(job.priority == 100);
+		}
+		{
+			int rval = pq_remove(pq, handles[3]);
+			assert(rval == DS_OK);
+			assert(pq_length(pq) == 7);
+			Job job;
+			rval = pq_get(pq, handles[3], &job);
+			assert(rval == DS_OUT_OF_BOUNDS);
+			rval = pq_remove(pq, handles[3]);
+			assert(rval == DS_OUT_OF_BOUNDS);
+		}
+		{
+			int expected[] = { 5, 20, 30, 50, 70, 80, 100 };
+			for (int i = 0; i < 7; i++) {
+				Job job;
+				pq_pop(pq, &job);
+				assert(job.priority == expected[i]);
+			}
+		}
+		pq_delete(pq);
+	}
+
+	// heapify
+	{
+		srand(time(NULL));
+		const unsigned long max_size = 1000;
+		PQueue *pq = pq_new(max_size, sizeof(int), (DSCompare) compare_ints);
+		for (int it = 0; it < 20; it++) {
+			int values[1000];
+			unsigned long length = rand() % max_size;
+			for (unsigned long i = 0; i < length; i++) {
+				values[i] = rand() % 100;
+			}
+			int rval = pq_heapify(pq, values, length);
+			assert(rval == DS_OK);
+			assert(pq_length(pq) == length);
+			for (unsigned long i = 0; i < length; i++) {
+				int n;
+				pq_get(pq, i, &n);
+				assert(n == values[i]);
+			}
+			int p = -1;
+			for (unsigned long i = 0; i < length; i++) {
+				int n;
+				pq_pop(pq, &n);
+				assert(n >= p);
+				p = n;
+			}
+		}
+		{
+			int values[1001] = { 0 };
+			int rval = pq_heapify(pq, values, 1001);
+			assert(rval == DS_OVERFLOW);
+		}
+		pq_delete(pq);
+	}
+
+	// top-k of a stream
+	{
+		PQueue *pq = pq_new(100, sizeof(int), (DSCompare) compare_ints);
+		int n;
+		assert(pq_offer(pq, &(int) { 5 }) == DS_OK);
+		pq_clear(pq);
+		for (int i = 0; i < 100000; i++) {
+			n = (i * 7919) % 100000;
+			int rval = pq_offer(pq, &n);
+			assert(rval == DS_OK || rval == DS_OVERFLOW);
+		}
+		assert(pq_length(pq) == 100);
+		assert(pq_offer(pq, &(int) { 99900 }) == DS_OVERFLOW);
+		for (int i = 0; i < 100; i++) {
+			pq_pop(pq, &n);
+			assert(n == 99900 + i);
+		}
+		pq_delete(pq);
+
+		PQueue *none = pq_new(0, sizeof(int), (DSCompare) compare_ints);
+		assert(pq_offer(none, &n) == DS_OVERFLOW);
+		pq_delete(none);
+	}
+
+	return 0;
+}
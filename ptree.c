@@ -0,0 +1,336 @@
+#include "ptree.h"
+#include <stdatomic.h>
+#include <stdlib.h>
+
+#define HEIGHT(node) ((node) ? (node)->height : 0)
+#define SIZE(node) ((node) ? (node)->size : 0UL)
+
+static PTree *new_node(const DSAllocator *allocator, long elm);
+static PTree *copy_node(const DSAllocator *allocator, PTree *node, int side, PTree *child);
+static int own(const DSAllocator *allocator, PTree **link);
+static void update(PTree *node);
+static int rotate_left(const DSAllocator *allocator, PTree **link);
+static int rotate_right(const DSAllocator *allocator, PTree **link);
+static int balance(const DSAllocator *allocator, PTree **link);
+static int rebuild(
+		const DSAllocator *allocator,
+		PTree **path,
+		const int *sides,
+		int depth,
+		PTree *sub,
+		int replace_at,
+		long replace_elm,
+		PTree **out_root);
+static int check(PTree *node, const long *lo, const long *hi);
+
+
+int pt_insert(PTree *root, long elm, PTree **out_root) {
+	return pt_insert_with(NULL, root, elm, out_root);
+}
+
+// Walks down to where the element goes, then copies the path back up with
+// the new leaf in it.
+int pt_insert_with(const DSAllocator *allocator, PTree *root, long elm, PTree **out_root) {
+	PTree *path[DS_AVL_MAX_HEIGHT];
+	int sides[DS_AVL_MAX_HEIGHT];
+	int depth = 0;
+	PTree *sub;
+	DS_STAT(ds_stats_bound(), ops, 1);
+	for (PTree *node = root; node; depth++) {
+		DS_STAT(ds_stats_bound(), compares, 1);
+		if (elm == node->elm) {
+			*out_root = pt_retain(root);
+			return DS_EXISTS;
+		}
+		path[depth] = node;
+		sides[depth] = elm > node->elm;
+		node = elm > node->elm ? node->right : node->left;
+	}
+	sub = new_node(allocator, elm);
+	if (!sub) {
+		return DS_MALLOC_ERROR;
+	}
+	return rebuild(allocator, path, sides, depth, sub, -1, 0, out_root);
+}
+
+int pt_remove(PTree *root, long elm, PTree **out_root) {
+	return pt_remove_with(NULL, root, elm, out_root);
+}
+
+// A node with two children is replaced by a copy holding its successor,
+// whose node is removed from the right subtree instead.
+int pt_remove_with(const DSAllocator *allocator, PTree *root, long elm, PTree **out_root) {
+	PTree *path[DS_AVL_MAX_HEIGHT];
+	int sides[DS_AVL_MAX_HEIGHT];
+	int depth = 0;
+	int at;
+	PTree *node = root;
+	PTree *sub;
+	DS_STAT(ds_stats_bound(), ops, 1);
+	while (node && node->elm != elm) {
+		DS_STAT(ds_stats_bound(), compares, 1);
+		path[depth] = node;
+		sides[depth] = elm > node->elm;
+		node = elm > node->elm ? node->right : node->left;
+		depth++;
+	}
+	if (!node) {
+		*out_root = pt_retain(root);
+		return DS_NOT_FOUND;
+	}
+	if (!node->left || !node->right) {
+		sub = pt_retain(node->left ? node->left : node->right);
+		return rebuild(allocator, path, sides, depth, sub, -1, 0, out_root);
+	}
+	at = depth;
+	path[depth] = node;
+	sides[depth] = 1;
+	depth++;
+	for (node = node->right; node->left; node = node->left) {
+		path[depth] = node;
+		sides[depth] = 0;
+		depth++;
+	}
+	sub = pt_retain(node->right);
+	return rebuild(allocator, path, sides, depth, sub, at, node->elm, out_root);
+}
+
+PTree *pt_retain(PTree *root) {
+	if (root) {
+		atomic_fetch_add_explicit(&root->refs, 1, memory_order_relaxed);
+	}
+	return root;
+}
+
+void pt_release(PTree *root) {
+	pt_release_with(NULL, root);
+}
+
+// Frees the nodes whose count drops to 0 and releases their children in
+// turn. Each level adds at most one node to the stack.
+void pt_release_with(const DSAllocator *allocator, PTree *root) {
+	PTree *stack[2 * DS_AVL_MAX_HEIGHT];
+	int top = 0;
+	if (root) {
+		stack[top++] = root;
+	}
+	while (top > 0) {
+		PTree *node = stack[--top];
+		if (atomic_fetch_sub_explicit(&node->refs, 1, memory_order_acq_rel) != 1) {
+			continue;
+		}
+		if (node->left) {
+			stack[top++] = node->left;
+		}
+		if (node->right) {
+			stack[top++] = node->right;
+		}
+		DS_STAT(ds_stats_bound(), frees, 1);
+		ds_free_with(allocator, node, sizeof(PTree));
+	}
+}
+
+PTree *pt_find(PTree *root, long elm) {
+	PTree *node = root;
+	while (node && node->elm != elm) {
+		DS_STAT(ds_stats_bound(), compares, 1);
+		node = elm > node->elm ? node->right : node->left;
+	}
+	return node;
+}
+
+PTree *pt_nth(PTree *root, unsigned long nth) {
+	PTree *node = root;
+	while (node) {
+		unsigned long left = SIZE(node->left);
+		if (nth == left) {
+			return node;
+		}
+		if (nth < left) {
+			node = node->left;
+		}
+		else {
+			nth -= left + 1;
+			node = node->right;
+		}
+	}
+	return NULL;
+}
+
+unsigned long pt_length(PTree *root) {
+	return SIZE(root);
+}
+
+int pt_height(PTree *root) {
+	return HEIGHT(root);
+}
+
+int pt_check(PTree *root) {
+	return check(root, NULL, NULL) >= 0;
+}
+
+
+static PTree *new_node(const DSAllocator *allocator, long elm) {
+	PTree *node = ds_alloc_with(allocator, sizeof(PTree));
+	if (node) {
+		node->elm = elm;
+		node->left = NULL;
+		node->right = NULL;
+		node->size = 1;
+		node->height = 1;
+		atomic_init(&node->refs, 1);
+		DS_STAT(ds_stats_bound(), allocations, 1);
+	}
+	return node;
+}
+
+// a copy of node with child, which it takes, on side, 0 left and 1 right,
+// sharing the other child
+static PTree *copy_node(const DSAllocator *allocator, PTree *node, int side, PTree *child) {
+	PTree *copy = new_node(allocator, node->elm);
+	if (copy) {
+		copy->left = side ? pt_retain(node->left) : child;
+		copy->right = side ? child : pt_retain(node->right);
+		update(copy);
+	}
+	return copy;
+}
+
+// Makes the node at link one that only the new version uses, so that it
+// can be changed, by copying it if it is shared. A node of the version
+// being built with a count of 1 is referenced only from its parent there,
+// as the versions it came from are still held by the caller.
+static int own(const DSAllocator *allocator, PTree **link) {
+	PTree *node = *link;
+	PTree *copy;
+	if (atomic_load_explicit(&node->refs, memory_order_acquire) == 1) {
+		return 1;
+	}
+	copy = copy_node(allocator, node, 1, pt_retain(node->right));
+	if (!copy) {
+		pt_release_with(allocator, node->right);
+		return 0;
+	}
+	*link = copy;
+	pt_release_with(allocator, node);
+	return 1;
+}
+
+static void update(PTree *node) {
+	int left = HEIGHT(node->left);
+	int right = HEIGHT(node->right);
+	node->height = (left > right ? left : right) + 1;
+	node->size = SIZE(node->left) + SIZE(node->right) + 1;
+}
+
+static int rotate_left(const DSAllocator *allocator, PTree **link) {
+	PTree *node = *link;
+	PTree *right;
+	if (!own(allocator, &node->right)) {
+		return 0;
+	}
+	right = node->right;
+	node->right = right->left;
+	right->left = node;
+	update(node);
+	update(right);
+	*link = right;
+	return 1;
+}
+
+static int rotate_right(const DSAllocator *allocator, PTree **link) {
+	PTree *node = *link;
+	PTree *left;
+	if (!own(allocator, &node->left)) {
+		return 0;
+	}
+	left = node->left;
+	node->left = left->right;
+	left->right = node;
+	update(node);
+	update(left);
+	*link = left;
+	return 1;
+}
+
+// Restores the balance of the node at link, which the new version owns.
+// If a copy cannot be made, the subtree is left valid but unbalanced.
+static int balance(const DSAllocator *allocator, PTree **link) {
+	PTree *node = *link;
+	int factor;
+	update(node);
+	factor = HEIGHT(node->right) - HEIGHT(node->left);
+	if (factor > 1) {
+		if (HEIGHT(node->right->right) < HEIGHT(node->right->left)) {
+			if (!own(allocator, &node->right) || !rotate_right(allocator, &node->right)) {
+				return 0;
+			}
+		}
+		return rotate_left(allocator, link);
+	}
+	if (factor < -1) {
+		if (HEIGHT(node->left->left) < HEIGHT(node->left->right)) {
+			if (!own(allocator, &node->left) || !rotate_left(allocator, &node->left)) {
+				return 0;
+			}
+		}
+		return rotate_right(allocator, link);
+	}
+	return 1;
+}
+
+// Copies the path from the bottom up, hanging sub, the new subtree below
+// it, from the last node, and balancing each copy. The copy of the node at
+// replace_at, if any, gets replace_elm. Releases what was built on failure.
+static int rebuild(
+		const DSAllocator *allocator,
+		PTree **path,
+		const int *sides,
+		int depth,
+		PTree *sub,
+		int replace_at,
+		long replace_elm,
+		PTree **out_root)
+{
+	while (depth-- > 0) {
+		PTree *copy = copy_node(allocator, path[depth], sides[depth], sub);
+		if (!copy) {
+			pt_release_with(allocator, sub);
+			return DS_MALLOC_ERROR;
+		}
+		if (depth == replace_at) {
+			copy->elm = replace_elm;
+		}
+		if (!balance(allocator, &copy)) {
+			pt_release_with(allocator, copy);
+			return DS_MALLOC_ERROR;
+		}
+		sub = copy;
+	}
+	*out_root = sub;
+	return DS_OK;
+}
+
+// the height of the subtree, or -1 if it is not a valid AVL tree with all
+// its elements strictly between lo and hi, when they are given
+static int check(PTree *node, const long *lo, const long *hi) {
+	int left, right;
+	if (!node) {
+		return 0;
+	}
+	if ((lo && node->elm <= *lo) || (hi && node->elm >= *hi)) {
+		return -1;
+	}
+	left = check(node->left, lo, &node->elm);
+	right = check(node->right, &node->elm, hi);
+	if (left < 0 || right < 0 || left - right > 1 || right - left > 1) {
+		return -1;
+	}
+	if (node->height != (left > right ? left : right) + 1) {
+		return -1;
+	}
+	if (node->size != SIZE(node->left) + SIZE(node->right) + 1) {
+		return -1;
+	}
+	return node->height;
+}
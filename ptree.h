@@ -0,0 +1,74 @@
+#ifndef __PTREE_H__
+#define __PTREE_H__
+
+#include "alist.h"
+
+/*
+ * Persistent Tree
+ * AVL tree of long elements, without duplicates, that is never modified.
+ * Inserting or removing an element returns a new version of the tree, a
+ * new root, that copies the nodes on the path to the element, O(log n) of
+ * them, and shares all the others with the version it came from, which
+ * remains as it was. A version is a snapshot: readers can keep using one
+ * while writers derive new ones from it.
+ *
+ * The nodes are reference counted, atomically, so versions can be passed
+ * between threads. pt_insert and pt_remove store the new version in
+ * out_root, and pt_retain returns the version it is given; each is a
+ * reference that the caller owns and releases with pt_release, which frees
+ * the nodes that no other version uses. The version given to pt_insert and
+ * pt_remove is still owned by the caller. NULL is the empty tree. So a
+ * writer keeps the current version like this:
+ *
+ * PTree *next;
+ * if (pt_insert(current, elm, &next) != DS_MALLOC_ERROR) {
+ *     pt_release(current);
+ *     current = next;
+ * }
+ *
+ * and a reader takes a snapshot in O(1) with pt_retain(current). The
+ * pointer to the current version is the caller's to share; retaining a
+ * version that another thread may release at the same time needs a lock
+ * or the like around the retain and the release.
+ *
+ * pt_insert returns DS_EXISTS if the element is in the version already,
+ * and pt_remove DS_NOT_FOUND if it is not, storing the version itself,
+ * retained, in out_root. Both return DS_MALLOC_ERROR if a node could not
+ * be allocated, leaving out_root as it was. pt_find returns the node of an
+ * element or NULL, pt_nth the node of the element at index nth in order,
+ * and pt_length is O(1).
+ *
+ * The _with functions take the nodes from an allocator, which must be the
+ * same for all the versions that share nodes, and be thread safe if they
+ * are released in several threads.
+ *
+ * pt_check returns 1 if the tree is ordered and balanced and its heights
+ * and sizes are right, 0 otherwise.
+ */
+typedef struct PTree {
+	long elm;
+	struct PTree *left;
+	struct PTree *right;
+	unsigned long size;
+	int height;
+	_Atomic unsigned long refs;
+} PTree;
+
+
+int pt_insert(PTree *root, long elm, PTree **out_root);
+int pt_insert_with(const DSAllocator *allocator, PTree *root, long elm, PTree **out_root);
+int pt_remove(PTree *root, long elm, PTree **out_root);
+int pt_remove_with(const DSAllocator *allocator, PTree *root, long elm, PTree **out_root);
+
+PTree *pt_retain(PTree *root);
+void pt_release(PTree *root);
+void pt_release_with(const DSAllocator *allocator, PTree *root);
+
+PTree *pt_find(PTree *root, long elm);
+PTree *pt_nth(PTree *root, unsigned long nth);
+unsigned long pt_length(PTree *root);
+int pt_height(PTree *root);
+int pt_check(PTree *root);
+
+
+#endif  // __PTREE_H__
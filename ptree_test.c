@@ -0,0 +1,232 @@
+#include "ptree.h"
+#include <assert.h>
+#include <pthread.h>
+#include <stdlib.h>
+#include <stdio.h>
+
+#define RANGE 2000
+#define VERSIONS 64
+#define READERS 4
+
+// checks that the version holds exactly the elements set in present
+void check_same(PTree *root, const char *present) {
+	unsigned long count = 0;
+	assert(pt_check(root));
+	for (long i = 0; i < RANGE; i++) {
+		PTree *node = pt_find(root, i);
+		assert((node != NULL) == (present[i] != 0));
+		if (node) {
+			assert(pt_nth(root, count)->elm == i);
+			count++;
+		}
+	}
+	assert(pt_length(root) == count);
+	assert(pt_nth(root, count) == NULL);
+}
+
+// malloc that fails once the budget in context runs out
+void *limited_alloc(void *context, unsigned long size) {
+	long *budget = context;
+	if (*budget == 0) {
+		return NULL;
+	}
+	(*budget)--;
+	return malloc(size);
+}
+
+void limited_free(void *context, void *ptr, unsigned long size) {
+	(void) context;
+	(void) size;
+	free(ptr);
+}
+
+typedef struct Reader {
+	PTree *snapshot;
+	long first;
+	unsigned long length;
+} Reader;
+
+// walks its snapshot while the main thread releases it and derives others
+void *read_snapshot(void *arg) {
+	Reader *reader = arg;
+	for (int pass = 0; pass < 20; pass++) {
+		assert(pt_check(reader->snapshot));
+		assert(pt_length(reader->snapshot) == reader->length);
+		for (unsigned long i = 0; i < reader->length; i++) {
+			assert(pt_nth(reader->snapshot, i)->elm == reader->first + (long) i);
+		}
+	}
+	pt_release(reader->snapshot);
+	return NULL;
+}
+
+int main() {
+	srand(11);
+
+	// random inserts and removes, each version kept and checked at the end
+	{
+		static char present[VERSIONS][RANGE];
+		PTree *versions[VERSIONS];
+		PTree *current = NULL;
+		assert(pt_length(NULL) == 0);
+		assert(pt_height(NULL) == 0);
+		assert(pt_find(NULL, 1) == NULL);
+		assert(pt_check(NULL));
+		for (int v = 0; v < VERSIONS; v++) {
+			static char now[RANGE];
+			for (int op = 0; op < 200; op++) {
+				long elm = rand() % RANGE;
+				PTree *next;
+				if (rand() % 3) {
+					assert(pt_insert(current, elm, &next) == (now[elm] ? DS_EXISTS : DS_OK));
+					now[elm] = 1;
+				}
+				else {
+					assert(pt_remove(current, elm, &next) == (now[elm] ? DS_OK : DS_NOT_FOUND));
+					now[elm] = 0;
+				}
+				pt_release(current);
+				current = next;
+			}
+			for (long i = 0; i < RANGE; i++) {
+				present[v][i] = now[i];
+			}
+			versions[v] = pt_retain(current);
+			check_same(current, now);
+		}
+		pt_release(current);
+		for (int v = 0; v < VERSIONS; v++) {
+			check_same(versions[v], present[v]);
+		}
+		// release in a mixed order, so shared nodes go when their last user does
+		for (int v = 0; v < VERSIONS; v += 2) {
+			pt_release(versions[v]);
+		}
+		for (int v = 1; v < VERSIONS; v += 2) {
+			check_same(versions[v], present[v]);
+			pt_release(versions[v]);
+		}
+	}
+
+	// no change returns the same version; removals down to empty
+	{
+		PTree *root = NULL;
+		for (long i = 0; i < 1000; i++) {
+			PTree *next;
+			assert(pt_insert(root, i, &next) == DS_OK);
+			pt_release(root);
+			root = next;
+		}
+		assert(pt_check(root));
+		assert(pt_height(root) <= 14);
+		PTree *same;
+		assert(pt_insert(root, 500, &same) == DS_EXISTS);
+		assert(same == root);
+		pt_release(same);
+		assert(pt_remove(root, 1000, &same) == DS_NOT_FOUND);
+		assert(same == root);
+		pt_release(same);
+
+		PTree *old = pt_retain(root);
+		for (long i = 0; i < 1000; i++) {
+			PTree *next;
+			assert(pt_remove(root, (i * 7) % 1000, &next) == DS_OK);
+			assert(pt_length(next) == 999 - (unsigned long) i);
+			assert(pt_check(next));
+			pt_release(root);
+			root = next;
+		}
+		assert(root == NULL);
+		assert(pt_length(old) == 1000);
+		assert(pt_check(old));
+		pt_release(old);
+	}
+
+	// snapshots read in other threads
+	{
+		pthread_t threads[READERS];
+		Reader readers[READERS];
+		PTree *current = NULL;
+		for (long i = 0; i < 500; i++) {
+			PTree *next;
+			pt_insert(current, i, &next);
+			pt_release(current);
+			current = next;
+		}
+		for (int t = 0; t < READERS; t++) {
+			// each reader sees the elements from t to 499
+			readers[t].snapshot = pt_retain(current);
+			readers[t].first = t;
+			readers[t].length = 500 - (unsigned long) t;
+			pthread_create(&threads[t], NULL, read_snapshot, &readers[t]);
+			PTree *next;
+			pt_remove(current, t, &next);
+			pt_release(current);
+			current = next;
+		}
+		for (long i = 500; i < 2000; i++) {
+			PTree *next;
+			pt_insert(current, i, &next);
+			pt_release(current);
+			current = next;
+		}
+		for (int t = 0; t < READERS; t++) {
+			pthread_join(threads[t], NULL);
+		}
+		assert(pt_length(current) == 2000 - READERS);
+		assert(pt_check(current));
+		pt_release(current);
+	}
+
+	// allocations failing partway through, which leave the version as it was
+	{
+		long budget = -1;
+		DSAllocator allocator = { limited_alloc, NULL, limited_free, &budget };
+		PTree *root = NULL;
+		for (long i = 0; i < 3000; i++) {
+			PTree *next;
+			assert(pt_insert_with(&allocator, root, (i * 7919) % 3000, &next) == DS_OK);
+			pt_release_with(&allocator, root);
+			root = next;
+		}
+		for (long i = 0; i < 3000; i += 3) {
+			PTree *keep = pt_retain(root);
+			PTree *next = NULL;
+			budget = i % 7;
+			int rval = i % 2 ? pt_remove_with(&allocator, root, i, &next) : pt_insert_with(&allocator, root, i + 3000, &next);
+			budget = -1;
+			assert(rval == DS_OK || rval == DS_MALLOC_ERROR);
+			assert(pt_check(root));
+			assert(pt_length(root) == 3000);
+			if (rval == DS_OK) {
+				assert(pt_check(next));
+				assert(pt_length(next) == (i % 2 ? 2999UL : 3001UL));
+				pt_release_with(&allocator, next);
+			}
+			else {
+				assert(next == NULL);
+			}
+			pt_release_with(&allocator, keep);
+		}
+		pt_release_with(&allocator, root);
+	}
+
+	// from an arena, which does not free
+	{
+		DSArena *arena = ds_arena_new(1 << 16);
+		const DSAllocator *allocator = ds_arena_allocator(arena);
+		PTree *root = NULL;
+		for (long i = 0; i < 100; i++) {
+			PTree *next;
+			assert(pt_insert_with(allocator, root, 99 - i, &next) == DS_OK);
+			pt_release_with(allocator, root);
+			root = next;
+		}
+		assert(pt_nth(root, 0)->elm == 0);
+		assert(pt_check(root));
+		pt_release_with(allocator, root);
+		ds_arena_delete(arena);
+	}
+
+	return 0;
+}
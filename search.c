@@ -0,0 +1,577 @@
+#include "search.h"
+#include <stdatomic.h>
+#include <stdint.h>
+#include <string.h>
+
+#if defined(__x86_64__) && defined(__GNUC__)
+#define X86 1
+#include <immintrin.h>
+#elif defined(__aarch64__)
+#define NEON 1
+#include <arm_neon.h>
+#endif
+
+#define AVX2 __attribute__((target("avx2,bmi2,popcnt")))
+#define SSE42 __attribute__((target("sse4.2,popcnt")))
+
+static _Atomic int level = -1;
+
+static int detect(void);
+
+
+/*
+ * Scalar kernels, which also finish the tails of the vector ones.
+ * The filter is branchless: every element is written, and the count
+ * only moves past the ones that pass.
+ */
+#define SCALAR_KERNELS(T, bits)													\
+	static unsigned long find_##bits(const T *a, unsigned long n, T key) {		\
+		for (unsigned long i = 0; i < n; i++) {									\
+			if (a[i] == key) {													\
+				return i;														\
+			}																	\
+		}																		\
+		return n;																\
+	}																			\
+																				\
+	static unsigned long count_##bits(const T *a, unsigned long n, T key) {		\
+		unsigned long count = 0;												\
+		for (unsigned long i = 0; i < n; i++) {									\
+			count += a[i] == key;												\
+		}																		\
+		return count;															\
+	}																			\
+																				\
+	static void min_max_##bits(const T *a, unsigned long n, T *min, T *max) {	\
+		for (unsigned long i = 0; i < n; i++) {									\
+			*min = a[i] < *min ? a[i] : *min;									\
+			*max = a[i] > *max ? a[i] : *max;									\
+		}																		\
+	}																			\
+																				\
+	static unsigned long filter_##bits(T *dst, const T *src, unsigned long n, T lo, T hi) {	\
+		unsigned long count = 0;												\
+		for (unsigned long i = 0; i < n; i++) {									\
+			T x = src[i];														\
+			dst[count] = x;														\
+			count += lo <= x && x <= hi;										\
+		}																		\
+		return count;															\
+	}																			\
+
+SCALAR_KERNELS(int8_t, 8)
+SCALAR_KERNELS(int16_t, 16)
+SCALAR_KERNELS(int32_t, 32)
+SCALAR_KERNELS(int64_t, 64)
+
+
+#ifdef X86
+
+/*
+ * x86 kernels, compiled for their instruction set whatever the flags of
+ * the build, and called only if cpuid reports it. Each compare leaves
+ * width bytes set per equal lane, so movemask has width bits per lane.
+ */
+#define X86_FIND_COUNT(T, bits, isa, Vec, set1, load, cmpeq, movemask)			\
+	isa static unsigned long find_##bits##_##isa(const T *a, unsigned long n, T key) {	\
+		const unsigned long lanes = sizeof(Vec) / sizeof(T);					\
+		const Vec k = set1(key);												\
+		unsigned long i = 0;													\
+		for (; i + 2 * lanes <= n; i += 2 * lanes) {							\
+			unsigned m0 = (unsigned) movemask(cmpeq(load((const Vec *) (a + i)), k));	\
+			unsigned m1 = (unsigned) movemask(cmpeq(load((const Vec *) (a + i + lanes)), k));	\
+			if (m0 | m1) {														\
+				if (m0) {														\
+					return i + __builtin_ctz(m0) / sizeof(T);					\
+				}																\
+				return i + lanes + __builtin_ctz(m1) / sizeof(T);				\
+			}																	\
+		}																		\
+		return i + find_##bits(a + i, n - i, key);								\
+	}																			\
+																				\
+	isa static unsigned long count_##bits##_##isa(const T *a, unsigned long n, T key) {	\
+		const unsigned long lanes = sizeof(Vec) / sizeof(T);					\
+		const Vec k = set1(key);												\
+		unsigned long bytes = 0;												\
+		unsigned long i = 0;													\
+		for (; i + lanes <= n; i += lanes) {									\
+			bytes += __builtin_popcount((unsigned) movemask(cmpeq(load((const Vec *) (a + i)), k)));	\
+		}																		\
+		return bytes / sizeof(T) + count_##bits(a + i, n - i, key);				\
+	}																			\
+
+#define X86_MIN_MAX(T, bits, isa, Vec, set1, load, store, min, max)				\
+	isa static void min_max_##bits##_##isa(const T *a, unsigned long n, T *out_min, T *out_max) {	\
+		const unsigned long lanes = sizeof(Vec) / sizeof(T);					\
+		Vec vmin = set1(*out_min);												\
+		Vec vmax = set1(*out_max);												\
+		T lows[sizeof(Vec) / sizeof(T)];										\
+		T highs[sizeof(Vec) / sizeof(T)];										\
+		unsigned long i = 0;													\
+		for (; i + lanes <= n; i += lanes) {									\
+			Vec x = load((const Vec *) (a + i));								\
+			vmin = min(vmin, x);												\
+			vmax = max(vmax, x);												\
+		}																		\
+		store((Vec *) lows, vmin);												\
+		store((Vec *) highs, vmax);												\
+		for (unsigned long j = 0; j < lanes; j++) {								\
+			*out_min = lows[j] < *out_min ? lows[j] : *out_min;					\
+			*out_max = highs[j] > *out_max ? highs[j] : *out_max;				\
+		}																		\
+		min_max_##bits(a + i, n - i, out_min, out_max);							\
+	}																			\
+
+SSE42 static inline __m128i min_64_SSE42(__m128i a, __m128i b) {
+	return _mm_blendv_epi8(a, b, _mm_cmpgt_epi64(a, b));
+}
+
+SSE42 static inline __m128i max_64_SSE42(__m128i a, __m128i b) {
+	return _mm_blendv_epi8(b, a, _mm_cmpgt_epi64(a, b));
+}
+
+AVX2 static inline __m256i min_64_AVX2(__m256i a, __m256i b) {
+	return _mm256_blendv_epi8(a, b, _mm256_cmpgt_epi64(a, b));
+}
+
+AVX2 static inline __m256i max_64_AVX2(__m256i a, __m256i b) {
+	return _mm256_blendv_epi8(b, a, _mm256_cmpgt_epi64(a, b));
+}
+
+X86_FIND_COUNT(int8_t, 8, SSE42, __m128i, _mm_set1_epi8, _mm_loadu_si128, _mm_cmpeq_epi8, _mm_movemask_epi8)
+X86_FIND_COUNT(int16_t, 16, SSE42, __m128i, _mm_set1_epi16, _mm_loadu_si128, _mm_cmpeq_epi16, _mm_movemask_epi8)
+X86_FIND_COUNT(int32_t, 32, SSE42, __m128i, _mm_set1_epi32, _mm_loadu_si128, _mm_cmpeq_epi32, _mm_movemask_epi8)
+X86_FIND_COUNT(int64_t, 64, SSE42, __m128i, _mm_set1_epi64x, _mm_loadu_si128, _mm_cmpeq_epi64, _mm_movemask_epi8)
+X86_FIND_COUNT(int8_t, 8, AVX2, __m256i, _mm256_set1_epi8, _mm256_loadu_si256, _mm256_cmpeq_epi8, _mm256_movemask_epi8)
+X86_FIND_COUNT(int16_t, 16, AVX2, __m256i, _mm256_set1_epi16, _mm256_loadu_si256, _mm256_cmpeq_epi16, _mm256_movemask_epi8)
+X86_FIND_COUNT(int32_t, 32, AVX2, __m256i, _mm256_set1_epi32, _mm256_loadu_si256, _mm256_cmpeq_epi32, _mm256_movemask_epi8)
+X86_FIND_COUNT(int64_t, 64, AVX2, __m256i, _mm256_set1_epi64x, _mm256_loadu_si256, _mm256_cmpeq_epi64, _mm256_movemask_epi8)
+
+X86_MIN_MAX(int8_t, 8, SSE42, __m128i, _mm_set1_epi8, _mm_loadu_si128, _mm_storeu_si128, _mm_min_epi8, _mm_max_epi8)
+X86_MIN_MAX(int16_t, 16, SSE42, __m128i, _mm_set1_epi16, _mm_loadu_si128, _mm_storeu_si128, _mm_min_epi16, _mm_max_epi16)
+X86_MIN_MAX(int32_t, 32, SSE42, __m128i, _mm_set1_epi32, _mm_loadu_si128, _mm_storeu_si128, _mm_min_epi32, _mm_max_epi32)
+X86_MIN_MAX(int64_t, 64, SSE42, __m128i, _mm_set1_epi64x, _mm_loadu_si128, _mm_storeu_si128, min_64_SSE42, max_64_SSE42)
+X86_MIN_MAX(int8_t, 8, AVX2, __m256i, _mm256_set1_epi8, _mm256_loadu_si256, _mm256_storeu_si256, _mm256_min_epi8, _mm256_max_epi8)
+X86_MIN_MAX(int16_t, 16, AVX2, __m256i, _mm256_set1_epi16, _mm256_loadu_si256, _mm256_storeu_si256, _mm256_min_epi16, _mm256_max_epi16)
+X86_MIN_MAX(int32_t, 32, AVX2, __m256i, _mm256_set1_epi32, _mm256_loadu_si256, _mm256_storeu_si256, _mm256_min_epi32, _mm256_max_epi32)
+X86_MIN_MAX(int64_t, 64, AVX2, __m256i, _mm256_set1_epi64x, _mm256_loadu_si256, _mm256_storeu_si256, min_64_AVX2, max_64_AVX2)
+
+/*
+ * Stream compaction of 4 and 8 byte elements: the lanes in range are moved
+ * to the front of the vector, which is stored whole at the end of dst, and
+ * the end advances by their number. SSE shuffles bytes with a table of the
+ * 16 masks of 4 lanes. AVX2 builds the permutation of 8 lanes from the mask
+ * with pdep and pext.
+ */
+#define X 0x80
+static const unsigned char compact_32[16][16] = {
+	{ X, X, X, X, X, X, X, X, X, X, X, X, X, X, X, X },
+	{ 0, 1, 2, 3, X, X, X, X, X, X, X, X, X, X, X, X },
+	{ 4, 5, 6, 7, X, X, X, X, X, X, X, X, X, X, X, X },
+	{ 0, 1, 2, 3, 4, 5, 6, 7, X, X, X, X, X, X, X, X },
+	{ 8, 9, 10, 11, X, X, X, X, X, X, X, X, X, X, X, X },
+	{ 0, 1, 2, 3, 8, 9, 10, 11, X, X, X, X, X, X, X, X },
+	{ 4, 5, 6, 7, 8, 9, 10, 11, X, X, X, X, X, X, X, X },
+	{ 0, 1, 2, 3, 4, 5, 6, 7, 8, 9, 10, 11, X, X, X, X },
+	{ 12, 13, 14, 15, X, X, X, X, X, X, X, X, X, X, X, X },
+	{ 0, 1, 2, 3, 12, 13, 14, 15, X, X, X, X, X, X, X, X },
+	{ 4, 5, 6, 7, 12, 13, 14, 15, X, X, X, X, X, X, X, X },
+	{ 0, 1, 2, 3, 4, 5, 6, 7, 12, 13, 14, 15, X, X, X, X },
+	{ 8, 9, 10, 11, 12, 13, 14, 15, X, X, X, X, X, X, X, X },
+	{ 0, 1, 2, 3, 8, 9, 10, 11, 12, 13, 14, 15, X, X, X, X },
+	{ 4, 5, 6, 7, 8, 9, 10, 11, 12, 13, 14, 15, X, X, X, X },
+	{ 0, 1, 2, 3, 4, 5, 6, 7, 8, 9, 10, 11, 12, 13, 14, 15 },
+};
+static const unsigned char compact_64[4][16] = {
+	{ X, X, X, X, X, X, X, X, X, X, X, X, X, X, X, X },
+	{ 0, 1, 2, 3, 4, 5, 6, 7, X, X, X, X, X, X, X, X },
+	{ 8, 9, 10, 11, 12, 13, 14, 15, X, X, X, X, X, X, X, X },
+	{ 0, 1, 2, 3, 4, 5, 6, 7, 8, 9, 10, 11, 12, 13, 14, 15 },
+};
+#undef X
+
+SSE42 static unsigned long filter_32_SSE42(int32_t *dst, const int32_t *src, unsigned long n, int32_t lo, int32_t hi) {
+	const __m128i vlo = _mm_set1_epi32(lo);
+	const __m128i vhi = _mm_set1_epi32(hi);
+	unsigned long count = 0;
+	unsigned long i = 0;
+	for (; i + 4 <= n; i += 4) {
+		__m128i x = _mm_loadu_si128((const __m128i *) (src + i));
+		__m128i out = _mm_or_si128(_mm_cmpgt_epi32(vlo, x), _mm_cmpgt_epi32(x, vhi));
+		unsigned mask = ~(unsigned) _mm_movemask_ps(_mm_castsi128_ps(out)) & 0xf;
+		__m128i shuffle = _mm_loadu_si128((const __m128i *) compact_32[mask]);
+		_mm_storeu_si128((__m128i *) (dst + count), _mm_shuffle_epi8(x, shuffle));
+		count += __builtin_popcount(mask);
+	}
+	return count + filter_32(dst + count, src + i, n - i, lo, hi);
+}
+
+SSE42 static unsigned long filter_64_SSE42(int64_t *dst, const int64_t *src, unsigned long n, int64_t lo, int64_t hi) {
+	const __m128i vlo = _mm_set1_epi64x(lo);
+	const __m128i vhi = _mm_set1_epi64x(hi);
+	unsigned long count = 0;
+	unsigned long i = 0;
+	for (; i + 2 <= n; i += 2) {
+		__m128i x = _mm_loadu_si128((const __m128i *) (src + i));
+		__m128i out = _mm_or_si128(_mm_cmpgt_epi64(vlo, x), _mm_cmpgt_epi64(x, vhi));
+		unsigned mask = ~(unsigned) _mm_movemask_pd(_mm_castsi128_pd(out)) & 0x3;
+		__m128i shuffle = _mm_loadu_si128((const __m128i *) compact_64[mask]);
+		_mm_storeu_si128((__m128i *) (dst + count), _mm_shuffle_epi8(x, shuffle));
+		count += __builtin_popcount(mask);
+	}
+	return count + filter_64(dst + count, src + i, n - i, lo, hi);
+}
+
+// permutation that moves the lanes of an 8 bit mask to the front
+AVX2 static inline __m256i compact_AVX2(unsigned mask) {
+	uint64_t spread = _pdep_u64(mask, 0x0101010101010101ULL) * 0xff;
+	uint64_t lanes = _pext_u64(0x0706050403020100ULL, spread);
+	return _mm256_cvtepu8_epi32(_mm_cvtsi64_si128((long long) lanes));
+}
+
+AVX2 static unsigned long filter_32_AVX2(int32_t *dst, const int32_t *src, unsigned long n, int32_t lo, int32_t hi) {
+	const __m256i vlo = _mm256_set1_epi32(lo);
+	const __m256i vhi = _mm256_set1_epi32(hi);
+	unsigned long count = 0;
+	unsigned long i = 0;
+	for (; i + 8 <= n; i += 8) {
+		__m256i x = _mm256_loadu_si256((const __m256i *) (src + i));
+		__m256i out = _mm256_or_si256(_mm256_cmpgt_epi32(vlo, x), _mm256_cmpgt_epi32(x, vhi));
+		unsigned mask = ~(unsigned) _mm256_movemask_ps(_mm256_castsi256_ps(out)) & 0xff;
+		_mm256_storeu_si256((__m256i *) (dst + count), _mm256_permutevar8x32_epi32(x, compact_AVX2(mask)));
+		count += __builtin_popcount(mask);
+	}
+	return count + filter_32(dst + count, src + i, n - i, lo, hi);
+}
+
+AVX2 static unsigned long filter_64_AVX2(int64_t *dst, const int64_t *src, unsigned long n, int64_t lo, int64_t hi) {
+	const __m256i vlo = _mm256_set1_epi64x(lo);
+	const __m256i vhi = _mm256_set1_epi64x(hi);
+	unsigned long count = 0;
+	unsigned long i = 0;
+	for (; i + 4 <= n; i += 4) {
+		__m256i x = _mm256_loadu_si256((const __m256i *) (src + i));
+		__m256i out = _mm256_or_si256(_mm256_cmpgt_epi64(vlo, x), _mm256_cmpgt_epi64(x, vhi));
+		unsigned mask = ~(unsigned) _mm256_movemask_pd(_mm256_castsi256_pd(out)) & 0xf;
+		// each 8 byte lane is two 4 byte lanes of the permutation
+		unsigned pairs = _pdep_u32(mask, 0x55) | _pdep_u32(mask, 0xaa);
+		_mm256_storeu_si256((__m256i *) (dst + count), _mm256_permutevar8x32_epi32(x, compact_AVX2(pairs)));
+		count += __builtin_popcount(mask);
+	}
+	return count + filter_64(dst + count, src + i, n - i, lo, hi);
+}
+
+#endif  // X86
+
+
+#ifdef NEON
+
+/*
+ * NEON kernels. Each compare sets all the bits of the equal lanes, and
+ * the lanes are counted by adding their lowest bit.
+ */
+#define NEON_FIND_COUNT(T, bits, U, Vec, dup, load, ceq, any, lanes_set)		\
+	static unsigned long find_##bits##_NEON(const T *a, unsigned long n, T key) {	\
+		const unsigned long lanes = sizeof(Vec) / sizeof(T);					\
+		const Vec k = dup((U) key);												\
+		unsigned long i = 0;													\
+		for (; i + lanes <= n; i += lanes) {									\
+			if (any(ceq(load((const U *) (a + i)), k))) {						\
+				break;															\
+			}																	\
+		}																		\
+		return i + find_##bits(a + i, n - i, key);								\
+	}																			\
+																				\
+	static unsigned long count_##bits##_NEON(const T *a, unsigned long n, T key) {	\
+		const unsigned long lanes = sizeof(Vec) / sizeof(T);					\
+		const Vec k = dup((U) key);												\
+		unsigned long count = 0;												\
+		unsigned long i = 0;													\
+		for (; i + lanes <= n; i += lanes) {									\
+			count += lanes_set(ceq(load((const U *) (a + i)), k));				\
+		}																		\
+		return count + count_##bits(a + i, n - i, key);							\
+	}																			\
+
+#define ANY_8(v) vmaxvq_u8(v)
+#define ANY_16(v) vmaxvq_u16(v)
+#define ANY_32(v) vmaxvq_u32(v)
+#define ANY_64(v) vmaxvq_u32(vreinterpretq_u32_u64(v))
+#define SET_8(v) vaddvq_u8(vshrq_n_u8(v, 7))
+#define SET_16(v) vaddvq_u16(vshrq_n_u16(v, 15))
+#define SET_32(v) vaddvq_u32(vshrq_n_u32(v, 31))
+#define SET_64(v) vaddvq_u64(vshrq_n_u64(v, 63))
+
+NEON_FIND_COUNT(int8_t, 8, uint8_t, uint8x16_t, vdupq_n_u8, vld1q_u8, vceqq_u8, ANY_8, SET_8)
+NEON_FIND_COUNT(int16_t, 16, uint16_t, uint16x8_t, vdupq_n_u16, vld1q_u16, vceqq_u16, ANY_16, SET_16)
+NEON_FIND_COUNT(int32_t, 32, uint32_t, uint32x4_t, vdupq_n_u32, vld1q_u32, vceqq_u32, ANY_32, SET_32)
+NEON_FIND_COUNT(int64_t, 64, uint64_t, uint64x2_t, vdupq_n_u64, vld1q_u64, vceqq_u64, ANY_64, SET_64)
+
+#endif  // NEON
+
+
+/*
+ * Dispatch by width and by level. The x86 kernels exist for both SSE4.2
+ * and AVX2, so a level picks among them.
+ */
+#ifdef X86
+#define DISPATCH(name, bits, ...)												\
+	(ds_simd_level() == DS_SIMD_AVX2 ? name##_##bits##_AVX2(__VA_ARGS__) :		\
+	 ds_simd_level() == DS_SIMD_SSE42 ? name##_##bits##_SSE42(__VA_ARGS__) :	\
+	 name##_##bits(__VA_ARGS__))
+#define DISPATCH_VOID(name, bits, ...) DISPATCH(name, bits, __VA_ARGS__)
+#elif defined(NEON)
+#define DISPATCH(name, bits, ...)												\
+	(ds_simd_level() == DS_SIMD_NEON ? name##_##bits##_NEON(__VA_ARGS__) :		\
+	 name##_##bits(__VA_ARGS__))
+#define DISPATCH_VOID(name, bits, ...) name##_##bits(__VA_ARGS__)
+#else
+#define DISPATCH(name, bits, ...) name##_##bits(__VA_ARGS__)
+#define DISPATCH_VOID(name, bits, ...) name##_##bits(__VA_ARGS__)
+#endif
+
+// the filters are vectorized for 4 and 8 byte elements on x86
+#ifdef X86
+#define DISPATCH_FILTER(bits, ...) DISPATCH(filter, bits, __VA_ARGS__)
+#else
+#define DISPATCH_FILTER(bits, ...) filter_##bits(__VA_ARGS__)
+#endif
+
+
+int ds_simd_level(void) {
+	int current = atomic_load_explicit(&level, memory_order_relaxed);
+	if (current < 0) {
+		current = detect();
+		atomic_store_explicit(&level, current, memory_order_relaxed);
+	}
+	return current;
+}
+
+void ds_simd_limit(int limit) {
+	int detected = detect();
+	atomic_store_explicit(&level, limit < detected ? limit : detected, memory_order_relaxed);
+}
+
+unsigned long ds_find(const void *array, unsigned long length, unsigned long width, const void *key) {
+	const unsigned char *bytes = array;
+	int8_t k8;
+	int16_t k16;
+	int32_t k32;
+	int64_t k64;
+	switch (width) {
+		case 1:
+			memcpy(&k8, key, 1);
+			return DISPATCH(find, 8, array, length, k8);
+		case 2:
+			memcpy(&k16, key, 2);
+			return DISPATCH(find, 16, array, length, k16);
+		case 4:
+			memcpy(&k32, key, 4);
+			return DISPATCH(find, 32, array, length, k32);
+		case 8:
+			memcpy(&k64, key, 8);
+			return DISPATCH(find, 64, array, length, k64);
+	}
+	for (unsigned long i = 0; i < length; i++) {
+		if (memcmp(bytes + i * width, key, width) == 0) {
+			return i;
+		}
+	}
+	return length;
+}
+
+unsigned long ds_count(const void *array, unsigned long length, unsigned long width, const void *key) {
+	const unsigned char *bytes = array;
+	unsigned long count = 0;
+	int8_t k8;
+	int16_t k16;
+	int32_t k32;
+	int64_t k64;
+	switch (width) {
+		case 1:
+			memcpy(&k8, key, 1);
+			return DISPATCH(count, 8, array, length, k8);
+		case 2:
+			memcpy(&k16, key, 2);
+			return DISPATCH(count, 16, array, length, k16);
+		case 4:
+			memcpy(&k32, key, 4);
+			return DISPATCH(count, 32, array, length, k32);
+		case 8:
+			memcpy(&k64, key, 8);
+			return DISPATCH(count, 64, array, length, k64);
+	}
+	for (unsigned long i = 0; i < length; i++) {
+		count += memcmp(bytes + i * width, key, width) == 0;
+	}
+	return count;
+}
+
+int ds_min_max(const void *array, unsigned long length, unsigned long width, void *out_min, void *out_max) {
+	union { int8_t i8; int16_t i16; int32_t i32; int64_t i64; } min, max;
+	if (width != 1 && width != 2 && width != 4 && width != 8) {
+		return DS_OUT_OF_BOUNDS;
+	}
+	if (length == 0) {
+		return DS_EMPTY;
+	}
+	memcpy(&min, array, width);
+	memcpy(&max, array, width);
+	switch (width) {
+		case 1:
+			DISPATCH_VOID(min_max, 8, array, length, &min.i8, &max.i8);
+			break;
+		case 2:
+			DISPATCH_VOID(min_max, 16, array, length, &min.i16, &max.i16);
+			break;
+		case 4:
+			DISPATCH_VOID(min_max, 32, array, length, &min.i32, &max.i32);
+			break;
+		case 8:
+			DISPATCH_VOID(min_max, 64, array, length, &min.i64, &max.i64);
+			break;
+	}
+	if (out_min) {
+		memcpy(out_min, &min, width);
+	}
+	if (out_max) {
+		memcpy(out_max, &max, width);
+	}
+	return DS_OK;
+}
+
+int ds_filter_range(
+		void *dst,
+		unsigned long *out_length,
+		const void *src,
+		unsigned long length,
+		unsigned long width,
+		const void *lo,
+		const void *hi)
+{
+	union { int8_t i8; int16_t i16; int32_t i32; int64_t i64; } l, h;
+	switch (width) {
+		case 1:
+			memcpy(&l, lo, 1);
+			memcpy(&h, hi, 1);
+			*out_length = filter_8(dst, src, length, l.i8, h.i8);
+			return DS_OK;
+		case 2:
+			memcpy(&l, lo, 2);
+			memcpy(&h, hi, 2);
+			*out_length = filter_16(dst, src, length, l.i16, h.i16);
+			return DS_OK;
+		case 4:
+			memcpy(&l, lo, 4);
+			memcpy(&h, hi, 4);
+			*out_length = DISPATCH_FILTER(32, dst, src, length, l.i32, h.i32);
+			return DS_OK;
+		case 8:
+			memcpy(&l, lo, 8);
+			memcpy(&h, hi, 8);
+			*out_length = DISPATCH_FILTER(64, dst, src, length, l.i64, h.i64);
+			return DS_OK;
+	}
+	return DS_OUT_OF_BOUNDS;
+}
+
+int ds_filter(
+		void *dst,
+		unsigned long *out_length,
+		const void *src,
+		unsigned long length,
+		unsigned long width,
+		DSPredicate predicate,
+		void *context)
+{
+	unsigned char *to = dst;
+	const unsigned char *from = src;
+	unsigned long count = 0;
+	for (unsigned long i = 0; i < length; i++) {
+		if (predicate(from + i * width, context)) {
+			memmove(to + count * width, from + i * width, width);
+			count++;
+		}
+	}
+	*out_length = count;
+	return DS_OK;
+}
+
+int alist_find(AList *list, const void *data, unsigned long *out_index) {
+	unsigned long index = ds_find(list->array, list->length, list->data_size, data);
+	if (index == list->length) {
+		return DS_NOT_FOUND;
+	}
+	*out_index = index;
+	return DS_OK;
+}
+
+unsigned long alist_count(AList *list, const void *data) {
+	return ds_count(list->array, list->length, list->data_size, data);
+}
+
+int alist_min_max(AList *list, void *out_min, void *out_max) {
+	return ds_min_max(list->array, list->length, list->data_size, out_min, out_max);
+}
+
+int alist_filter_range(AList *dst, AList *src, const void *lo, const void *hi) {
+	unsigned long length = src->length;
+	dst->length = 0;
+	// as much as fits at a time; when dst is full, one record into the
+	// room for sorting after it, to see if there were more
+	for (unsigned long i = 0; i < length; ) {
+		unsigned long room = dst->max_length - dst->length;
+		unsigned long chunk = room == 0 ? 1 : room < length - i ? room : length - i;
+		unsigned long count;
+		int rval = ds_filter_range(
+				dst->array + dst->length * dst->data_size, &count,
+				src->array + i * src->data_size, chunk, src->data_size, lo, hi);
+		if (rval != DS_OK) {
+			return rval;
+		}
+		if (room == 0 && count > 0) {
+			return DS_OVERFLOW;
+		}
+		dst->length += count;
+		i += chunk;
+	}
+	return DS_OK;
+}
+
+int alist_filter(AList *dst, AList *src, DSPredicate predicate, void *context) {
+	unsigned long length = src->length;
+	unsigned long count = 0;
+	for (unsigned long i = 0; i < length; i++) {
+		const unsigned char *data = src->array + i * src->data_size;
+		if (predicate(data, context)) {
+			if (count == dst->max_length) {
+				dst->length = count;
+				return DS_OVERFLOW;
+			}
+			memmove(dst->array + count * dst->data_size, data, src->data_size);
+			count++;
+		}
+	}
+	dst->length = count;
+	return DS_OK;
+}
+
+
+static int detect(void) {
+#if defined(X86)
+	__builtin_cpu_init();
+	if (__builtin_cpu_supports("avx2") && __builtin_cpu_supports("bmi2") && __builtin_cpu_supports("popcnt")) {
+		return DS_SIMD_AVX2;
+	}
+	if (__builtin_cpu_supports("sse4.2") && __builtin_cpu_supports("popcnt")) {
+		return DS_SIMD_SSE42;
+	}
+	return DS_SIMD_SCALAR;
+#elif defined(NEON)
+	return DS_SIMD_NEON;
+#else
+	return DS_SIMD_SCALAR;
+#endif
+}
@@ -0,0 +1,86 @@
+#ifndef __SEARCH_H__
+#define __SEARCH_H__
+
+#include "alist.h"
+
+/*
+ * Search Kernels
+ * Linear scans over arrays of length elements of width bytes. Some of them
+ * are vectorized, with AVX2 or SSE4.2 on x86-64, chosen at run time from
+ * cpuid, or with NEON on AArch64, for these widths:
+ *
+ *                  x86-64          AArch64
+ * ds_find          1, 2, 4, 8      1, 2, 4, 8
+ * ds_count         1, 2, 4, 8      1, 2, 4, 8
+ * ds_min_max       1, 2, 4, 8      -
+ * ds_filter_range  4, 8            -
+ *
+ * The other widths, ds_filter, and other CPUs use scalar loops.
+ *
+ * ds_find returns the index of the first element equal to key, byte for
+ * byte, or length if there is none. ds_count returns how many there are.
+ * Any width works.
+ *
+ * ds_min_max and ds_filter_range read the elements as signed integers of
+ * width 1, 2, 4 or 8 and return DS_OUT_OF_BOUNDS for other widths.
+ * ds_min_max writes the least and the greatest element to out_min and
+ * out_max, either of which may be NULL, or returns DS_EMPTY if length is 0.
+ * ds_filter_range copies the elements x with lo <= x <= hi to dst, in
+ * order, and writes their number to out_length. dst needs room for length
+ * elements, and must not overlap src unless it is src itself.
+ *
+ * ds_filter copies the elements for which predicate returns non zero to
+ * dst, in the same way. It calls predicate for each element, so it is not
+ * vectorized.
+ *
+ * The arrays of the lists of list.h can be passed as they are:
+ *
+ * unsigned long i = ds_find(list.elms, list.length, sizeof(int), &key);
+ *
+ * The functions prefixed alist_ run the kernels over the records of an
+ * AList. alist_find writes the index of the first record equal to data to
+ * out_index or returns DS_NOT_FOUND. alist_filter_range and alist_filter
+ * clear dst, which must have the same data_size as src or be src itself,
+ * and return DS_OVERFLOW if the records selected do not fit.
+ *
+ * ds_simd_level returns the instruction set in use, and ds_simd_limit
+ * restricts it to a lower one, as to test or compare the kernels.
+ */
+enum DSSimdLevel {
+	DS_SIMD_SCALAR = 0,
+	DS_SIMD_SSE42,
+	DS_SIMD_AVX2,
+	DS_SIMD_NEON
+};
+
+int ds_simd_level(void);
+void ds_simd_limit(int level);
+
+unsigned long ds_find(const void *array, unsigned long length, unsigned long width, const void *key);
+unsigned long ds_count(const void *array, unsigned long length, unsigned long width, const void *key);
+int ds_min_max(const void *array, unsigned long length, unsigned long width, void *out_min, void *out_max);
+int ds_filter_range(
+		void *dst,
+		unsigned long *out_length,
+		const void *src,
+		unsigned long length,
+		unsigned long width,
+		const void *lo,
+		const void *hi);
+int ds_filter(
+		void *dst,
+		unsigned long *out_length,
+		const void *src,
+		unsigned long length,
+		unsigned long width,
+		DSPredicate predicate,
+		void *context);
+
+int alist_find(AList *list, const void *data, unsigned long *out_index);
+unsigned long alist_count(AList *list, const void *data);
+int alist_min_max(AList *list, void *out_min, void *out_max);
+int alist_filter_range(AList *dst, AList *src, const void *lo, const void *hi);
+int alist_filter(AList *dst, AList *src, DSPredicate predicate, void *context);
+
+
+#endif  // __SEARCH_H__
@@ -0,0 +1,203 @@
+#include "search.h"
+#include <assert.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <stdio.h>
+#include <string.h>
+
+#define LENGTH 1000
+
+typedef struct Point {
+	int x;
+	int y;
+	int z;
+} Point;
+
+int is_even(const int *n, void *context) {
+	(void) context;
+	return *n % 2 == 0;
+}
+
+int is_above(const int *n, const int *limit) {
+	return *n > *limit;
+}
+
+// read the element at i of width bytes as a signed integer
+long long element(const void *array, unsigned long width, unsigned long i) {
+	const unsigned char *p = (const unsigned char *) array + i * width;
+	int8_t i8;
+	int16_t i16;
+	int32_t i32;
+	int64_t i64;
+	switch (width) {
+		case 1: memcpy(&i8, p, 1); return i8;
+		case 2: memcpy(&i16, p, 2); return i16;
+		case 4: memcpy(&i32, p, 4); return i32;
+		default: memcpy(&i64, p, 8); return i64;
+	}
+}
+
+// compare every kernel with a plain loop, on all the lengths up to LENGTH
+// so that every tail is covered
+void check_width(unsigned long width) {
+	unsigned char *array = malloc(LENGTH * width);
+	unsigned char *dst = malloc(LENGTH * width);
+	for (unsigned long i = 0; i < LENGTH * width; i++) {
+		array[i] = (unsigned char) (rand() % 7 == 0 ? 0x80 : rand() % 5);
+	}
+	for (unsigned long length = 0; length <= LENGTH; length += length < 70 ? 1 : 97) {
+		for (unsigned long k = 0; k < length && k < 5; k++) {
+			const void *key = array + (length - 1 - k * 13 % length) * width;
+			unsigned long first = length;
+			unsigned long count = 0;
+			for (unsigned long i = 0; i < length; i++) {
+				if (memcmp(array + i * width, key, width) == 0) {
+					first = first == length ? i : first;
+					count++;
+				}
+			}
+			assert(ds_find(array, length, width, key) == first);
+			assert(ds_count(array, length, width, key) == count);
+		}
+		{
+			unsigned char absent[8] = { 9, 9, 9, 9, 9, 9, 9, 9 };
+			assert(ds_find(array, length, width, absent) == length);
+			assert(ds_count(array, length, width, absent) == 0);
+		}
+
+		if (width == 3) {
+			continue;
+		}
+		if (length == 0) {
+			assert(ds_min_max(array, 0, width, NULL, NULL) == DS_EMPTY);
+			continue;
+		}
+		long long min = element(array, width, 0), max = min;
+		for (unsigned long i = 1; i < length; i++) {
+			long long e = element(array, width, i);
+			min = e < min ? e : min;
+			max = e > max ? e : max;
+		}
+		unsigned char out_min[8], out_max[8];
+		assert(ds_min_max(array, length, width, out_min, out_max) == DS_OK);
+		assert(element(out_min, width, 0) == min);
+		assert(element(out_max, width, 0) == max);
+
+		const void *lo = array + (length / 3) * width;
+		const void *hi = array + (length / 2) * width;
+		unsigned long filtered;
+		unsigned long count = 0;
+		assert(ds_filter_range(dst, &filtered, array, length, width, lo, hi) == DS_OK);
+		for (unsigned long i = 0; i < length; i++) {
+			long long e = element(array, width, i);
+			if (element(lo, width, 0) <= e && e <= element(hi, width, 0)) {
+				assert(element(dst, width, count) == e);
+				count++;
+			}
+		}
+		assert(filtered == count);
+	}
+	free(array);
+	free(dst);
+}
+
+int main() {
+	int level = ds_simd_level();
+	printf("simd level %d\n", level);
+
+	for (int limit = level; limit >= DS_SIMD_SCALAR; limit--) {
+		ds_simd_limit(limit);
+		assert(ds_simd_level() == limit);
+		srand(limit);
+		check_width(1);
+		check_width(2);
+		check_width(4);
+		check_width(8);
+		check_width(3);
+	}
+	ds_simd_limit(level);
+	assert(ds_simd_level() == level);
+
+	// other widths
+	{
+		Point points[100];
+		for (int i = 0; i < 100; i++) {
+			points[i] = (Point) { i, i % 10, 0 };
+		}
+		Point key = { 42, 2, 0 };
+		assert(ds_find(points, 100, sizeof(Point), &key) == 42);
+		assert(ds_count(points, 100, sizeof(Point), &key) == 1);
+		assert(ds_min_max(points, 100, sizeof(Point), NULL, NULL) == DS_OUT_OF_BOUNDS);
+		assert(ds_filter_range(points, &(unsigned long) { 0 }, points, 100, sizeof(Point), &key, &key) == DS_OUT_OF_BOUNDS);
+	}
+
+	// a large scan in place
+	{
+		unsigned long length = 1000000;
+		long *longs = malloc(length * sizeof(long));
+		unsigned long filtered;
+		for (unsigned long i = 0; i < length; i++) {
+			longs[i] = (long) i - 500000;
+		}
+		long key = 499999, lo = -10, hi = 10, min, max;
+		assert(ds_find(longs, length, sizeof(long), &key) == length - 1);
+		assert(ds_min_max(longs, length, sizeof(long), &min, &max) == DS_OK);
+		assert(min == -500000 && max == 499999);
+		assert(ds_filter_range(longs, &filtered, longs, length, sizeof(long), &lo, &hi) == DS_OK);
+		assert(filtered == 21);
+		for (unsigned long i = 0; i < filtered; i++) {
+			assert(longs[i] == (long) i - 10);
+		}
+		free(longs);
+	}
+
+	// alists
+	{
+		AList *list = alist_new(LENGTH, sizeof(int));
+		AList *dst = alist_new(LENGTH, sizeof(int));
+		AList *small = alist_new(10, sizeof(int));
+		unsigned long index;
+		int min, max;
+		for (int i = 0; i < LENGTH; i++) {
+			int n = i % 100;
+			alist_push(list, &n);
+		}
+		assert(alist_find(list, &(int) { 42 }, &index) == DS_OK);
+		assert(index == 42);
+		assert(alist_find(list, &(int) { 100 }, &index) == DS_NOT_FOUND);
+		assert(alist_count(list, &(int) { 42 }) == 10);
+		assert(alist_min_max(list, &min, &max) == DS_OK);
+		assert(min == 0 && max == 99);
+
+		assert(alist_filter_range(dst, list, &(int) { 10 }, &(int) { 19 }) == DS_OK);
+		assert(dst->length == 100);
+		assert(alist_filter_range(small, list, &(int) { 10 }, &(int) { 10 }) == DS_OK);
+		assert(small->length == 10);
+		assert(alist_filter_range(small, list, &(int) { 10 }, &(int) { 11 }) == DS_OVERFLOW);
+		assert(small->length == 10);
+		for (unsigned long i = 0; i < small->length; i++) {
+			int n;
+			alist_get(small, i, &n);
+			assert(n == 10 + (int) i % 2);
+		}
+
+		assert(alist_filter(dst, list, (DSPredicate) is_even, NULL) == DS_OK);
+		assert(dst->length == 500);
+		assert(alist_filter(small, list, (DSPredicate) is_above, &(int) { 98 }) == DS_OK);
+		assert(small->length == 10);
+		assert(alist_filter(small, list, (DSPredicate) is_above, &(int) { 97 }) == DS_OVERFLOW);
+
+		// in place
+		assert(alist_filter_range(list, list, &(int) { 0 }, &(int) { 49 }) == DS_OK);
+		assert(list->length == 500);
+		assert(alist_filter(list, list, (DSPredicate) is_even, NULL) == DS_OK);
+		assert(list->length == 250);
+		assert(alist_count(list, &(int) { 48 }) == 10);
+
+		alist_delete(list);
+		alist_delete(dst);
+		alist_delete(small);
+	}
+
+	return 0;
+}
@@ -0,0 +1,152 @@
+#include "segtree.h"
+#include <stdlib.h>
+
+// sums wrap around instead of overflowing, which is undefined for long
+#define ADD(a, b) ((long) ((unsigned long) (a) + (unsigned long) (b)))
+#define MIN(a, b) ((a) < (b) ? (a) : (b))
+
+#define BLOCK_SIZE(length) (4 * ((length) ? (length) : 1) * sizeof(long))
+
+static SegTree *alloc_tree(const DSAllocator *allocator, unsigned long length);
+static void build(SegTree *tree);
+
+
+SegTree *seg_new(const long *values, unsigned long length) {
+	return seg_new_with(NULL, values, length);
+}
+
+SegTree *seg_new_with(const DSAllocator *allocator, const long *values, unsigned long length) {
+	SegTree *tree = alloc_tree(allocator, length);
+	if (!tree) {
+		return NULL;
+	}
+	for (unsigned long i = 0; i < length; i++) {
+		tree->sums[length + i] = values[i];
+		tree->mins[length + i] = values[i];
+	}
+	build(tree);
+	return tree;
+}
+
+SegTree *seg_from_alist(AList *list, DSKey key) {
+	SegTree *tree = alloc_tree(list->allocator, list->length);
+	if (!tree) {
+		return NULL;
+	}
+	for (unsigned long i = 0; i < list->length; i++) {
+		long value = key(list->array + i * list->data_size);
+		tree->sums[list->length + i] = value;
+		tree->mins[list->length + i] = value;
+	}
+	build(tree);
+	return tree;
+}
+
+void seg_delete(SegTree *tree) {
+	if (tree) {
+		ds_free_with(tree->allocator, tree->sums, BLOCK_SIZE(tree->length));
+		ds_free_with(tree->allocator, tree, sizeof(SegTree));
+	}
+}
+
+unsigned long seg_length(SegTree *tree) {
+	return tree->length;
+}
+
+int seg_get(SegTree *tree, unsigned long index, long *out_value) {
+	if (index >= tree->length) {
+		return DS_OUT_OF_BOUNDS;
+	}
+	*out_value = tree->sums[tree->length + index];
+	return DS_OK;
+}
+
+// Sets the leaf and recomputes the entries above it.
+int seg_set(SegTree *tree, unsigned long index, long value) {
+	unsigned long i;
+	if (index >= tree->length) {
+		return DS_OUT_OF_BOUNDS;
+	}
+	i = tree->length + index;
+	tree->sums[i] = value;
+	tree->mins[i] = value;
+	for (i >>= 1; i > 0; i >>= 1) {
+		tree->sums[i] = ADD(tree->sums[2 * i], tree->sums[2 * i + 1]);
+		tree->mins[i] = MIN(tree->mins[2 * i], tree->mins[2 * i + 1]);
+	}
+	return DS_OK;
+}
+
+int seg_add(SegTree *tree, unsigned long index, long delta) {
+	if (index >= tree->length) {
+		return DS_OUT_OF_BOUNDS;
+	}
+	return seg_set(tree, index, ADD(tree->sums[tree->length + index], delta));
+}
+
+// Moves the ends of the range up a level at a time, taking in the entry at
+// an end when its sibling is outside the range.
+int seg_sum(SegTree *tree, unsigned long from, unsigned long to, long *out_sum) {
+	long sum = 0;
+	if (from > to || to > tree->length) {
+		return DS_OUT_OF_BOUNDS;
+	}
+	for (from += tree->length, to += tree->length; from < to; from >>= 1, to >>= 1) {
+		if (from & 1) {
+			sum = ADD(sum, tree->sums[from++]);
+		}
+		if (to & 1) {
+			sum = ADD(sum, tree->sums[--to]);
+		}
+	}
+	*out_sum = sum;
+	return DS_OK;
+}
+
+int seg_min(SegTree *tree, unsigned long from, unsigned long to, long *out_min) {
+	long min;
+	if (from > to || to > tree->length) {
+		return DS_OUT_OF_BOUNDS;
+	}
+	if (from == to) {
+		return DS_EMPTY;
+	}
+	min = tree->mins[tree->length + from];
+	for (from += tree->length, to += tree->length; from < to; from >>= 1, to >>= 1) {
+		if (from & 1) {
+			min = MIN(min, tree->mins[from]);
+			from++;
+		}
+		if (to & 1) {
+			to--;
+			min = MIN(min, tree->mins[to]);
+		}
+	}
+	*out_min = min;
+	return DS_OK;
+}
+
+
+static SegTree *alloc_tree(const DSAllocator *allocator, unsigned long length) {
+	SegTree *tree = ds_alloc_with(allocator, sizeof(SegTree));
+	if (!tree) {
+		return NULL;
+	}
+	tree->sums = ds_alloc_with(allocator, BLOCK_SIZE(length));
+	if (!tree->sums) {
+		ds_free_with(allocator, tree, sizeof(SegTree));
+		return NULL;
+	}
+	tree->mins = tree->sums + 2 * (length ? length : 1);
+	tree->length = length;
+	tree->allocator = allocator;
+	return tree;
+}
+
+// the entries below length from the top of the leaves down
+static void build(SegTree *tree) {
+	for (unsigned long i = tree->length; i-- > 1;) {
+		tree->sums[i] = ADD(tree->sums[2 * i], tree->sums[2 * i + 1]);
+		tree->mins[i] = MIN(tree->mins[2 * i], tree->mins[2 * i + 1]);
+	}
+}
@@ -0,0 +1,53 @@
+#ifndef __SEGTREE_H__
+#define __SEGTREE_H__
+
+#include "alist.h"
+
+/*
+ * Segment Tree
+ * Fixed number of long values, as counters, that answers the sum and the
+ * least of any range of them in O(log n), and changes one in O(log n).
+ * The tree is two arrays of 2 * length longs, one for the sums and one for
+ * the minimums, with the values in the second halves and each entry i
+ * below length holding the sum or the minimum of the entries 2i and
+ * 2i + 1. It is built bottom up in O(n) and the queries walk it bottom up
+ * too, without recursion.
+ *
+ * seg_new copies length values. seg_from_alist takes the value of each
+ * record of an AList from key, and uses the allocator of the list:
+ *
+ * long hits(const Counter *counter) { return counter->hits; }
+ * SegTree *tree = seg_from_alist(counters, (DSKey) hits);
+ *
+ * The tree does not follow the list afterwards; seg_set and seg_add change
+ * the value at index.
+ *
+ * seg_sum and seg_min take the half open range of indices [from, to) and
+ * return DS_OUT_OF_BOUNDS if from is greater than to or to greater than
+ * the length. The sum of an empty range is 0; seg_min returns DS_EMPTY for
+ * it. Sums wrap around like unsigned arithmetic if they overflow.
+ */
+typedef struct SegTree {
+	long *sums;
+	long *mins;
+	unsigned long length;
+	const DSAllocator *allocator;
+} SegTree;
+
+
+SegTree *seg_new(const long *values, unsigned long length);
+SegTree *seg_new_with(const DSAllocator *allocator, const long *values, unsigned long length);
+SegTree *seg_from_alist(AList *list, DSKey key);
+void seg_delete(SegTree *tree);
+
+unsigned long seg_length(SegTree *tree);
+
+int seg_get(SegTree *tree, unsigned long index, long *out_value);
+int seg_set(SegTree *tree, unsigned long index, long value);
+int seg_add(SegTree *tree, unsigned long index, long delta);
+
+int seg_sum(SegTree *tree, unsigned long from, unsigned long to, long *out_sum);
+int seg_min(SegTree *tree, unsigned long from, unsigned long to, long *out_min);
+
+
+#endif  // __SEGTREE_H__
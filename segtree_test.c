@@ -0,0 +1,121 @@
+#include "segtree.h"
+#include <assert.h>
+#include <limits.h>
+#include <stdlib.h>
+#include <stdio.h>
+
+#define LENGTH 1000
+
+typedef struct Counter {
+	int id;
+	long hits;
+} Counter;
+
+long hits(const Counter *counter) {
+	return counter->hits;
+}
+
+// checks the tree against the values on random ranges, and all the short ones
+void check_ranges(SegTree *tree, const long *values, unsigned long length) {
+	for (int q = 0; q < 2000; q++) {
+		unsigned long from = (unsigned long) rand() % (length + 1);
+		unsigned long to = from + (unsigned long) rand() % (length + 1 - from);
+		if (q < 200) {
+			to = from + (unsigned long) q % 4 < length ? from + (unsigned long) q % 4 : length;
+		}
+		long sum = 0, min = LONG_MAX;
+		for (unsigned long i = from; i < to; i++) {
+			sum += values[i];
+			min = values[i] < min ? values[i] : min;
+		}
+		long out;
+		assert(seg_sum(tree, from, to, &out) == DS_OK);
+		assert(out == sum);
+		if (from == to) {
+			assert(seg_min(tree, from, to, &out) == DS_EMPTY);
+		}
+		else {
+			assert(seg_min(tree, from, to, &out) == DS_OK);
+			assert(out == min);
+		}
+	}
+}
+
+int main() {
+	srand(3);
+
+	// every length up to 40, then a long one, with point updates
+	{
+		static long values[LENGTH];
+		for (unsigned long length = 0; length <= LENGTH; length = length < 40 ? length + 1 : LENGTH) {
+			for (unsigned long i = 0; i < length; i++) {
+				values[i] = rand() % 2001 - 1000;
+			}
+			SegTree *tree = seg_new(values, length);
+			assert(tree);
+			assert(seg_length(tree) == length);
+			check_ranges(tree, values, length);
+			for (int u = 0; u < 100 && length > 0; u++) {
+				unsigned long i = (unsigned long) rand() % length;
+				long value = rand() % 2001 - 1000;
+				if (u % 2) {
+					assert(seg_set(tree, i, value) == DS_OK);
+					values[i] = value;
+				}
+				else {
+					assert(seg_add(tree, i, value) == DS_OK);
+					values[i] += value;
+				}
+				long out;
+				assert(seg_get(tree, i, &out) == DS_OK);
+				assert(out == values[i]);
+			}
+			check_ranges(tree, values, length);
+
+			long out;
+			assert(seg_get(tree, length, &out) == DS_OUT_OF_BOUNDS);
+			assert(seg_set(tree, length, 0) == DS_OUT_OF_BOUNDS);
+			assert(seg_add(tree, length, 0) == DS_OUT_OF_BOUNDS);
+			assert(seg_sum(tree, 0, length + 1, &out) == DS_OUT_OF_BOUNDS);
+			assert(seg_min(tree, 1, 0, &out) == DS_OUT_OF_BOUNDS);
+			seg_delete(tree);
+			if (length == LENGTH) {
+				break;
+			}
+		}
+	}
+
+	// over the counters of an AList
+	{
+		AList *counters = alist_new(100, sizeof(Counter));
+		long values[100];
+		for (int i = 0; i < 100; i++) {
+			Counter counter = { i, (i * 37) % 101 };
+			alist_push(counters, &counter);
+			values[i] = counter.hits;
+		}
+		SegTree *tree = seg_from_alist(counters, (DSKey) hits);
+		check_ranges(tree, values, 100);
+		long out;
+		assert(seg_sum(tree, 0, 100, &out) == DS_OK);
+		assert(out == 5050 - 64);  // all of 0 to 100 but 100 * 37 % 101
+		assert(seg_min(tree, 0, 100, &out) == DS_OK);
+		assert(out == 0);
+		seg_delete(tree);
+		alist_delete(counters);
+	}
+
+	// from an arena
+	{
+		DSArena *arena = ds_arena_new(1 << 16);
+		long values[] = { 5, 3, 8, -2, 7 };
+		SegTree *tree = seg_new_with(ds_arena_allocator(arena), values, 5);
+		long out;
+		assert(seg_sum(tree, 1, 4, &out) == DS_OK && out == 9);
+		assert(seg_min(tree, 0, 3, &out) == DS_OK && out == 3);
+		seg_delete(tree);
+		ds_arena_delete(arena);
+	}
+
+	return 0;
+}
@@ -0,0 +1,357 @@
+#include "skiplist.h"
+#include <stdatomic.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+
+#define ALIGN(n) (((n) + _Alignof(max_align_t) - 1) & ~(_Alignof(max_align_t) - 1))
+
+#define LOAD(p) atomic_load_explicit(&(p), memory_order_acquire)
+#define STORE(p, v) atomic_store_explicit(&(p), (v), memory_order_release)
+
+typedef struct SLNode {
+	int level;
+	struct SLNode *_Atomic next[];  // followed by the key and the value
+} SLNode;
+
+typedef struct SLBlock {
+	struct SLBlock *next;
+	unsigned long size;
+	_Atomic unsigned long used;
+	unsigned char *data;
+} SLBlock;
+
+static unsigned long node_size(SkipList *list, int level);
+static unsigned char *node_key(SLNode *node);
+static SLNode *new_node(SkipList *list, int level, const void *key, const void *value);
+static void *pool_alloc(SkipList *list, unsigned long size);
+static void pool_free(SkipList *list);
+static int random_level(void);
+static SLNode *search(SkipList *list, const void *key, SLNode **preds, SLNode **succs);
+static void raise_level(SkipList *list, int level);
+
+
+SkipList *sl_new(unsigned long key_size, unsigned long value_size, DSCompare compare) {
+	return sl_new_with(NULL, key_size, value_size, compare);
+}
+
+SkipList *sl_new_with(const DSAllocator *allocator, unsigned long key_size, unsigned long value_size, DSCompare compare) {
+	SkipList *list;
+	list = ds_alloc_with(allocator, sizeof(SkipList));
+	if (!list) {
+		return NULL;
+	}
+	memset(list, 0, sizeof(SkipList));
+	list->key_size = key_size;
+	list->value_size = value_size;
+	list->compare = compare;
+	list->allocator = allocator;
+	list->level = 1;
+	list->head = ds_alloc_with(allocator, node_size(list, SL_MAX_LEVEL));
+	if (!list->head) {
+		ds_free_with(allocator, list, sizeof(SkipList));
+		return NULL;
+	}
+	list->head->level = SL_MAX_LEVEL;
+	for (int i = 0; i < SL_MAX_LEVEL; i++) {
+		atomic_init(&list->head->next[i], NULL);
+	}
+	return list;
+}
+
+void sl_delete(SkipList *list) {
+	if (list) {
+		pool_free(list);
+		ds_free_with(list->allocator, list->head, node_size(list, SL_MAX_LEVEL));
+		ds_free_with(list->allocator, list, sizeof(SkipList));
+	}
+}
+
+unsigned long sl_length(SkipList *list) {
+	return atomic_load_explicit(&list->length, memory_order_relaxed);
+}
+
+int sl_put(SkipList *list, const void *key, const void *value) {
+	SLNode *preds[SL_MAX_LEVEL];
+	SLNode *succs[SL_MAX_LEVEL];
+	SLNode *node = search(list, key, preds, succs);
+	int level;
+	if (node) {
+		if (list->value_size > 0) {
+			memcpy(node_key(node) + list->key_size, value, list->value_size);
+		}
+		return DS_OK;
+	}
+	level = random_level();
+	node = list->pool.free[level - 1];
+	if (node) {
+		list->pool.free[level - 1] = atomic_load_explicit(&node->next[0], memory_order_relaxed);
+		memcpy(node_key(node), key, list->key_size);
+		if (list->value_size > 0) {
+			memcpy(node_key(node) + list->key_size, value, list->value_size);
+		}
+	}
+	else {
+		node = new_node(list, level, key, value);
+		if (!node) {
+			return DS_MALLOC_ERROR;
+		}
+	}
+	for (int i = 0; i < level; i++) {
+		atomic_store_explicit(&node->next[i], succs[i], memory_order_relaxed);
+		STORE(preds[i]->next[i], node);
+	}
+	raise_level(list, level);
+	atomic_fetch_add_explicit(&list->length, 1, memory_order_relaxed);
+	return DS_OK;
+}
+
+int sl_put_concurrent(SkipList *list, const void *key, const void *value) {
+	SLNode *preds[SL_MAX_LEVEL];
+	SLNode *succs[SL_MAX_LEVEL];
+	SLNode *node;
+	int level;
+	if (search(list, key, preds, succs)) {
+		return DS_EXISTS;
+	}
+	level = random_level();
+	node = new_node(list, level, key, value);
+	if (!node) {
+		return DS_MALLOC_ERROR;
+	}
+	// the node is in the list once it is in the lowest level
+	for (;;) {
+		SLNode *succ = succs[0];
+		for (int i = 0; i < level; i++) {
+			atomic_store_explicit(&node->next[i], succs[i], memory_order_relaxed);
+		}
+		if (atomic_compare_exchange_strong_explicit(&preds[0]->next[0], &succ, node,
+					memory_order_release, memory_order_relaxed)) {
+			break;
+		}
+		// another thread linked a node there first, maybe with the same key
+		if (search(list, key, preds, succs)) {
+			return DS_EXISTS;  // the node stays in the pool until sl_delete
+		}
+	}
+	atomic_fetch_add_explicit(&list->length, 1, memory_order_relaxed);
+	for (int i = 1; i < level; i++) {
+		for (;;) {
+			SLNode *succ = succs[i];
+			atomic_store_explicit(&node->next[i], succ, memory_order_relaxed);
+			if (atomic_compare_exchange_strong_explicit(&preds[i]->next[i], &succ, node,
+						memory_order_release, memory_order_relaxed)) {
+				break;
+			}
+			search(list, key, preds, succs);
+		}
+	}
+	raise_level(list, level);
+	return DS_OK;
+}
+
+int sl_get(SkipList *list, const void *key, void *out_value) {
+	void *value = sl_find(list, key);
+	if (!value) {
+		return DS_NOT_FOUND;
+	}
+	if (list->value_size > 0) {
+		memcpy(out_value, value, list->value_size);
+	}
+	return DS_OK;
+}
+
+void *sl_find(SkipList *list, const void *key) {
+	SLNode *node = list->head;
+	for (int i = atomic_load_explicit(&list->level, memory_order_relaxed) - 1; i >= 0; i--) {
+		SLNode *next = LOAD(node->next[i]);
+		for (; next; next = LOAD(node->next[i])) {
+			int c = list->compare(node_key(next), key);
+			if (c == 0) {
+				return node_key(next) + list->key_size;
+			}
+			if (c > 0) {
+				break;
+			}
+			node = next;
+		}
+	}
+	return NULL;
+}
+
+int sl_contains(SkipList *list, const void *key) {
+	return sl_find(list, key) != NULL;
+}
+
+int sl_remove(SkipList *list, const void *key) {
+	SLNode *preds[SL_MAX_LEVEL];
+	SLNode *succs[SL_MAX_LEVEL];
+	SLNode *node = search(list, key, preds, succs);
+	int level = list->level;
+	if (!node) {
+		return DS_NOT_FOUND;
+	}
+	for (int i = 0; i < node->level; i++) {
+		STORE(preds[i]->next[i], LOAD(node->next[i]));
+	}
+	while (level > 1 && !LOAD(list->head->next[level - 1])) {
+		level--;
+	}
+	list->level = level;
+	atomic_store_explicit(&node->next[0], list->pool.free[node->level - 1], memory_order_relaxed);
+	list->pool.free[node->level - 1] = node;
+	list->length--;
+	return DS_OK;
+}
+
+void *sl_seek(SkipList *list, const void *key) {
+	SLNode *node = list->head;
+	if (!key) {
+		return LOAD(node->next[0]);
+	}
+	for (int i = atomic_load_explicit(&list->level, memory_order_relaxed) - 1; i >= 0; i--) {
+		SLNode *next = LOAD(node->next[i]);
+		for (; next && list->compare(node_key(next), key) < 0; next = LOAD(node->next[i])) {
+			node = next;
+		}
+	}
+	return LOAD(node->next[0]);
+}
+
+int sl_next(SkipList *list, void **iterator, void **out_key, void **out_value) {
+	SLNode *node = *iterator;
+	if (!node) {
+		return 0;
+	}
+	*iterator = LOAD(node->next[0]);
+	if (out_key) {
+		*out_key = node_key(node);
+	}
+	if (out_value) {
+		*out_value = node_key(node) + list->key_size;
+	}
+	return 1;
+}
+
+void sl_clear(SkipList *list) {
+	pool_free(list);
+	for (int i = 0; i < SL_MAX_LEVEL; i++) {
+		list->head->next[i] = NULL;
+		list->pool.free[i] = NULL;
+	}
+	list->level = 1;
+	list->length = 0;
+}
+
+
+static unsigned long node_size(SkipList *list, int level) {
+	return ALIGN(sizeof(SLNode) + level * sizeof(SLNode *)) + ALIGN(list->key_size + list->value_size);
+}
+
+static unsigned char *node_key(SLNode *node) {
+	return (unsigned char *) node + ALIGN(sizeof(SLNode) + node->level * sizeof(SLNode *));
+}
+
+static SLNode *new_node(SkipList *list, int level, const void *key, const void *value) {
+	SLNode *node = pool_alloc(list, node_size(list, level));
+	if (!node) {
+		return NULL;
+	}
+	node->level = level;
+	memcpy(node_key(node), key, list->key_size);
+	if (list->value_size > 0) {
+		memcpy(node_key(node) + list->key_size, value, list->value_size);
+	}
+	return node;
+}
+
+// carve size bytes from the current block, or push a new block.
+// Safe to call from several threads at once.
+static void *pool_alloc(SkipList *list, unsigned long size) {
+	SLBlock *block = atomic_load_explicit(&list->pool.blocks, memory_order_acquire);
+	for (;;) {
+		SLBlock *grown;
+		unsigned long block_size = SL_BLOCK_SIZE > size ? SL_BLOCK_SIZE : size;
+		if (block) {
+			unsigned long used = atomic_fetch_add_explicit(&block->used, size, memory_order_relaxed);
+			if (used + size <= block->size) {
+				return block->data + used;
+			}
+		}
+		grown = ds_alloc_with(list->allocator, ALIGN(sizeof(SLBlock)) + block_size);
+		if (!grown) {
+			return NULL;
+		}
+		grown->size = block_size;
+		grown->data = (unsigned char *) grown + ALIGN(sizeof(SLBlock));
+		atomic_init(&grown->used, size);
+		grown->next = block;
+		if (atomic_compare_exchange_strong_explicit(&list->pool.blocks, &block, grown,
+					memory_order_acq_rel, memory_order_acquire)) {
+			return grown->data;
+		}
+		// another thread pushed a block, which is now in block
+		ds_free_with(list->allocator, grown, ALIGN(sizeof(SLBlock)) + block_size);
+	}
+}
+
+static void pool_free(SkipList *list) {
+	SLBlock *block = list->pool.blocks;
+	while (block) {
+		SLBlock *next = block->next;
+		ds_free_with(list->allocator, block, ALIGN(sizeof(SLBlock)) + block->size);
+		block = next;
+	}
+	list->pool.blocks = NULL;
+}
+
+// levels from 1 to SL_MAX_LEVEL with probability 1/4 of going up
+static int random_level(void) {
+	static _Thread_local uint64_t state = 0;
+	uint64_t r;
+	int level = 1;
+	if (state == 0) {
+		state = (uint64_t) (uintptr_t) &state ^ 0x9e3779b97f4a7c15ULL;
+	}
+	// xorshift64*
+	state ^= state >> 12;
+	state ^= state << 25;
+	state ^= state >> 27;
+	r = state * 0x2545f4914f6cdd1dULL;
+	for (; (r & 3) == 0 && level < SL_MAX_LEVEL; r >>= 2) {
+		level++;
+	}
+	return level;
+}
+
+// the node with the key, or NULL. Fills preds with the last node of each
+// level before the key and succs with the node that follows it.
+static SLNode *search(SkipList *list, const void *key, SLNode **preds, SLNode **succs) {
+	SLNode *node = list->head;
+	SLNode *found = NULL;
+	for (int i = SL_MAX_LEVEL - 1; i >= 0; i--) {
+		SLNode *next = LOAD(node->next[i]);
+		for (; next; next = LOAD(node->next[i])) {
+			int c = list->compare(node_key(next), key);
+			if (c >= 0) {
+				found = c == 0 ? next : NULL;
+				break;
+			}
+			node = next;
+		}
+		if (!next) {
+			found = NULL;
+		}
+		preds[i] = node;
+		succs[i] = next;
+	}
+	return found;
+}
+
+static void raise_level(SkipList *list, int level) {
+	int current = atomic_load_explicit(&list->level, memory_order_relaxed);
+	while (current < level &&
+			!atomic_compare_exchange_weak_explicit(&list->level, &current, level,
+				memory_order_relaxed, memory_order_relaxed)) {
+	}
+}
@@ -0,0 +1,82 @@
+#ifndef __SKIPLIST_H__
+#define __SKIPLIST_H__
+
+#include "alist.h"
+
+/*
+ * Skip List
+ * Ordered map of keys of key_size bytes to values of value_size bytes,
+ * ordered by compare. Each node is in the first of a stack of linked lists
+ * and, with probability 1/4 for each one, in the list above too, so that
+ * find, put and remove are O(log n) on average.
+ *
+ * A list with value_size 0 is an ordered set.
+ *
+ * The nodes come from a pool that takes blocks of SL_BLOCK_SIZE bytes from
+ * the allocator and carves them. Removed nodes are kept for later puts of
+ * the same level, and the memory is returned only by sl_delete.
+ *
+ * sl_find returns a pointer to the value of a key, or NULL. The pointer is
+ * valid until the key is removed.
+ *
+ * Iterate over a range of keys like this, in order. sl_seek returns the
+ * first node with a key greater or equal to the given one, or the first
+ * node if the key is NULL:
+ *
+ * void *it = sl_seek(list, &from);
+ * void *key, *value;
+ * while (sl_next(list, &it, &key, &value) && compare(key, &to) < 0) {
+ * }
+ *
+ * Concurrency
+ * sl_put_concurrent inserts a key without locks, with compare-and-swap on
+ * the links of each level, and can run in several threads at once along
+ * with sl_find, sl_get, sl_contains, sl_seek and sl_next. It never replaces
+ * the value of a key that is in the list, but returns DS_EXISTS. Readers
+ * see a new key as soon as it is linked in the lowest list. The other
+ * functions, sl_put included, must not run at the same time as any other
+ * function on the same list. The allocator must be thread safe.
+ */
+#define SL_MAX_LEVEL 32
+#define SL_BLOCK_SIZE (64UL * 1024UL)
+
+struct SLNode;
+struct SLBlock;
+
+typedef struct SLPool {
+	struct SLBlock *_Atomic blocks;
+	struct SLNode *free[SL_MAX_LEVEL];  // removed nodes by level - 1
+} SLPool;
+
+typedef struct SkipList {
+	struct SLNode *head;
+	_Atomic int level;
+	_Atomic unsigned long length;
+	unsigned long key_size;
+	unsigned long value_size;
+	DSCompare compare;
+	const DSAllocator *allocator;
+	SLPool pool;
+} SkipList;
+
+
+SkipList *sl_new(unsigned long key_size, unsigned long value_size, DSCompare compare);
+SkipList *sl_new_with(const DSAllocator *allocator, unsigned long key_size, unsigned long value_size, DSCompare compare);
+void sl_delete(SkipList *list);
+
+unsigned long sl_length(SkipList *list);
+
+int sl_put(SkipList *list, const void *key, const void *value);
+int sl_put_concurrent(SkipList *list, const void *key, const void *value);
+int sl_get(SkipList *list, const void *key, void *out_value);
+void *sl_find(SkipList *list, const void *key);
+int sl_contains(SkipList *list, const void *key);
+int sl_remove(SkipList *list, const void *key);
+
+void *sl_seek(SkipList *list, const void *key);
+int sl_next(SkipList *list, void **iterator, void **out_key, void **out_value);
+
+void sl_clear(SkipList *list);
+
+
+#endif  // __SKIPLIST_H__
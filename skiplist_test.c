@@ -0,0 +1,179 @@
+#include "skiplist.h"
+#include <assert.h>
+#include <pthread.h>
+#include <stdlib.h>
+#include <stdio.h>
+#include <string.h>
+
+#define THREADS 4
+#define PER_THREAD 20000
+
+int compare_ints(const int *a, const int *b) {
+	return (*a > *b) - (*a < *b);
+}
+
+typedef struct Writer {
+	SkipList *list;
+	int first;
+	int step;
+	int inserted;
+} Writer;
+
+void *write_keys(void *arg) {
+	Writer *writer = arg;
+	for (int i = 0; i < PER_THREAD; i++) {
+		// the writers overlap on half their keys
+		int key = writer->first + (i / 2) * writer->step * 2 + (i % 2) * writer->step;
+		int value = -key;
+		int rval = sl_put_concurrent(writer->list, &key, &value);
+		assert(rval == DS_OK || rval == DS_EXISTS);
+		writer->inserted += rval == DS_OK;
+		assert(sl_find(writer->list, &key) != NULL);
+	}
+	return NULL;
+}
+
+int main() {
+
+	{
+		SkipList *list = sl_new(sizeof(int), sizeof(int), (DSCompare) compare_ints);
+		int rval;
+		int value;
+		assert(list);
+		assert(sl_length(list) == 0);
+		assert(sl_seek(list, NULL) == NULL);
+
+		for (int i = 0; i < 1000; i++) {
+			int key = (i * 7919) % 1000;
+			int value = key * 2;
+			rval = sl_put(list, &key, &value);
+			assert(rval == DS_OK);
+		}
+		assert(sl_length(list) == 1000);
+
+		for (int i = 0; i < 1000; i++) {
+			rval = sl_get(list, &i, &value);
+			assert(rval == DS_OK);
+			assert(value == i * 2);
+		}
+		{
+			int key = 1000;
+			assert(sl_get(list, &key, &value) == DS_NOT_FOUND);
+			assert(!sl_contains(list, &key));
+		}
+
+		// replace
+		{
+			int key = 10;
+			value = 1;
+			assert(sl_put(list, &key, &value) == DS_OK);
+			assert(sl_length(list) == 1000);
+			assert(*(int *) sl_find(list, &key) == 1);
+		}
+
+		// in order
+		{
+			void *it = sl_seek(list, NULL);
+			void *key;
+			int expected = 0;
+			while (sl_next(list, &it, &key, NULL)) {
+				assert(*(int *) key == expected);
+				expected++;
+			}
+			assert(expected == 1000);
+		}
+
+		// remove the odd keys
+		for (int i = 1; i < 1000; i += 2) {
+			assert(sl_remove(list, &i) == DS_OK);
+			assert(sl_remove(list, &i) == DS_NOT_FOUND);
+		}
+		assert(sl_length(list) == 500);
+		for (int i = 0; i < 1000; i++) {
+			assert(sl_contains(list, &i) == (i % 2 == 0));
+		}
+
+		// range [101, 120)
+		{
+			int from = 101, to = 120;
+			void *it = sl_seek(list, &from);
+			void *key, *val;
+			int count = 0;
+			while (sl_next(list, &it, &key, &val) && compare_ints(key, &to) < 0) {
+				assert(*(int *) key == 102 + count * 2);
+				assert(*(int *) val == *(int *) key * 2);
+				count++;
+			}
+			assert(count == 9);
+			from = 999;
+			assert(sl_seek(list, &from) == NULL);
+		}
+
+		// the removed nodes are reused
+		for (int i = 1; i < 1000; i += 2) {
+			value = i;
+			assert(sl_put(list, &i, &value) == DS_OK);
+		}
+		assert(sl_length(list) == 1000);
+		assert(*(int *) sl_find(list, &(int) { 999 }) == 999);
+
+		sl_clear(list);
+		assert(sl_length(list) == 0);
+		assert(sl_seek(list, NULL) == NULL);
+		assert(sl_put(list, &(int) { 3 }, &(int) { 4 }) == DS_OK);
+		assert(sl_length(list) == 1);
+
+		sl_delete(list);
+	}
+
+	// a set of strings bigger than a block
+	{
+		typedef struct Big { char text[100000]; } Big;
+		Big *big = calloc(2, sizeof(Big));
+		SkipList *list = sl_new(sizeof(Big), 0, (DSCompare) strcmp);
+		strcpy(big[0].text, "b");
+		strcpy(big[1].text, "a");
+		assert(sl_put(list, &big[0], NULL) == DS_OK);
+		assert(sl_put(list, &big[1], NULL) == DS_OK);
+		void *it = sl_seek(list, NULL);
+		void *key;
+		assert(sl_next(list, &it, &key, NULL) && strcmp(key, "a") == 0);
+		assert(sl_next(list, &it, &key, NULL) && strcmp(key, "b") == 0);
+		assert(!sl_next(list, &it, &key, NULL));
+		sl_delete(list);
+		free(big);
+	}
+
+	// concurrent writers
+	{
+		SkipList *list = sl_new(sizeof(int), sizeof(int), (DSCompare) compare_ints);
+		pthread_t threads[THREADS];
+		Writer writers[THREADS];
+		int inserted = 0;
+		for (int t = 0; t < THREADS; t++) {
+			writers[t] = (Writer) { list, t, THREADS / 2, 0 };
+			assert(pthread_create(&threads[t], NULL, write_keys, &writers[t]) == 0);
+		}
+		for (int t = 0; t < THREADS; t++) {
+			pthread_join(threads[t], NULL);
+			inserted += writers[t].inserted;
+		}
+		assert(sl_length(list) == (unsigned long) inserted);
+
+		void *it = sl_seek(list, NULL);
+		void *key, *value;
+		int previous = -1;
+		unsigned long count = 0;
+		while (sl_next(list, &it, &key, &value)) {
+			assert(*(int *) key > previous);
+			assert(*(int *) value == -*(int *) key);
+			previous = *(int *) key;
+			count++;
+		}
+		assert(count == sl_length(list));
+		assert(sl_put_concurrent(list, &(int) { 0 }, &(int) { 0 }) == DS_EXISTS);
+		sl_delete(list);
+	}
+
+	return 0;
+}
@@ -0,0 +1,245 @@
+#include "soa.h"
+#include "search.h"
+#include <stdlib.h>
+#include <string.h>
+
+#define CELL(list, field, i) ((list)->columns[field] + (i) * (list)->fields[field].size)
+
+static void scatter(SoA *list, unsigned long index, const unsigned char *record);
+static void gather(SoA *list, unsigned long index, unsigned char *record);
+static unsigned long key_record_size(SoA *list, unsigned long field);
+static unsigned long widest_field(SoA *list);
+
+
+SoA *soa_new(const SoAField *fields, unsigned long field_count, unsigned long record_size, unsigned long max_length) {
+	return soa_new_with(NULL, fields, field_count, record_size, max_length);
+}
+
+SoA *soa_new_with(
+		const DSAllocator *allocator,
+		const SoAField *fields,
+		unsigned long field_count,
+		unsigned long record_size,
+		unsigned long max_length)
+{
+	SoA *list;
+	for (unsigned long f = 0; f < field_count; f++) {
+		if (fields[f].size == 0 || fields[f].offset + fields[f].size > record_size) {
+			return NULL;
+		}
+	}
+	list = ds_alloc_with(allocator, sizeof(SoA));
+	if (!list) {
+		return NULL;
+	}
+	memset(list, 0, sizeof(SoA));
+	list->allocator = allocator;
+	list->field_count = field_count;
+	list->record_size = record_size;
+	list->max_length = max_length;
+	list->fields = ds_alloc_with(allocator, field_count * sizeof(SoAField));
+	list->columns = ds_alloc_with(allocator, field_count * sizeof(unsigned char *));
+	if (!list->fields || !list->columns) {
+		soa_delete(list);
+		return NULL;
+	}
+	memcpy(list->fields, fields, field_count * sizeof(SoAField));
+	memset(list->columns, 0, field_count * sizeof(unsigned char *));
+	for (unsigned long f = 0; f < field_count; f++) {
+		list->columns[f] = ds_alloc_with(allocator, max_length * fields[f].size);
+		if (!list->columns[f]) {
+			soa_delete(list);
+			return NULL;
+		}
+	}
+	return list;
+}
+
+void soa_delete(SoA *list) {
+	if (list) {
+		if (list->columns) {
+			for (unsigned long f = 0; f < list->field_count; f++) {
+				if (list->columns[f]) {
+					ds_free_with(list->allocator, list->columns[f], list->max_length * list->fields[f].size);
+				}
+			}
+			ds_free_with(list->allocator, list->columns, list->field_count * sizeof(unsigned char *));
+		}
+		if (list->fields) {
+			ds_free_with(list->allocator, list->fields, list->field_count * sizeof(SoAField));
+		}
+		ds_free_with(list->allocator, list, sizeof(SoA));
+	}
+}
+
+int soa_push(SoA *list, const void *record) {
+	if (list->length == list->max_length) {
+		return DS_OVERFLOW;
+	}
+	scatter(list, list->length, record);
+	list->length++;
+	return DS_OK;
+}
+
+int soa_pop(SoA *list, void *out_record) {
+	if (list->length == 0) {
+		return DS_EMPTY;
+	}
+	list->length--;
+	gather(list, list->length, out_record);
+	return DS_OK;
+}
+
+int soa_set(SoA *list, unsigned long index, const void *record) {
+	if (index >= list->length) {
+		return DS_OUT_OF_BOUNDS;
+	}
+	scatter(list, index, record);
+	return DS_OK;
+}
+
+int soa_get(SoA *list, unsigned long index, void *out_record) {
+	if (index >= list->length) {
+		return DS_OUT_OF_BOUNDS;
+	}
+	gather(list, index, out_record);
+	return DS_OK;
+}
+
+int soa_set_field(SoA *list, unsigned long index, unsigned long field, const void *data) {
+	if (index >= list->length || field >= list->field_count) {
+		return DS_OUT_OF_BOUNDS;
+	}
+	memcpy(CELL(list, field, index), data, list->fields[field].size);
+	return DS_OK;
+}
+
+int soa_get_field(SoA *list, unsigned long index, unsigned long field, void *out_data) {
+	if (index >= list->length || field >= list->field_count) {
+		return DS_OUT_OF_BOUNDS;
+	}
+	memcpy(out_data, CELL(list, field, index), list->fields[field].size);
+	return DS_OK;
+}
+
+void *soa_column(SoA *list, unsigned long field) {
+	return field < list->field_count ? list->columns[field] : NULL;
+}
+
+void soa_clear(SoA *list) {
+	list->length = 0;
+}
+
+int soa_find(SoA *list, unsigned long field, const void *data, unsigned long *out_index) {
+	unsigned long index;
+	if (field >= list->field_count) {
+		return DS_OUT_OF_BOUNDS;
+	}
+	index = ds_find(list->columns[field], list->length, list->fields[field].size, data);
+	if (index == list->length) {
+		return DS_NOT_FOUND;
+	}
+	*out_index = index;
+	return DS_OK;
+}
+
+unsigned long soa_count(SoA *list, unsigned long field, const void *data) {
+	if (field >= list->field_count) {
+		return 0;
+	}
+	return ds_count(list->columns[field], list->length, list->fields[field].size, data);
+}
+
+int soa_min_max(SoA *list, unsigned long field, void *out_min, void *out_max) {
+	if (field >= list->field_count) {
+		return DS_OUT_OF_BOUNDS;
+	}
+	return ds_min_max(list->columns[field], list->length, list->fields[field].size, out_min, out_max);
+}
+
+// Sorts records of the key followed by its index with compare, which reads
+// only the key at the start of each record.
+int soa_argsort(SoA *list, unsigned long field, DSCompare compare, unsigned long *permutation) {
+	unsigned long size;
+	unsigned long key_size;
+	unsigned char *keys;
+	if (field >= list->field_count) {
+		return DS_OUT_OF_BOUNDS;
+	}
+	key_size = list->fields[field].size;
+	size = key_record_size(list, field);
+	keys = ds_alloc_with(list->allocator, (list->length + 1) * size);
+	if (!keys) {
+		return DS_MALLOC_ERROR;
+	}
+	for (unsigned long i = 0; i < list->length; i++) {
+		memcpy(keys + i * size, CELL(list, field, i), key_size);
+		memcpy(keys + i * size + size - sizeof(unsigned long), &i, sizeof(unsigned long));
+	}
+	ds_quick_sort(keys, list->length, size, keys + list->length * size, compare);
+	for (unsigned long i = 0; i < list->length; i++) {
+		memcpy(&permutation[i], keys + i * size + size - sizeof(unsigned long), sizeof(unsigned long));
+	}
+	ds_free_with(list->allocator, keys, (list->length + 1) * size);
+	return DS_OK;
+}
+
+// Gathers each column into a buffer in the new order and copies it back.
+int soa_permute(SoA *list, const unsigned long *permutation) {
+	unsigned long bytes = list->length * widest_field(list);
+	unsigned char *buffer = ds_alloc_with(list->allocator, bytes ? bytes : 1);
+	if (!buffer) {
+		return DS_MALLOC_ERROR;
+	}
+	for (unsigned long f = 0; f < list->field_count; f++) {
+		unsigned long size = list->fields[f].size;
+		for (unsigned long i = 0; i < list->length; i++) {
+			memcpy(buffer + i * size, CELL(list, f, permutation[i]), size);
+		}
+		memcpy(list->columns[f], buffer, list->length * size);
+	}
+	ds_free_with(list->allocator, buffer, bytes ? bytes : 1);
+	return DS_OK;
+}
+
+int soa_sort(SoA *list, unsigned long field, DSCompare compare) {
+	int rval;
+	unsigned long *permutation = ds_alloc_with(list->allocator, (list->length + 1) * sizeof(unsigned long));
+	if (!permutation) {
+		return DS_MALLOC_ERROR;
+	}
+	rval = soa_argsort(list, field, compare, permutation);
+	if (rval == DS_OK) {
+		rval = soa_permute(list, permutation);
+	}
+	ds_free_with(list->allocator, permutation, (list->length + 1) * sizeof(unsigned long));
+	return rval;
+}
+
+
+static void scatter(SoA *list, unsigned long index, const unsigned char *record) {
+	for (unsigned long f = 0; f < list->field_count; f++) {
+		memcpy(CELL(list, f, index), record + list->fields[f].offset, list->fields[f].size);
+	}
+}
+
+static void gather(SoA *list, unsigned long index, unsigned char *record) {
+	memset(record, 0, list->record_size);
+	for (unsigned long f = 0; f < list->field_count; f++) {
+		memcpy(record + list->fields[f].offset, CELL(list, f, index), list->fields[f].size);
+	}
+}
+
+// size of a key of the field followed by an index, aligned for both
+static unsigned long key_record_size(SoA *list, unsigned long field) {
+	unsigned long align = sizeof(unsigned long);
+	return (list->fields[field].size + align - 1) / align * align + sizeof(unsigned long);
+}
+
+static unsigned long widest_field(SoA *list) {
+	unsigned long widest = 0;
+	for (unsigned long f = 0; f < list->field_count; f++) {
+		widest = list->fields[f].size > widest ? list->fields[f].size : widest;
+	}
+	return widest;
+}
@@ -0,0 +1,85 @@
+#ifndef __SOA_H__
+#define __SOA_H__
+
+#include "alist.h"
+
+/*
+ * Structure of Arrays
+ * List of up to max_length records of record_size bytes, like AList, but
+ * each field of the records is stored in a column of its own, so that a
+ * scan or a sort on a field reads that column only. The fields are given
+ * by an array of their offsets and sizes in the record, which may leave
+ * out padding and need not be in order:
+ *
+ * typedef struct Order { long id; int price; char side; } Order;
+ * SoAField fields[] = {
+ *     { offsetof(Order, id), sizeof(long) },
+ *     { offsetof(Order, price), sizeof(int) },
+ *     { offsetof(Order, side), sizeof(char) },
+ * };
+ * SoA *orders = soa_new(fields, 3, sizeof(Order), 1000);
+ *
+ * Push, pop, get and set move whole records, scattering them to the
+ * columns and gathering them back. The bytes of a record that are in no
+ * field read back as zero. soa_get_field and soa_set_field move a single
+ * field, and soa_column returns the array of a column, of length elements,
+ * which is valid until the list is deleted.
+ *
+ * soa_find, soa_count and soa_min_max scan a column with the kernels of
+ * search.h, under the same rules.
+ *
+ * soa_argsort writes to permutation the indices of the records in the
+ * order of a field by compare, reading that column only, and soa_permute
+ * reorders every column so that the record at i is the one that was at
+ * permutation[i]. soa_sort does both. The sort is not stable.
+ *
+ * soa_new_with takes all the memory of the list from an allocator. It
+ * returns NULL if a field does not fit in the record.
+ */
+typedef struct SoAField {
+	unsigned long offset;
+	unsigned long size;
+} SoAField;
+
+typedef struct SoA {
+	unsigned char **columns;
+	SoAField *fields;
+	unsigned long field_count;
+	unsigned long record_size;
+	unsigned long max_length;
+	unsigned long length;
+	const DSAllocator *allocator;
+} SoA;
+
+
+SoA *soa_new(const SoAField *fields, unsigned long field_count, unsigned long record_size, unsigned long max_length);
+SoA *soa_new_with(
+		const DSAllocator *allocator,
+		const SoAField *fields,
+		unsigned long field_count,
+		unsigned long record_size,
+		unsigned long max_length);
+void soa_delete(SoA *list);
+
+int soa_push(SoA *list, const void *record);
+int soa_pop(SoA *list, void *out_record);
+
+int soa_set(SoA *list, unsigned long index, const void *record);
+int soa_get(SoA *list, unsigned long index, void *out_record);
+
+int soa_set_field(SoA *list, unsigned long index, unsigned long field, const void *data);
+int soa_get_field(SoA *list, unsigned long index, unsigned long field, void *out_data);
+void *soa_column(SoA *list, unsigned long field);
+
+void soa_clear(SoA *list);
+
+int soa_find(SoA *list, unsigned long field, const void *data, unsigned long *out_index);
+unsigned long soa_count(SoA *list, unsigned long field, const void *data);
+int soa_min_max(SoA *list, unsigned long field, void *out_min, void *out_max);
+
+int soa_argsort(SoA *list, unsigned long field, DSCompare compare, unsigned long *permutation);
+int soa_permute(SoA *list, const unsigned long *permutation);
+int soa_sort(SoA *list, unsigned long field, DSCompare compare);
+
+
+#endif  // __SOA_H__
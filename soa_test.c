@@ -0,0 +1,180 @@
+#include "soa.h"
+#include <assert.h>
+#include <stddef.h>
+#include <stdlib.h>
+#include <string.h>
+
+#define LENGTH 1000
+
+typedef struct Order {
+	long id;
+	int price;
+	char side;
+} Order;
+
+static const SoAField fields[] = {
+	{ offsetof(Order, id), sizeof(long) },
+	{ offsetof(Order, price), sizeof(int) },
+	{ offsetof(Order, side), sizeof(char) },
+};
+
+enum { ID, PRICE, SIDE };
+
+int compare_int(const void *a, const void *b) {
+	int x = *(const int *) a, y = *(const int *) b;
+	return (x > y) - (x < y);
+}
+
+int compare_long(const void *a, const void *b) {
+	long x = *(const long *) a, y = *(const long *) b;
+	return (x > y) - (x < y);
+}
+
+int compare_char(const void *a, const void *b) {
+	return *(const char *) a - *(const char *) b;
+}
+
+Order order(long id) {
+	Order o;
+	memset(&o, 0, sizeof(Order));
+	o.id = id;
+	o.price = (int) (id * 7919 % 1000);
+	o.side = id % 2 ? 'b' : 's';
+	return o;
+}
+
+int main() {
+	// records
+	{
+		SoA *list = soa_new(fields, 3, sizeof(Order), LENGTH);
+		Order o;
+		assert(list);
+		assert(soa_pop(list, &o) == DS_EMPTY);
+		for (long i = 0; i < LENGTH; i++) {
+			o = order(i);
+			assert(soa_push(list, &o) == DS_OK);
+		}
+		assert(soa_push(list, &o) == DS_OVERFLOW);
+		assert(list->length == LENGTH);
+
+		for (long i = 0; i < LENGTH; i++) {
+			Order expected = order(i);
+			assert(soa_get(list, (unsigned long) i, &o) == DS_OK);
+			assert(memcmp(&o, &expected, sizeof(Order)) == 0);
+		}
+		assert(soa_get(list, LENGTH, &o) == DS_OUT_OF_BOUNDS);
+
+		o = order(-1);
+		assert(soa_set(list, 10, &o) == DS_OK);
+		assert(soa_get(list, 10, &o) == DS_OK);
+		assert(o.id == -1 && o.side == 'b');
+		assert(soa_set(list, LENGTH, &o) == DS_OUT_OF_BOUNDS);
+
+		int price = 12345;
+		assert(soa_set_field(list, 20, PRICE, &price) == DS_OK);
+		price = 0;
+		assert(soa_get_field(list, 20, PRICE, &price) == DS_OK);
+		assert(price == 12345);
+		assert(((int *) soa_column(list, PRICE))[20] == 12345);
+		assert(soa_get(list, 20, &o) == DS_OK);
+		assert(o.id == 20 && o.price == 12345);
+		assert(soa_get_field(list, 20, 3, &price) == DS_OUT_OF_BOUNDS);
+		assert(soa_column(list, 3) == NULL);
+
+		assert(soa_pop(list, &o) == DS_OK);
+		assert(o.id == LENGTH - 1);
+		assert(list->length == LENGTH - 1);
+		soa_clear(list);
+		assert(list->length == 0);
+		soa_delete(list);
+	}
+
+	// schemas that do not fit the record
+	{
+		SoAField bad[] = { { 4, sizeof(long) } };
+		SoAField empty[] = { { 0, 0 } };
+		assert(soa_new(bad, 1, sizeof(long), 10) == NULL);
+		assert(soa_new(empty, 1, sizeof(long), 10) == NULL);
+	}
+
+	// scans
+	{
+		SoA *list = soa_new(fields, 3, sizeof(Order), LENGTH);
+		unsigned long index;
+		int min, max;
+		for (long i = 0; i < LENGTH; i++) {
+			Order o = order(i);
+			soa_push(list, &o);
+		}
+		assert(soa_find(list, ID, &(long) { 500 }, &index) == DS_OK);
+		assert(index == 500);
+		assert(soa_find(list, ID, &(long) { LENGTH }, &index) == DS_NOT_FOUND);
+		assert(soa_find(list, 3, &(long) { 0 }, &index) == DS_OUT_OF_BOUNDS);
+		assert(soa_count(list, SIDE, &(char) { 'b' }) == LENGTH / 2);
+		assert(soa_count(list, PRICE, &(int) { 0 }) == 1);
+		assert(soa_min_max(list, PRICE, &min, &max) == DS_OK);
+		assert(min == 0 && max == 999);
+		soa_delete(list);
+	}
+
+	// sorts
+	{
+		SoA *list = soa_new(fields, 3, sizeof(Order), LENGTH);
+		unsigned long *permutation = malloc(LENGTH * sizeof(unsigned long));
+		Order o;
+		for (long i = 0; i < LENGTH; i++) {
+			o = order(i);
+			soa_push(list, &o);
+		}
+
+		// argsort leaves the columns as they are
+		assert(soa_argsort(list, PRICE, compare_int, permutation) == DS_OK);
+		for (unsigned long i = 0; i < LENGTH; i++) {
+			assert(((int *) soa_column(list, PRICE))[permutation[i]] == (int) i);
+			assert(((long *) soa_column(list, ID))[i] == (long) i);
+		}
+
+		assert(soa_permute(list, permutation) == DS_OK);
+		for (unsigned long i = 0; i < LENGTH; i++) {
+			Order expected = order((long) permutation[i]);
+			soa_get(list, i, &o);
+			assert(memcmp(&o, &expected, sizeof(Order)) == 0);
+			assert(o.price == (int) i);
+		}
+
+		assert(soa_sort(list, SIDE, compare_char) == DS_OK);
+		for (unsigned long i = 0; i < LENGTH; i++) {
+			soa_get(list, i, &o);
+			assert(o.side == (i < LENGTH / 2 ? 'b' : 's'));
+			assert(o.price == (int) (o.id * 7919 % 1000));
+		}
+		assert(soa_sort(list, 3, compare_char) == DS_OUT_OF_BOUNDS);
+
+		soa_clear(list);
+		assert(soa_sort(list, PRICE, compare_int) == DS_OK);
+
+		free(permutation);
+		soa_delete(list);
+	}
+
+	// all the memory from an arena
+	{
+		DSArena *arena = ds_arena_new(1 << 16);
+		SoA *list = soa_new_with(ds_arena_allocator(arena), fields, 3, sizeof(Order), 100);
+		Order o;
+		assert(list);
+		for (long i = 0; i < 100; i++) {
+			o = order(99 - i);
+			soa_push(list, &o);
+		}
+		assert(soa_sort(list, ID, compare_long) == DS_OK);
+		for (unsigned long i = 0; i < 100; i++) {
+			soa_get(list, i, &o);
+			assert(o.id == (long) i);
+		}
+		soa_delete(list);
+		ds_arena_delete(arena);
+	}
+
+	return 0;
+}
@@ -17,10 +17,58 @@ int compare_coords(const Coords *a, const Coords *b) {
 	return (a->x + a->y + a->z) - (b->x + b->y + b->z);
 }
 
+int compare_x(const Coords *a, const Coords *b) {
+	return a->x - b->x;
+}
+
 int compare_ints(const int *a, const int *b) {
 	return *a - *b;
 }
 
+int is_multiple(const int *n, const int *of) {
+	return *n % *of == 0;
+}
+
+// record larger than ALIST_INDIRECT_SORT_SIZE, sorted by key
+typedef struct Big {
+	int key;
+	int serial;
+	char payload[504];
+} Big;
+
+int compare_bigs(const Big *a, const Big *b) {
+	return a->key - b->key;
+}
+
+long big_key(const Big *big) {
+	return big->key;
+}
+
+// allocator that counts the bytes in use
+typedef struct Tracker {
+	unsigned long in_use;
+	unsigned long allocations;
+} Tracker;
+
+void *tracker_alloc(void *context, unsigned long size) {
+	Tracker *tracker = context;
+	tracker->in_use += size;
+	tracker->allocations += 1;
+	return malloc(size);
+}
+
+void *tracker_realloc(void *context, void *ptr, unsigned long old_size, unsigned long size) {
+	Tracker *tracker = context;
+	tracker->in_use += size - old_size;
+	return realloc(ptr, size);
+}
+
+void tracker_free(void *context, void *ptr, unsigned long size) {
+	Tracker *tracker = context;
+	tracker->in_use -= size;
+	free(ptr);
+}
+
 int main() {
 	AList *list;
 	unsigned long max = 10;
@@ -201,6 +249,7 @@ int main() {
 			assert(rval == DS_OVERFLOW);
 		}
 		assert((int)*tmp == tmpi);
+		alist_delete(list);
 	}
 
 	// sort
@@ -251,8 +300,177 @@ int main() {
 					p = n;
 				}
 			}
+			alist_delete(list);
+		}
+	}
+
+	// sort and selection of many sizes and patterns
+	{
+		const unsigned long max_size = 2000;
+		AList *list = alist_new(max_size, sizeof(int));
+		AList *copy = alist_new(max_size, sizeof(int));
+		int *sorted = (int *) copy->array;
+		for (int pattern = 0; pattern < 5; pattern++) {
+			for (unsigned long length = 0; length < max_size; length = length * 3 / 2 + 1) {
+				alist_clear(list);
+				for (unsigned long i = 0; i < length; i++) {
+					int n = pattern == 0 ? rand() :
+							pattern == 1 ? (int) i :
+							pattern == 2 ? (int) (length - i) :
+							pattern == 3 ? rand() % 3 :
+							(int) (i % 2 ? i : length - i);  // organ pipe
+					alist_push(list, &n);
+				}
+				memcpy(sorted, list->array, length * sizeof(int));
+				copy->length = length;
+				assert(alist_sort(copy, (DSCompare) compare_ints) == DS_OK);
+				for (unsigned long i = 1; i < length; i++) {
+					assert(sorted[i-1] <= sorted[i]);
+				}
+
+				unsigned long nth = length / 3;
+				if (length == 0) {
+					assert(alist_nth_element(list, nth, (DSCompare) compare_ints) == DS_OUT_OF_BOUNDS);
+					continue;
+				}
+				assert(alist_nth_element(list, nth, (DSCompare) compare_ints) == DS_OK);
+				int *ints = (int *) list->array;
+				assert(ints[nth] == sorted[nth]);
+				for (unsigned long i = 0; i < length; i++) {
+					assert(i < nth ? ints[i] <= ints[nth] : ints[i] >= ints[nth]);
+				}
+
+				unsigned long k = length / 10 + 1;
+				assert(alist_partial_sort(list, k, (DSCompare) compare_ints) == DS_OK);
+				for (unsigned long i = 0; i < k; i++) {
+					assert(ints[i] == sorted[i]);
+				}
+			}
+		}
+		alist_delete(list);
+		alist_delete(copy);
+	}
+
+	// remove_if, unique, partition
+	{
+		AList *list = alist_new(1000, sizeof(int));
+		int *ints = (int *) list->array;
+		int three = 3;
+		for (int i = 0; i < 1000; i++) {
+			alist_push(list, &i);
+		}
+		assert(alist_remove_if(list, (DSPredicate) is_multiple, &three) == DS_OK);
+		assert(list->length == 666);
+		for (unsigned long i = 0; i < list->length; i++) {
+			assert(ints[i] == (int) (i / 2 * 3 + i % 2 + 1));
+		}
+		int one = 1;
+		assert(alist_remove_if(list, (DSPredicate) is_multiple, &one) == DS_OK);
+		assert(list->length == 0);
+		assert(alist_remove_if(list, (DSPredicate) is_multiple, &one) == DS_OK);
+
+		for (int i = 0; i < 1000; i++) {
+			int n = i / 7 + (i % 7 == 6);  // runs of 6 equal records and a step
+			alist_push(list, &n);
+		}
+		assert(alist_unique(list, (DSCompare) compare_ints) == DS_OK);
+		for (unsigned long i = 1; i < list->length; i++) {
+			assert(ints[i-1] < ints[i]);
+		}
+		assert(ints[0] == 0);
+		assert(ints[list->length - 1] == 142);
+		alist_clear(list);
+		assert(alist_unique(list, (DSCompare) compare_ints) == DS_OK);
+		assert(list->length == 0);
+
+		unsigned long index;
+		int count = 0;
+		for (int i = 0; i < 1000; i++) {
+			int n = rand() % 100;
+			count += n % 3 == 0;
+			alist_push(list, &n);
+		}
+		assert(alist_partition(list, (DSPredicate) is_multiple, &three, &index) == DS_OK);
+		assert(index == (unsigned long) count);
+		assert(list->length == 1000);
+		for (unsigned long i = 0; i < list->length; i++) {
+			assert((ints[i] % 3 == 0) == (i < index));
+		}
+		alist_delete(list);
+	}
+
+	// argsort, permutations
+	{
+		const unsigned long length = 1000;
+		AList *bigs = alist_new(length, sizeof(Big));
+		unsigned long *indices = malloc(length * sizeof(unsigned long));
+		unsigned long *key_indices = malloc(length * sizeof(unsigned long));
+		uint32_t *indices32 = malloc(length * sizeof(uint32_t));
+		Big big;
+		memset(&big, 0, sizeof(Big));
+		for (unsigned long i = 0; i < length; i++) {
+			big.key = rand() % 100;
+			big.serial = (int) i;
+			big.payload[503] = (char) i;
+			alist_push(bigs, &big);
+		}
+
+		assert(alist_argsort(bigs, (DSCompare) compare_bigs, indices) == DS_OK);
+		assert(alist_argsort32(bigs, (DSCompare) compare_bigs, indices32) == DS_OK);
+		assert(alist_argsort_key(bigs, (DSKey) big_key, key_indices) == DS_OK);
+		for (unsigned long i = 0; i < length; i++) {
+			// stable, so all three agree
+			assert(indices[i] == indices32[i]);
+			assert(indices[i] == key_indices[i]);
+		}
+		for (unsigned long i = 1; i < length; i++) {
+			Big *a = (Big *) bigs->array + indices[i-1];
+			Big *b = (Big *) bigs->array + indices[i];
+			assert(a->key < b->key || (a->key == b->key && a->serial < b->serial));
+		}
+		// the list is left as it is
+		for (unsigned long i = 0; i < length; i++) {
+			assert(((Big *) bigs->array)[i].serial == (int) i);
+		}
+
+		assert(alist_apply_permutation32(bigs, indices32) == DS_OK);
+		for (unsigned long i = 0; i < length; i++) {
+			Big *b = (Big *) bigs->array + i;
+			assert(b->serial == (int) indices[i]);
+			assert(b->payload[503] == (char) indices[i]);
+		}
 
+		// sorted indirectly, as the records are large
+		for (unsigned long i = 0; i < length; i++) {
+			((Big *) bigs->array)[i].key = rand() % 100;
+		}
+		assert(alist_sort(bigs, (DSCompare) compare_bigs) == DS_OK);
+		for (unsigned long i = 1; i < length; i++) {
+			assert(((Big *) bigs->array)[i-1].key <= ((Big *) bigs->array)[i].key);
+		}
+
+		// a permutation of a single cycle, and the identity
+		AList *ints = alist_new(10, sizeof(int));
+		unsigned long rotate[10], identity[10];
+		for (int i = 0; i < 10; i++) {
+			alist_push(ints, &i);
+			rotate[i] = (unsigned long) (i + 3) % 10;
+			identity[i] = (unsigned long) i;
+		}
+		assert(alist_apply_permutation(ints, rotate) == DS_OK);
+		assert(alist_apply_permutation(ints, identity) == DS_OK);
+		for (int i = 0; i < 10; i++) {
+			assert(((int *) ints->array)[i] == (i + 3) % 10);
 		}
+		alist_clear(ints);
+		assert(alist_argsort(ints, (DSCompare) compare_ints, indices) == DS_OK);
+		assert(alist_apply_permutation(ints, indices) == DS_OK);
+
+		alist_delete(ints);
+		alist_delete(bigs);
+		free(indices);
+		free(key_indices);
+		free(indices32);
 	}
 
 	// add, remove
@@ -333,6 +551,7 @@ int main() {
 			alist_get(list, 4, &n);
 			assert(n == 3);
 		}
+		alist_delete(list);
 	}
 
 	{
@@ -360,6 +579,273 @@ int main() {
 			assert(rval == DS_OK);
 			assert(n == 8);
 		}
+		alist_delete(list);
+	}
+
+	// sorted set operations
+	{
+		srand(time(NULL));
+		const int values = 50;
+		for (int it = 0; it < 200; it++) {
+			unsigned long a_length = rand() % 300;
+			unsigned long b_length = it % 2 ? rand() % 10 : rand() % 300;
+			AList *a = alist_new(a_length, sizeof(int));
+			AList *b = alist_new(b_length, sizeof(int));
+			AList *dst = alist_new(a_length + b_length, sizeof(int));
+			int a_count[50] = { 0 };
+			int b_count[50] = { 0 };
+			for (unsigned long i = 0; i < a_length; i++) {
+				int n = rand() % values;
+				alist_push(a, &n);
+				a_count[n]++;
+			}
+			for (unsigned long i = 0; i < b_length; i++) {
+				int n = rand() % values;
+				alist_push(b, &n);
+				b_count[n]++;
+			}
+			alist_sort(a, (DSCompare) compare_ints);
+			alist_sort(b, (DSCompare) compare_ints);
+
+			for (int op = 0; op < 3; op++) {
+				int count[50] = { 0 };
+				int rval;
+				if (op == 0) {
+					rval = alist_union_sorted(dst, a, b, (DSCompare) compare_ints);
+				}
+				else if (op == 1) {
+					rval = alist_intersection_sorted(dst, b, a, (DSCompare) compare_ints);
+				}
+				else {
+					rval = alist_difference_sorted(dst, a, b, (DSCompare) compare_ints);
+				}
+				assert(rval == DS_OK);
+				int *result = (int *) dst->array;
+				for (unsigned long i = 0; i < dst->length; i++) {
+					assert(i == 0 || result[i - 1] <= result[i]);
+					count[result[i]]++;
+				}
+				for (int n = 0; n < values; n++) {
+					int ca = a_count[n];
+					int cb = b_count[n];
+					if (op == 0) {
+						assert(count[n] == (ca > cb ? ca : cb));
+					}
+					else if (op == 1) {
+						assert(count[n] == (ca < cb ? ca : cb));
+					}
+					else {
+						assert(count[n] == (ca > cb ? ca - cb : 0));
+					}
+				}
+			}
+			alist_delete(a);
+			alist_delete(b);
+			alist_delete(dst);
+		}
+	}
+	{
+		AList *a = alist_new(10, sizeof(int));
+		AList *b = alist_new(10, sizeof(int));
+		AList *dst = alist_new(5, sizeof(int));
+		for (int i = 0; i < 10; i++) {
+			alist_push(a, &i);
+			int n = i + 10;
+			alist_push(b, &n);
+		}
+		int rval = alist_union_sorted(dst, a, b, (DSCompare) compare_ints);
+		assert(rval == DS_OVERFLOW);
+		assert(dst->length == 5);
+		rval = alist_intersection_sorted(dst, a, b, (DSCompare) compare_ints);
+		assert(rval == DS_OK);
+		assert(dst->length == 0);
+		alist_delete(a);
+		alist_delete(b);
+		alist_delete(dst);
+	}
+	// k-way merges, of records sorted by x, with the list in y and the
+	// index in z, to check the order of equal records
+	{
+		AList *lists[20];
+		AList *dst = alist_new(20 * 100, sizeof(Coords));
+		for (unsigned long k = 0; k <= 20; k++) {
+			unsigned long total = 0;
+			int count[50] = { 0 };
+			for (unsigned long l = 0; l < k; l++) {
+				unsigned long length = (unsigned long) rand() % 100;
+				lists[l] = alist_new(100, sizeof(Coords));
+				for (unsigned long i = 0; i < length; i++) {
+					Coords coords = { rand() % 50, 0, 0 };
+					alist_push(lists[l], &coords);
+					count[coords.x]++;
+				}
+				alist_sort(lists[l], (DSCompare) compare_x);
+				for (unsigned long i = 0; i < length; i++) {
+					((Coords *) lists[l]->array)[i].y = (int) l;
+					((Coords *) lists[l]->array)[i].z = (int) i;
+				}
+				total += length;
+			}
+
+			assert(alist_merge_k(dst, lists, k, (DSCompare) compare_x) == DS_OK);
+			assert(dst->length == total);
+			Coords *result = (Coords *) dst->array;
+			for (unsigned long i = 1; i < dst->length; i++) {
+				Coords *p = &result[i-1], *c = &result[i];
+				assert(p->x < c->x || (p->x == c->x && (p->y < c->y || (p->y == c->y && p->z < c->z))));
+			}
+
+			assert(alist_merge_k_unique(dst, lists, k, (DSCompare) compare_x) == DS_OK);
+			unsigned long distinct = 0;
+			for (int n = 0; n < 50; n++) {
+				distinct += count[n] > 0;
+			}
+			assert(dst->length == distinct);
+			for (unsigned long i = 1; i < dst->length; i++) {
+				assert(result[i-1].x < result[i].x);
+			}
+
+			if (total > 1) {
+				dst->max_length = total - 1;
+				assert(alist_merge_k(dst, lists, k, (DSCompare) compare_x) == DS_OVERFLOW);
+				assert(dst->length == total - 1);
+				dst->max_length = 20 * 100;
+			}
+			for (unsigned long l = 0; l < k; l++) {
+				alist_delete(lists[l]);
+			}
+		}
+		alist_delete(dst);
+	}
+	{
+		DSArena *arena = ds_arena_new(100);
+		char *a = ds_arena_alloc(arena, 10);
+		char *b = ds_arena_alloc(arena, 10);
+		assert(a != NULL && b != NULL);
+		assert(b - a >= 10);
+		assert(((unsigned long) b) % 16 == 0);
+
+		// bigger than a block
+		char *c = ds_arena_alloc(arena, 1000);
+		assert(c != NULL);
+		memset(c, 0, 1000);
+
+		AList *ints = alist_new_in(arena, 10, sizeof(int));
+		assert(ints != NULL);
+		assert(ints->allocator == ds_arena_allocator(arena));
+		for (int i = 0; i < 10; i++) {
+			alist_push(ints, &i);
+		}
+		int n;
+		assert(alist_get(ints, 9, &n) == DS_OK);
+		assert(n == 9);
+		alist_delete(ints);
+
+		ds_arena_reset(arena);
+		char *d = ds_arena_alloc(arena, 10);
+		assert(d == a);
+		ds_arena_delete(arena);
+	}
+	{
+		Tracker tracker = { 0, 0 };
+		DSAllocator allocator = { tracker_alloc, tracker_realloc, tracker_free, &tracker };
+		AList *ints = alist_new_with(&allocator, 100, sizeof(int));
+		assert(ints != NULL);
+		assert(tracker.allocations == 2);
+		assert(tracker.in_use == sizeof(AList) + 101 * sizeof(int));
+		alist_delete(ints);
+		assert(tracker.in_use == 0);
+
+		// an arena on top of another allocator
+		DSArena *arena = ds_arena_new_with(&allocator, 256);
+		const DSAllocator *from_arena = ds_arena_allocator(arena);
+		int *a = ds_alloc_with(from_arena, 8 * sizeof(int));
+		for (int i = 0; i < 8; i++) {
+			a[i] = i;
+		}
+		// the last allocation grows in place
+		int *b = ds_realloc_with(from_arena, a, 8 * sizeof(int), 16 * sizeof(int));
+		assert(b == a);
+		int *c = ds_alloc_with(from_arena, 4);
+		int *d = ds_realloc_with(from_arena, b, 16 * sizeof(int), 32 * sizeof(int));
+		assert(d != b && d != c);
+		assert(d[7] == 7);
+		ds_free_with(from_arena, d, 32 * sizeof(int));
+		assert(tracker.in_use > 0);
+
+		// the scratch of the sorts of a list in the arena comes from malloc
+		AList *bigs = alist_new_in(arena, 100, sizeof(Big));
+		for (int i = 0; i < 100; i++) {
+			Big big = { .key = 99 - i, .serial = i };
+			assert(alist_push(bigs, &big) == DS_OK);
+		}
+		unsigned long in_use = tracker.in_use;
+		assert(alist_sort(bigs, (DSCompare) compare_bigs) == DS_OK);
+		assert(tracker.in_use == in_use);
+		assert(((Big *) bigs->array)[0].serial == 99);
+#ifdef DS_STATS
+		assert(alist_stats(bigs)->ops == 101);
+#endif
+		ds_arena_delete(arena);
+		assert(tracker.in_use == 0);
+
+		int *e = ds_realloc_with(&ds_malloc_allocator, NULL, 0, 4 * sizeof(int));
+		assert(e != NULL);
+		ds_free_with(&ds_malloc_allocator, e, 4 * sizeof(int));
+	}
+
+	{
+		DSStats stats, total;
+		ds_stats_reset(&stats);
+		ds_stats_cost(&stats, 0);
+		ds_stats_cost(&stats, 1);
+		ds_stats_cost(&stats, 5);
+		ds_stats_cost(&stats, 7);
+		ds_stats_cost(&stats, (unsigned long) -1);
+		assert(stats.histogram[0] == 1);
+		assert(stats.histogram[1] == 1);
+		assert(stats.histogram[3] == 2);
+		assert(stats.histogram[DS_STATS_BUCKETS - 1] == 1);
+		assert(stats.max_cost == (unsigned long) -1);
+		ds_stats_reset(&total);
+		total.ops = 3;
+		ds_stats_merge(&total, &stats);
+		ds_stats_merge(&total, &stats);
+		assert(total.ops == 3);
+		assert(total.histogram[3] == 4);
+
+		char buffer[1024];
+		FILE *out = fmemopen(buffer, sizeof(buffer), "w");
+		ds_stats_dump(out, "total", &total);
+		fclose(out);
+		const char *prefix = "{ \"name\": \"total\", \"ops\": 3,";
+		assert(strncmp(buffer, prefix, strlen(prefix)) == 0);
+
+		assert(ds_stats_bind(&stats) == NULL);
+		assert(ds_stats_bound() == &stats);
+		assert(ds_stats_bind(NULL) == &stats);
+
+		AList *ints = alist_new(100, sizeof(int));
+#ifdef DS_STATS
+		for (int i = 0; i < 10; i++) {
+			assert(alist_push(ints, &i) == DS_OK);
+		}
+		int zero = 0;
+		assert(alist_add(ints, 0, &zero) == DS_OK);
+		assert(alist_remove(ints, 8) == DS_OK);
+		assert(alist_sort(ints, (DSCompare) compare_ints) == DS_OK);
+		const DSStats *s = alist_stats(ints);
+		assert(s->ops == 13);
+		assert(s->allocations == 2);
+		assert(s->compares > 0);
+		assert(s->max_cost == 10);
+		assert(s->histogram[4] == 1);
+		assert(s->histogram[2] == 1);
+		assert(ds_stats_bound() == NULL);
+#else
+		assert(alist_stats(ints) == NULL);
+#endif
+		alist_delete(ints);
 	}
 
 	alist_delete(list);
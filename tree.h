@@ -5,6 +5,7 @@
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
+#include "commons.h"
 
 /*
  * Binary Search Tree
@@ -16,7 +17,7 @@
 		BTree_##Type *right;													\
 	} BTree_##Type;																\
 																				\
-	int bt_##Type##_length(BTree_##Type *root) {								\
+	static inline int bt_##Type##_length(BTree_##Type *root) {					\
 	}																			\
 
 /*
@@ -24,7 +25,55 @@
  * Unbalanced. Inserting an element allocs memory for the node,
  * and removing frees it. Functions return a node.
  *
+ * bt_insert_in and bt_remove_in take the nodes from an arena instead, and
+ * never free them. bt_insert_with and bt_remove_with take them from an
+ * allocator. Use the same arena or allocator for all the nodes of a tree.
+ *
+ * bt_free frees all the nodes of a tree, and bt_free_with those taken from
+ * an allocator, in O(n) time and O(1) space.
+ *
+ * The functions are iterative and use no more stack on a degenerate tree
+ * than on a balanced one. bt_length and bt_check_bst keep the nodes still
+ * to visit in an array of BT_STACK_SIZE nodes on the stack, and move it to
+ * the heap for a tree deeper than that. They return -1 if it could not be
+ * allocated. They only read the tree, so several threads can run them on
+ * the same tree at once.
+ *
+ * With DS_STATS defined, the functions record their operations, compares,
+ * allocations and frees into the stats bound with ds_stats_bind.
+ *
+ * Shape
+ * bt_stats fills a BTreeStats with the length of the tree, its height (0
+ * if empty, 1 for a single node), the number of leaves, the average depth
+ * of the nodes (the root is at depth 0) and a histogram of the balance
+ * factors of the nodes, the height of the right subtree minus that of the
+ * left one, clamped to -4 and 4. It returns 0 if it could not allocate the
+ * stack of its traversal and 1 otherwise.
+ *
+ * bt_rebalance rebuilds a tree as a complete tree in place and returns the
+ * new root, in O(n) time and O(1) space (Day-Stout-Warren). Elements equal
+ * to a node may end up in its left subtree, which bt_check_bst rejects, but
+ * find and remove still work.
+ *
+ * bt_insert_balanced and bt_insert_balanced_with insert like bt_insert,
+ * given the tree through a pointer to its root and its length before the
+ * insertion, which the caller keeps. If the new node is deeper than
+ * BT_ALPHA * log2(length + 1), it rebuilds the smallest subtree on its path
+ * whose height exceeds BT_ALPHA * log2 of its size (a scapegoat), so that
+ * a tree only grown this way stays within that height. It keeps the path
+ * to the new node in an array of BT_STACK_SIZE links on the stack, and
+ * takes a bigger one from the allocator only for a tree deeper than that,
+ * as one grown with bt_insert. It returns the new node, or NULL if the node
+ * or the path could not be allocated, leaving the tree as it was.
+ *
  */
+#ifndef BT_ALPHA
+#define BT_ALPHA 2.0
+#endif
+
+#define BT_BALANCE_BUCKETS 9
+#define BT_STACK_SIZE 64  // more than BT_ALPHA * log2 of any int length
+
 struct BTree;
 
 typedef struct BTree {
@@ -33,156 +82,569 @@ typedef struct BTree {
 	struct BTree *right;
 } BTree;
 
-BTree *_bt_create_leaf(BTree *node, long elm);
-BTree *_bt_remove_node(BTree *node, long elm);
-BTree *_bt_merge(BTree *lesser, BTree *greater);
+typedef struct BTreeStats {
+	int length;
+	int height;
+	int leaves;
+	double average_depth;
+	int balance[BT_BALANCE_BUCKETS];  // balance factor + 4
+} BTreeStats;
+
+static inline BTree *bt_insert_in(DSArena *arena, BTree *root, long elm);
+static inline BTree *bt_remove_in(DSArena *arena, BTree *root, long elm);
+static inline BTree *bt_insert_with(const DSAllocator *allocator, BTree *root, long elm);
+static inline BTree *bt_remove_with(const DSAllocator *allocator, BTree *root, long elm);
+static inline BTree *bt_insert_balanced_with(const DSAllocator *allocator, BTree **root, int length, long elm);
+static inline void bt_free_with(const DSAllocator *allocator, BTree *root);
 
-int bt_compare(long a, long b) {
+static inline BTree *_bt_new_node(const DSAllocator *allocator, long elm);
+static inline BTree *_bt_create_leaf(const DSAllocator *allocator, BTree *node, long elm);
+static inline BTree *_bt_remove_node(const DSAllocator *allocator, BTree *node, long elm);
+static inline BTree *_bt_merge(BTree *lesser, BTree *greater);
+static inline void _bt_compress(BTree *root, int count);
+static inline int _bt_log2(unsigned long n);
+static inline void *_bt_grow_stack(const DSAllocator *allocator, void *stack, void *fixed, int *capacity, unsigned long size);
+static inline void _bt_free_stack(const DSAllocator *allocator, void *stack, void *fixed, int capacity, unsigned long size);
+
+static inline int bt_compare(long a, long b) {
 	return (int) (a - b);
 }
 
-int bt_length(BTree *root) {
-	if (root == NULL) {
-		return 0;
+static inline int bt_length(BTree *root) {
+	BTree *fixed[BT_STACK_SIZE];
+	BTree **stack = fixed;
+	int capacity = BT_STACK_SIZE;
+	int top = 0;
+	int length = 0;
+	if (root) {
+		stack[top++] = root;
 	}
-	else {
-		return 1 + bt_length(root->left) + bt_length(root->right);
+	while (top > 0) {
+		BTree *node = stack[--top];
+		length++;
+		if (top + 2 > capacity) {
+			BTree **grown = _bt_grow_stack(NULL, stack, fixed, &capacity, sizeof(BTree *));
+			if (!grown) {
+				_bt_free_stack(NULL, stack, fixed, capacity, sizeof(BTree *));
+				return -1;
+			}
+			stack = grown;
+		}
+		if (node->left) {
+			stack[top++] = node->left;
+		}
+		if (node->right) {
+			stack[top++] = node->right;
+		}
 	}
+	_bt_free_stack(NULL, stack, fixed, capacity, sizeof(BTree *));
+	return length;
 }
 
-int bt_check_bst(BTree *node) {
+static inline int bt_check_bst(BTree *root) {
+	BTree *fixed[BT_STACK_SIZE];
+	BTree **stack = fixed;
+	int capacity = BT_STACK_SIZE;
+	int top = 0;
 	int valid = 1;
-	if (node->left) {
-		valid = valid &&
-			bt_check_bst(node->left) && 
-			bt_compare(node->left->elm, node->elm) < 0;
+	if (root) {
+		stack[top++] = root;
 	}
-	if (node->right) {
-		valid = valid &&
-			bt_check_bst(node->right) &&
-			bt_compare(node->right->elm, node->elm) >= 0;
+	while (top > 0 && valid) {
+		BTree *node = stack[--top];
+		if (top + 2 > capacity) {
+			BTree **grown = _bt_grow_stack(NULL, stack, fixed, &capacity, sizeof(BTree *));
+			if (!grown) {
+				_bt_free_stack(NULL, stack, fixed, capacity, sizeof(BTree *));
+				return -1;
+			}
+			stack = grown;
+		}
+		if (node->left) {
+			valid = bt_compare(node->left->elm, node->elm) < 0;
+			stack[top++] = node->left;
+		}
+		if (node->right) {
+			valid = valid && bt_compare(node->right->elm, node->elm) >= 0;
+			stack[top++] = node->right;
+		}
 	}
+	_bt_free_stack(NULL, stack, fixed, capacity, sizeof(BTree *));
 	return valid;
 }
 
-
-BTree *bt_insert(BTree *root, long elm) {
+static inline int bt_stats(BTree *root, BTreeStats *stats) {
+	typedef struct { BTree *node; int depth; int left; int state; } Frame;
+	Frame *stack = NULL;
+	int top = -1;
+	int capacity = 0;
+	int height = 0;  // height of the last subtree done
+	double depths = 0;
+	memset(stats, 0, sizeof(BTreeStats));
 	if (root == NULL) {
-		root = malloc(sizeof(BTree));
-		*root = (BTree) { elm, NULL, NULL };
-		return root;
+		return 1;
 	}
-	else {
-		return _bt_create_leaf(root, elm);
+	BTree *next = root;
+	for (;;) {
+		if (next) {
+			int depth = top >= 0 ? stack[top].depth + 1 : 0;
+			if (top + 1 == capacity) {
+				Frame *grown = ds_realloc_with(NULL, stack, capacity * sizeof(Frame), (capacity + 64) * 2 * sizeof(Frame));
+				if (!grown) {
+					ds_free_with(NULL, stack, capacity * sizeof(Frame));
+					return 0;
+				}
+				stack = grown;
+				capacity = (capacity + 64) * 2;
+			}
+			stack[++top] = (Frame) { next, depth, 0, 0 };
+			next = NULL;
+		}
+		if (top < 0) {
+			break;
+		}
+		Frame *frame = &stack[top];
+		if (frame->state == 0) {
+			frame->state = 1;
+			if (frame->node->left) {
+				next = frame->node->left;
+				continue;
+			}
+			height = 0;
+		}
+		if (frame->state == 1) {
+			frame->left = height;
+			frame->state = 2;
+			if (frame->node->right) {
+				next = frame->node->right;
+				continue;
+			}
+			height = 0;
+		}
+		{
+			int balance = height - frame->left;
+			balance = balance < -4 ? -4 : balance > 4 ? 4 : balance;
+			stats->balance[balance + 4]++;
+			stats->length++;
+			stats->leaves += !frame->node->left && !frame->node->right;
+			depths += frame->depth;
+			height = 1 + (height > frame->left ? height : frame->left);
+			top--;
+		}
 	}
+	stats->height = height;
+	stats->average_depth = depths / stats->length;
+	ds_free_with(NULL, stack, capacity * sizeof(Frame));
+	return 1;
 }
 
-BTree *_bt_create_leaf(BTree *node, long elm) {
-	if (bt_compare(elm, node->elm) < 0) {
-		if (node->left == NULL) {
-			node->left = malloc(sizeof(BTree));
-			*node->left = (BTree) { elm, NULL, NULL };
-			return node->left;
+static inline BTree *bt_rebalance(BTree *root) {
+	BTree pseudo = { 0, NULL, root };
+	BTree *tail = &pseudo;
+	BTree *rest = root;
+	int length = 0;
+	int leaves;
+	// rotate right into a vine, a list of right children
+	while (rest) {
+		if (rest->left == NULL) {
+			tail = rest;
+			rest = rest->right;
+			length++;
 		}
 		else {
-			return _bt_create_leaf(node->left, elm);
+			BTree *left = rest->left;
+			rest->left = left->right;
+			left->right = rest;
+			rest = left;
+			tail->right = left;
 		}
 	}
-	else {
-		if (node->right == NULL) {
-			node->right = malloc(sizeof(BTree));
-			*node->right = (BTree) { elm, NULL, NULL };
-			return node->right;
-		}
-		else {
-			return _bt_create_leaf(node->right, elm);
+	// rotate left into a complete tree, the leaves of the last level first
+	leaves = length + 1 - (1 << _bt_log2(length + 1));
+	_bt_compress(&pseudo, leaves);
+	length -= leaves;
+	while (length > 1) {
+		length /= 2;
+		_bt_compress(&pseudo, length);
+	}
+	return pseudo.right;
+}
+
+// rotate left count nodes of the vine, every other node from the root
+static inline void _bt_compress(BTree *root, int count) {
+	BTree *scanner = root;
+	for (int i = 0; i < count; i++) {
+		BTree *child = scanner->right;
+		scanner->right = child->right;
+		scanner = scanner->right;
+		child->right = scanner->left;
+		scanner->left = child;
+	}
+}
+
+static inline int _bt_log2(unsigned long n) {
+	int log = 0;
+	while (n >>= 1) {
+		log++;
+	}
+	return log;
+}
+
+// Moves a stack of capacity items of size bytes from fixed, an array on
+// the stack of the caller, to memory from the allocator, or doubles it if
+// it is there already. Returns the new stack, or NULL if the memory could
+// not be allocated, leaving the old one as it was.
+static inline void *_bt_grow_stack(const DSAllocator *allocator, void *stack, void *fixed, int *capacity, unsigned long size) {
+	void *grown;
+	if (stack == fixed) {
+		grown = ds_alloc_with(allocator, 2 * (unsigned long) *capacity * size);
+		if (grown) {
+			memcpy(grown, fixed, (unsigned long) *capacity * size);
 		}
 	}
+	else {
+		grown = ds_realloc_with(allocator, stack, (unsigned long) *capacity * size, 2 * (unsigned long) *capacity * size);
+	}
+	if (grown) {
+		*capacity *= 2;
+	}
+	return grown;
+}
+
+static inline void _bt_free_stack(const DSAllocator *allocator, void *stack, void *fixed, int capacity, unsigned long size) {
+	if (stack != fixed) {
+		ds_free_with(allocator, stack, (unsigned long) capacity * size);
+	}
+}
+
+
+static inline BTree *bt_insert(BTree *root, long elm) {
+	return bt_insert_with(NULL, root, elm);
 }
 
-BTree *bt_find(BTree *root, long elm) {
+static inline BTree *bt_insert_in(DSArena *arena, BTree *root, long elm) {
+	return bt_insert_with(ds_arena_allocator(arena), root, elm);
+}
+
+static inline BTree *bt_insert_with(const DSAllocator *allocator, BTree *root, long elm) {
+	DS_STAT(ds_stats_bound(), ops, 1);
 	if (root == NULL) {
-		return NULL;
+		return _bt_new_node(allocator, elm);
 	}
 	else {
-		int c = bt_compare(elm, root->elm);
-		if (c == 0) {
-			return root;
+		return _bt_create_leaf(allocator, root, elm);
+	}
+}
+
+static inline BTree *bt_insert_balanced(BTree **root, int length, long elm) {
+	return bt_insert_balanced_with(NULL, root, length, elm);
+}
+
+static inline BTree *bt_insert_balanced_with(const DSAllocator *allocator, BTree **root, int length, long elm) {
+	BTree **fixed[BT_STACK_SIZE];
+	BTree ***path = fixed;  // links from the root to the new node
+	int capacity = BT_STACK_SIZE;
+	int depth = 0;
+	BTree **link = root;
+	BTree *node;
+	DS_STAT(ds_stats_bound(), ops, 1);
+	for (;; depth++) {
+		if (depth == capacity) {
+			BTree ***grown = _bt_grow_stack(allocator, path, fixed, &capacity, sizeof(BTree **));
+			if (!grown) {
+				_bt_free_stack(allocator, path, fixed, capacity, sizeof(BTree **));
+				return NULL;
+			}
+			path = grown;
 		}
-		else if (c < 0) {
-			return bt_find(root->left, elm);
+		path[depth] = link;
+		if (*link == NULL) {
+			break;
 		}
-		else {
-			return bt_find(root->right, elm);
+		DS_STAT(ds_stats_bound(), compares, 1);
+		link = bt_compare(elm, (*link)->elm) < 0 ? &(*link)->left : &(*link)->right;
+	}
+	node = _bt_new_node(allocator, elm);
+	if (!node) {
+		_bt_free_stack(allocator, path, fixed, capacity, sizeof(BTree **));
+		return NULL;
+	}
+	*link = node;
+	DS_STAT_COST(ds_stats_bound(), depth);
+	if (depth > BT_ALPHA * _bt_log2(length + 1)) {
+		// size of the subtrees on the path, from the new node up
+		int size = 1;
+		for (int height = 1; height <= depth; height++) {
+			BTree *parent = *path[depth - height];
+			BTree *child = *path[depth - height + 1];
+			int sibling = bt_length(child == parent->left ? parent->right : parent->left);
+			if (sibling < 0) {
+				break;
+			}
+			size += 1 + sibling;
+			if (height > BT_ALPHA * _bt_log2(size)) {
+				*path[depth - height] = bt_rebalance(parent);
+				break;
+			}
+		}
+	}
+	_bt_free_stack(allocator, path, fixed, capacity, sizeof(BTree **));
+	return node;
+}
+
+static inline BTree *_bt_new_node(const DSAllocator *allocator, long elm) {
+	BTree *node = ds_alloc_with(allocator, sizeof(BTree));
+	DS_STAT(ds_stats_bound(), allocations, 1);
+	if (node) {
+		*node = (BTree) { elm, NULL, NULL };
+	}
+	return node;
+}
+
+static inline BTree *_bt_create_leaf(const DSAllocator *allocator, BTree *node, long elm) {
+	unsigned long depth = 1;
+	for (;; depth++) {
+		BTree **link = bt_compare(elm, node->elm) < 0 ? &node->left : &node->right;
+		DS_STAT(ds_stats_bound(), compares, 1);
+		if (*link == NULL) {
+			DS_STAT_COST(ds_stats_bound(), depth);
+			*link = _bt_new_node(allocator, elm);
+			return *link;
+		}
+		node = *link;
+	}
+}
+
+static inline BTree *bt_find(BTree *root, long elm) {
+	unsigned long depth = 0;
+	DS_STAT(ds_stats_bound(), ops, 1);
+	for (; root != NULL; depth++) {
+		int c = bt_compare(elm, root->elm);
+		DS_STAT(ds_stats_bound(), compares, 1);
+		if (c == 0) {
+			break;
 		}
+		root = c < 0 ? root->left : root->right;
 	}
+	DS_STAT_COST(ds_stats_bound(), depth);
+	return root;
+}
+
+static inline BTree *bt_remove(BTree *root, long elm) {
+	return bt_remove_with(NULL, root, elm);
 }
 
-BTree *bt_remove(BTree *root, long elm) {
+static inline BTree *bt_remove_in(DSArena *arena, BTree *root, long elm) {
+	return bt_remove_with(ds_arena_allocator(arena), root, elm);
+}
+
+static inline BTree *bt_remove_with(const DSAllocator *allocator, BTree *root, long elm) {
+	DS_STAT(ds_stats_bound(), ops, 1);
+	if (root == NULL) {
+		return NULL;
+	}
 	if (bt_compare(elm, root->elm) == 0) {
 		BTree *lesser = root->left;
 		BTree *greater = root->right;
-		free(root);
+		ds_free_with(allocator, root, sizeof(BTree));
+		DS_STAT(ds_stats_bound(), frees, 1);
 		return _bt_merge(lesser, greater);
 	}
 	else {
-		return _bt_remove_node(root, elm);
+		return _bt_remove_node(allocator, root, elm);
 	}
 }
 
-BTree *_bt_remove_node(BTree *node, long elm) {
-	if (bt_compare(elm, node->elm) < 0) {
-		if (node->left == NULL) {
+static inline BTree *_bt_remove_node(const DSAllocator *allocator, BTree *node, long elm) {
+	for (;;) {
+		BTree **link = bt_compare(elm, node->elm) < 0 ? &node->left : &node->right;
+		DS_STAT(ds_stats_bound(), compares, 1);
+		if (*link == NULL) {
 			return NULL;
 		}
-		else if (bt_compare(node->left->elm, elm) == 0) {
-			BTree *lesser = node->left->left;
-			BTree *greater = node->left->right;
-			free(node->left);
-			if (lesser == NULL) {
-				node->left = greater;
-			}
-			else {
-				node->left = _bt_merge(lesser, greater);
-			}
-			return node->left;
-		}
-		else {
-			return _bt_remove_node(node->left, elm);
+		else if (bt_compare((*link)->elm, elm) == 0) {
+			BTree *lesser = (*link)->left;
+			BTree *greater = (*link)->right;
+			ds_free_with(allocator, *link, sizeof(BTree));
+			DS_STAT(ds_stats_bound(), frees, 1);
+			*link = _bt_merge(lesser, greater);
+			return *link;
 		}
+		node = *link;
 	}
-	else {
-		if (node->right == NULL) {
-			return NULL;
-		}
-		else if (bt_compare(node->right->elm, elm) == 0) {
-			BTree *lesser = node->right->left;
-			BTree *greater = node->right->right;
-			free(node->right);
-			if (lesser == NULL) {
-				node->right = greater;
-			}
-			else {
-				node->right = _bt_merge(lesser, greater);
-			}
-			return node->right;
+}
+
+static inline void bt_free(BTree *root) {
+	bt_free_with(NULL, root);
+}
+
+static inline void bt_free_with(const DSAllocator *allocator, BTree *root) {
+	if (allocator && !allocator->free) {
+		return;
+	}
+	// rotate left children up until the root has none, then free it
+	while (root) {
+		if (root->left) {
+			BTree *left = root->left;
+			root->left = left->right;
+			left->right = root;
+			root = left;
 		}
 		else {
-			return _bt_remove_node(node->right, elm);
+			BTree *right = root->right;
+			ds_free_with(allocator, root, sizeof(BTree));
+			DS_STAT(ds_stats_bound(), frees, 1);
+			root = right;
 		}
 	}
 }
 
-// merge the greater tree into the lesser tree
-// return the root of the tree, which is the same as the root of the lesser tree.
-BTree *_bt_merge(BTree *lesser, BTree *greater) {
-	if (lesser->right == NULL) {
-		lesser->right = greater;
-		return lesser;
+// hang the greater subtree from the rightmost node of the lesser one
+static inline BTree *_bt_merge(BTree *lesser, BTree *greater) {
+	BTree *node = lesser;
+	if (lesser == NULL) {
+		return greater;
 	}
-	else {
-		return _bt_merge(greater, lesser->right);
+	while (node->right) {
+		node = node->right;
 	}
+	node->right = greater;
+	return lesser;
 }
 
+/*
+ * Intrusive Binary Search Tree
+ * Unbalanced binary search tree of objects that embed their own hook.
+ * No memory is allocated.
+ *
+ * Embed a BTHook member in the struct and the tree links the objects through
+ * it, so that the tree never owns the objects and an object can be in several
+ * trees, or lists, at once. Given a hook, the object is found with
+ * ds_container_of.
+ *
+ * Prepare the tree by using the macro DEFINE_INTRUSIVE_BTREE. The first
+ * parameter is a name for the tree, the second is the type of the objects,
+ * the third is the name of the BTHook member and the fourth is a function
+ * int Compare(const Type *a, const Type *b) that returns <0 if a<b, 0 if
+ * a==b and >0 if a>b. This will create a struct called IBTree_<name>, with
+ * functions prefixed ibt_<name>_. An empty tree is a zeroed IBTree_<name>.
+ *
+ * As in BTree, lesser objects go to the left and greater or equal objects
+ * go to the right. The function find returns an object equal to the key,
+ * and remove takes the object itself out of the tree, even if there are
+ * other objects equal to it. Removing an object with two children puts its
+ * successor in its place. The functions are iterative.
+ *
+ * typedef struct Timer { long when; BTHook hook; } Timer;
+ * DEFINE_INTRUSIVE_BTREE(timers, Timer, hook, compare_timers)
+ * IBTree_timers
+ * ibt_timers_length	(tree)					-> int
+ * ibt_timers_insert	(tree, obj)
+ * ibt_timers_find		(tree, key)				-> obj
+ * ibt_timers_remove	(tree, obj)
+ * ibt_timers_min		(tree)					-> obj
+ * ibt_timers_max		(tree)					-> obj
+ *
+ */
+typedef struct BTHook {
+	struct BTHook *left;
+	struct BTHook *right;
+} BTHook;
+
+#define DEFINE_INTRUSIVE_BTREE(Name, Type, member, Compare)						\
+	typedef struct IBTree_##Name {												\
+		BTHook *root;															\
+		int length;																\
+	} IBTree_##Name;															\
+																				\
+	static inline Type *ibt_##Name##_entry(BTHook *hook) {						\
+		return hook ? ds_container_of(hook, Type, member) : NULL;				\
+	}																			\
+																				\
+	static inline int ibt_##Name##_length(IBTree_##Name *tree) {				\
+		return tree->length;													\
+	}																			\
+																				\
+	static inline void ibt_##Name##_insert(IBTree_##Name *tree, Type *obj) {	\
+		BTHook **link = &tree->root;											\
+		while (*link) {															\
+			if (Compare(obj, ibt_##Name##_entry(*link)) < 0) {					\
+				link = &(*link)->left;											\
+			}																	\
+			else {																\
+				link = &(*link)->right;											\
+			}																	\
+		}																		\
+		obj->member.left = NULL;												\
+		obj->member.right = NULL;												\
+		*link = &obj->member;													\
+		tree->length += 1;														\
+	}																			\
+																				\
+	static inline Type *ibt_##Name##_find(IBTree_##Name *tree, const Type *key) {	\
+		BTHook *hook = tree->root;												\
+		while (hook) {															\
+			int c = Compare(key, ibt_##Name##_entry(hook));						\
+			if (c == 0) {														\
+				return ibt_##Name##_entry(hook);								\
+			}																	\
+			hook = c < 0 ? hook->left : hook->right;							\
+		}																		\
+		return NULL;															\
+	}																			\
+																				\
+	static inline void ibt_##Name##_remove(IBTree_##Name *tree, Type *obj) {	\
+		BTHook *hook = &obj->member;											\
+		BTHook **link = &tree->root;											\
+		while (*link && *link != hook) {										\
+			if (Compare(obj, ibt_##Name##_entry(*link)) < 0) {					\
+				link = &(*link)->left;											\
+			}																	\
+			else {																\
+				link = &(*link)->right;											\
+			}																	\
+		}																		\
+		if (!*link) {															\
+			return;																\
+		}																		\
+		if (!hook->left) {														\
+			*link = hook->right;												\
+		}																		\
+		else if (!hook->right) {												\
+			*link = hook->left;													\
+		}																		\
+		else {																	\
+			BTHook **succ = &hook->right;										\
+			BTHook *s;															\
+			while ((*succ)->left) {												\
+				succ = &(*succ)->left;											\
+			}																	\
+			s = *succ;															\
+			*succ = s->right;													\
+			s->left = hook->left;												\
+			s->right = hook->right;												\
+			*link = s;															\
+		}																		\
+		hook->left = NULL;														\
+		hook->right = NULL;														\
+		tree->length -= 1;														\
+	}																			\
+																				\
+	static inline Type *ibt_##Name##_min(IBTree_##Name *tree) {					\
+		BTHook *hook = tree->root;												\
+		while (hook && hook->left) {											\
+			hook = hook->left;													\
+		}																		\
+		return ibt_##Name##_entry(hook);										\
+	}																			\
+																				\
+	static inline Type *ibt_##Name##_max(IBTree_##Name *tree) {					\
+		BTHook *hook = tree->root;												\
+		while (hook && hook->right) {											\
+			hook = hook->right;													\
+		}																		\
+		return ibt_##Name##_entry(hook);										\
+	}																			\
+
+
 #endif  // __TREE__H__
@@ -3,8 +3,31 @@
 #include <stdlib.h>
 #include <string.h>
 #include <assert.h>
+#include <pthread.h>
 
 
+typedef struct Timer {
+	long when;
+	BTHook hook;
+} Timer;
+
+int compare_timers(const Timer *a, const Timer *b) {
+	return (a->when > b->when) - (a->when < b->when);
+}
+
+DEFINE_INTRUSIVE_BTREE(timers, Timer, hook, compare_timers)
+
+#define READERS 4
+
+// counts and checks a tree that other threads read at the same time
+void *read_tree(void *root) {
+	for (int i = 0; i < 200; i++) {
+		assert(bt_length(root) == 10000);
+		assert(bt_check_bst(root) == 1);
+	}
+	return NULL;
+}
+
 int main(void) {
 
 	{
@@ -71,6 +94,200 @@ int main(void) {
 		node = bt_remove(root, 17);
 		assert(node == NULL);
 		assert(bt_length(root) == 3);
+		bt_free(root);
+	}
+
+	// removing with merges
+	{
+		long elms[] = { 50, 30, 70, 20, 40, 35, 45, 60, 80 };
+		BTree *root = NULL;
+		for (int i = 0; i < 9; i++) {
+			BTree *node = bt_insert(root, elms[i]);
+			root = root ? root : node;
+		}
+		// the right subtree hangs from the greatest node of the left one
+		BTree *node = bt_remove(root, 30);
+		assert(node->elm == 20);
+		assert(root->left == node);
+		assert(node->right->elm == 40);
+		assert(bt_check_bst(root));
+		assert(bt_length(root) == 8);
+
+		root = bt_remove(root, 50);
+		assert(root->elm == 20);
+		assert(bt_find(root, 45)->right->elm == 70);
+		assert(bt_check_bst(root));
+		assert(bt_length(root) == 7);
+
+		// a root without a left child
+		root = bt_remove(root, 20);
+		assert(root->elm == 40);
+		assert(bt_check_bst(root));
+		assert(bt_length(root) == 6);
+		assert(bt_remove(NULL, 20) == NULL);
+		assert(bt_remove(root, 99) == NULL);
+		bt_free(root);
+		bt_free(NULL);
+	}
+
+	// a degenerate tree deeper than the stack
+	{
+		const long n = 1000000;
+		BTree *root = NULL;
+		BTree **link = &root;
+		for (long i = 0; i < n; i++) {
+			*link = bt_insert(NULL, i);
+			link = &(*link)->right;
+		}
+		assert(bt_length(root) == n);
+		assert(bt_check_bst(root));
+		assert(bt_find(root, n - 1)->elm == n - 1);
+		assert(bt_insert(root, n)->elm == n);
+		assert(bt_remove(root, n - 1)->elm == n);
+		assert(bt_length(root) == n);
+		root->right->elm = -1;
+		assert(!bt_check_bst(root));
+		root->right->elm = 1;
+		assert(bt_check_bst(root));
+		bt_free(root);
+	}
+
+	// readers in several threads
+	{
+		pthread_t threads[READERS];
+		BTree *root = bt_insert(NULL, 5000);
+		for (long i = 1; i < 10000; i++) {
+			bt_insert(root, (5000 + i * 7919) % 10000);
+		}
+		for (int t = 0; t < READERS; t++) {
+			pthread_create(&threads[t], NULL, read_tree, root);
+		}
+		for (int t = 0; t < READERS; t++) {
+			pthread_join(threads[t], NULL);
+		}
+		bt_free(root);
+	}
+
+	// tree nodes from an arena
+	{
+		DSArena *arena = ds_arena_new(64);
+		BTree *root = bt_insert_in(arena, NULL, 50);
+		for (long i = 0; i < 100; i++) {
+			if (i != 50) {
+				assert(bt_insert_in(arena, root, i) != NULL);
+			}
+		}
+		assert(bt_length(root) == 100);
+		assert(bt_find(root, 99)->elm == 99);
+		bt_remove_in(arena, root, 99);
+		assert(bt_find(root, 99) == NULL);
+		assert(bt_length(root) == 99);
+		ds_arena_delete(arena);
+	}
+
+
+	// shape
+	{
+		BTreeStats stats;
+		assert(bt_stats(NULL, &stats) == 1);
+		assert(stats.length == 0 && stats.height == 0);
+
+		DSArena *arena = ds_arena_new(4096);
+		BTree *root = bt_insert_in(arena, NULL, 0);
+		for (long i = 1; i < 100; i++) {
+			bt_insert_in(arena, root, i);
+		}
+		assert(bt_stats(root, &stats) == 1);
+		assert(stats.length == 100);
+		assert(stats.height == 100);
+		assert(stats.leaves == 1);
+		assert(stats.average_depth == 49.5);
+		assert(stats.balance[8] == 96);
+		assert(stats.balance[4] == 1);
+
+		root = bt_rebalance(root);
+		assert(bt_check_bst(root));
+		assert(bt_stats(root, &stats) == 1);
+		assert(stats.length == 100);
+		assert(stats.height == 7);
+		assert(stats.balance[3] + stats.balance[4] + stats.balance[5] == 100);
+		for (long i = 0; i < 100; i++) {
+			assert(bt_find(root, i)->elm == i);
+		}
+		assert(bt_rebalance(NULL) == NULL);
+		ds_arena_delete(arena);
+
+		root = NULL;
+		for (int i = 0; i < 1000; i++) {
+			BTree *node = bt_insert_balanced(&root, i, i);
+			assert(node && node->elm == i);
+		}
+		assert(bt_check_bst(root));
+		assert(bt_stats(root, &stats) == 1);
+		assert(stats.length == 1000);
+		assert(stats.height <= BT_ALPHA * 9 + 1);
+		for (long i = 0; i < 1000; i++) {
+			assert(bt_find(root, i)->elm == i);
+		}
+		bt_free(root);
+
+		// a path longer than the one on the stack, in a tree grown unbalanced
+		root = bt_insert(NULL, 0);
+		for (long i = 1; i < 200; i++) {
+			bt_insert(root, i);
+		}
+		BTree *node = bt_insert_balanced(&root, 200, 200);
+		assert(node && node->elm == 200);
+		assert(bt_check_bst(root));
+		assert(bt_stats(root, &stats) == 1);
+		assert(stats.length == 201);
+		assert(stats.height < 200);
+		bt_free(root);
+	}
+
+
+	// intrusive tree
+	{
+		Timer timers[10];
+		long whens[] = { 50, 20, 80, 10, 30, 70, 90, 30, 60, 40 };
+		IBTree_timers tree = { 0 };
+
+		for (int i = 0; i < 10; i++) {
+			timers[i].when = whens[i];
+			ibt_timers_insert(&tree, &timers[i]);
+		}
+		assert(ibt_timers_length(&tree) == 10);
+		assert(tree.root == &timers[0].hook);
+		assert(ibt_timers_min(&tree) == &timers[3]);
+		assert(ibt_timers_max(&tree) == &timers[6]);
+
+		{
+			Timer key = { .when = 70 };
+			assert(ibt_timers_find(&tree, &key) == &timers[5]);
+			key.when = 35;
+			assert(ibt_timers_find(&tree, &key) == NULL);
+		}
+
+		// remove the duplicate, not the first 30 found
+		ibt_timers_remove(&tree, &timers[7]);
+		assert(ibt_timers_length(&tree) == 9);
+		{
+			Timer key = { .when = 30 };
+			assert(ibt_timers_find(&tree, &key) == &timers[4]);
+		}
+
+		// remove the root, which has two children
+		ibt_timers_remove(&tree, &timers[0]);
+		assert(ibt_timers_length(&tree) == 8);
+		assert(tree.root == &timers[8].hook);
+
+		while (ibt_timers_length(&tree) > 0) {
+			Timer *min = ibt_timers_min(&tree);
+			ibt_timers_remove(&tree, min);
+			Timer *next = ibt_timers_min(&tree);
+			assert(next == NULL || next->when >= min->when);
+		}
+		assert(tree.root == NULL);
 	}
 
 	return 0;